@@ -0,0 +1,109 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Synopsis:
+#       bench-compare.sh old.json new.json [threshold-percent]
+#
+#   Description:
+#       Compare two result files from "make bench" and flag subcommands
+#       whose throughput dropped or peak RSS grew by more than the
+#       threshold (default 5%).  Results are only comparable if both
+#       runs used the same host, size, seed, and cache mode, so a
+#       warning is printed if these differ.
+#
+#   Returns:
+#       0 if no regressions, 1 if any, 2 on usage errors
+#
+#   History:
+#   Date        Name        Modification
+#   2026-10-19  Jason Bacon Begin
+##########################################################################
+
+usage()
+{
+    printf "Usage: $0 old.json new.json [threshold-percent]\n" >&2
+    exit 2
+}
+
+if [ $# -lt 2 ] || [ $# -gt 3 ]; then
+    usage
+fi
+old=$1
+new=$2
+threshold=${3:-5}
+
+# Parses only the layout written by bench.sh: one result object per line
+awk -v threshold=$threshold '
+function field(line, name,     s)
+{
+    s = line
+    if ( !sub(".*\"" name "\": *", "", s) )
+	return ""
+    sub("[,}].*", "", s)
+    gsub("\"", "", s)
+    return s
+}
+
+FNR == 1 { ++file }
+
+/"(host|size_mib|seed|cache)":/ && !/"tool":/ {
+    name = $1
+    gsub("[\":]", "", name)
+    value = field($0, name)
+    if ( file == 1 )
+	setting[name] = value
+    else if ( setting[name] != value )
+	printf("Warning: %s differs (%s vs %s), results may not be comparable.\n",
+	       name, setting[name], value)
+}
+
+/"tool":/ {
+    tool = field($0, "tool")
+    if ( file == 1 )
+    {
+	old_mbs[tool] = field($0, "mb_per_sec")
+	old_rss[tool] = field($0, "max_rss_kib")
+    }
+    else
+    {
+	tools[++count] = tool
+	new_mbs[tool] = field($0, "mb_per_sec")
+	new_rss[tool] = field($0, "max_rss_kib")
+    }
+}
+
+END {
+    printf("\n%-28s %10s %10s %7s %10s %10s %7s\n", "Tool", "Old MB/s",
+	   "New MB/s", "Change", "Old KiB", "New KiB", "Change")
+    for (c = 1; c <= count; ++c)
+    {
+	tool = tools[c]
+	if ( !(tool in old_mbs) )
+	{
+	    printf("%-28s %10s %10.2f %7s %10s %10d %7s  new\n", tool, "-",
+		   new_mbs[tool], "", "-", new_rss[tool], "")
+	    continue
+	}
+	mbs_change = rss_change = 0
+	if ( old_mbs[tool] > 0 )
+	    mbs_change = (new_mbs[tool] - old_mbs[tool]) * 100 / old_mbs[tool]
+	if ( old_rss[tool] > 0 )
+	    rss_change = (new_rss[tool] - old_rss[tool]) * 100 / old_rss[tool]
+	flag = ""
+	if ( mbs_change < -threshold )
+	    flag = flag " SLOWER"
+	if ( rss_change > threshold )
+	    flag = flag " BIGGER"
+	if ( flag != "" )
+	    ++regressions
+	printf("%-28s %10.2f %10.2f %6.1f%% %10d %10d %6.1f%% %s\n", tool,
+	       old_mbs[tool], new_mbs[tool], mbs_change,
+	       old_rss[tool], new_rss[tool], rss_change, flag)
+    }
+    if ( regressions > 0 )
+    {
+	printf("\n%d regression(s) beyond %s%%.\n", regressions, threshold)
+	exit 1
+    }
+    printf("\nNo regressions beyond %s%%.\n", threshold)
+}' $old $new
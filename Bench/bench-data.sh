@@ -0,0 +1,72 @@
+##########################################################################
+#   Synopsis:
+#       . Bench/bench-data.sh
+#       bench_data directory name size-MiB seed
+#
+#   Description:
+#       Shared by Bench/bench.sh and Test/budget.sh, which source it
+#       from the top source directory.
+#
+#       Sourcing sets BINS from the Makefile unless it is already set.
+#
+#       bench_data generates FASTA, FASTQ, GFF3, and VCF inputs of the
+#       given size with Bench/bench-gen as directory/name.fasta, etc.,
+#       along with their record counts and a list of every 100th gene
+#       ID for ensemblid2gene, unless they are already cached there.
+#       It then sets fasta, fastq, gff3, vcf, and ids to the file names
+#       and *_bytes and *_records to their sizes.
+#
+#   History:
+#   Date        Name        Modification
+#   2026-10-19  Jason Bacon Begin
+##########################################################################
+
+if [ -z "$BINS" ]; then
+    BINS=$(make -V BINS 2>/dev/null || \
+	   sed -n '/^BINS/,/[^\\]$/p' Makefile | tr -d '\\' | cut -d = -f 2)
+fi
+
+bench_data()
+{
+    dir=$1
+    name=$2
+
+    mkdir -p $dir
+    for format in fasta fastq gff3 vcf; do
+	if [ ! -e $dir/$name.$format.records ]; then
+	    printf "Generating $3 MiB $format...\n"
+	    Bench/bench-gen --seed $4 --genome-mib $3 $format $3 \
+		> $dir/$name.$format
+	    case $format in
+	    fasta)
+		grep -c '^>' $dir/$name.$format
+		;;
+	    fastq)
+		echo $(($(wc -l < $dir/$name.$format) / 4))
+		;;
+	    *)
+		grep -vc '^#' $dir/$name.$format
+		;;
+	    esac > $dir/$name.$format.records
+	fi
+    done
+    ids=$dir/$name.ids
+    if [ ! -e $ids ]; then
+	awk -F '\t' '$3 == "gene" && ++genes % 100 == 1 {
+		split($9, a, "[=;]"); sub("gene:", "", a[2]); print a[2] }' \
+	    $dir/$name.gff3 > $ids
+    fi
+
+    fasta=$dir/$name.fasta
+    fastq=$dir/$name.fastq
+    gff3=$dir/$name.gff3
+    vcf=$dir/$name.vcf
+    fasta_bytes=$(wc -c < $fasta)
+    fastq_bytes=$(wc -c < $fastq)
+    gff3_bytes=$(wc -c < $gff3)
+    vcf_bytes=$(wc -c < $vcf)
+    fasta_records=$(cat $fasta.records)
+    fastq_records=$(cat $fastq.records)
+    gff3_records=$(cat $gff3.records)
+    vcf_records=$(cat $vcf.records)
+}
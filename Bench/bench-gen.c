@@ -0,0 +1,313 @@
+/***************************************************************************
+ *  Description:
+ *      Generate deterministic synthetic FASTA, FASTQ, GFF3, and VCF data
+ *      for "make bench".  The same seed and sizes always produce the
+ *      same bytes on every platform, so results from different machines
+ *      and commits are comparable without downloading reference genomes.
+ *
+ *      All formats describe the same genome: 16 chromosomes named I
+ *      through XVI (as in yeast, so deromanize and natural sorting have
+ *      something to do), each genome-size / 16 bases long.  GFF3 and VCF
+ *      coordinates therefore fall within the generated FASTA.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sysexits.h>
+
+#define CHROM_COUNT     16
+#define FASTA_WIDTH     60
+#define READ_LEN        150
+#define MIB             (1024 * 1024)
+
+typedef struct
+{
+    uint64_t    size;           // Approximate output bytes
+    uint64_t    chrom_len;      // Bases per chromosome
+    uint64_t    state;          // PRNG state
+}   gen_t;
+
+static const char   *Chroms[CHROM_COUNT] =
+{
+    "I", "II", "III", "IV", "V", "VI", "VII", "VIII",
+    "IX", "X", "XI", "XII", "XIII", "XIV", "XV", "XVI"
+};
+
+int     gen_fasta(gen_t *gen);
+int     gen_fastq(gen_t *gen);
+int     gen_gff3(gen_t *gen);
+int     gen_vcf(gen_t *gen);
+uint64_t gen_random(gen_t *gen);
+char    gen_base(gen_t *gen);
+void    usage(char *argv[]);
+
+int     main(int argc, char *argv[])
+
+{
+    gen_t       gen;
+    char        *end, *format;
+    uint64_t    genome_mib = 0, seed = 1;
+    int         arg;
+
+    for (arg = 1; (arg < argc) && (*argv[arg] == '-'); arg += 2)
+    {
+	if ( arg + 1 == argc )
+	    usage(argv);
+	if ( strcmp(argv[arg], "--seed") == 0 )
+	    seed = strtoull(argv[arg + 1], &end, 10);
+	else if ( strcmp(argv[arg], "--genome-mib") == 0 )
+	    genome_mib = strtoull(argv[arg + 1], &end, 10);
+	else
+	    usage(argv);
+	if ( *end != '\0' )
+	    usage(argv);
+    }
+    if ( arg + 2 != argc )
+	usage(argv);
+    format = argv[arg];
+    gen.size = strtoull(argv[arg + 1], &end, 10) * MIB;
+    if ( (*end != '\0') || (gen.size == 0) )
+	usage(argv);
+    if ( genome_mib == 0 )
+	genome_mib = gen.size / MIB;
+    gen.chrom_len = genome_mib * MIB / CHROM_COUNT;
+    // xorshift64* must not start at 0
+    gen.state = seed * 0x9E3779B97F4A7C15ULL + 1;
+
+    if ( strcmp(format, "fasta") == 0 )
+	return gen_fasta(&gen);
+    else if ( strcmp(format, "fastq") == 0 )
+	return gen_fastq(&gen);
+    else if ( strcmp(format, "gff3") == 0 )
+	return gen_gff3(&gen);
+    else if ( strcmp(format, "vcf") == 0 )
+	return gen_vcf(&gen);
+    usage(argv);
+    return EX_USAGE;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      One record per chromosome, FASTA_WIDTH bases per line.  Size
+ *      is determined by --genome-mib, or the size argument if not given.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gen_fasta(gen_t *gen)
+
+{
+    char        line[FASTA_WIDTH + 1];
+    uint64_t    pos, c;
+    int         chrom;
+
+    for (chrom = 0; chrom < CHROM_COUNT; ++chrom)
+    {
+	printf(">%s dna:chromosome chromosome:BENCH:%s:1:%" PRIu64 ":1\n",
+	       Chroms[chrom], Chroms[chrom], gen->chrom_len);
+	for (pos = 0; pos < gen->chrom_len; pos += c)
+	{
+	    for (c = 0; (c < FASTA_WIDTH) && (pos + c < gen->chrom_len); ++c)
+		line[c] = gen_base(gen);
+	    line[c] = '\n';
+	    fwrite(line, 1, c + 1, stdout);
+	}
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      READ_LEN bp reads sampled from the genome with random qualities.
+ *      About 1 in 16 reads repeats the previous sequence so that
+ *      fastx-derep has duplicates to remove.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gen_fastq(gen_t *gen)
+
+{
+    char        seq[READ_LEN + 1], qual[READ_LEN + 1];
+    uint64_t    written, read;
+    int         c;
+
+    seq[READ_LEN] = qual[READ_LEN] = '\0';
+    for (written = 0, read = 1; written < gen->size; ++read)
+    {
+	if ( (read == 1) || (gen_random(gen) % 16 != 0) )
+	    for (c = 0; c < READ_LEN; ++c)
+		seq[c] = gen_base(gen);
+	for (c = 0; c < READ_LEN; ++c)
+	    qual[c] = '!' + 2 + gen_random(gen) % 39;
+	written += printf("@BENCH.%" PRIu64 " %s:%" PRIu64 " length=%d\n"
+			  "%s\n+\n%s\n",
+			  read, Chroms[gen_random(gen) % CHROM_COUNT],
+			  gen_random(gen) % gen->chrom_len + 1, READ_LEN,
+			  seq, qual);
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Ensembl-style GFF3 with gene, mRNA, exon, and CDS features.
+ *      Genes are emitted round-robin across chromosomes, so the file is
+ *      not sorted, as is common for merged annotations.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gen_gff3(gen_t *gen)
+
+{
+    uint64_t    written, gene, start, end, exon_start, exon_end;
+    int         chrom, exon, exons;
+    char        strand;
+
+    written = printf("##gff-version 3\n");
+    for (chrom = 0; chrom < CHROM_COUNT; ++chrom)
+	written += printf("##sequence-region   %s 1 %" PRIu64 "\n",
+			  Chroms[chrom], gen->chrom_len);
+
+    for (gene = 1; written < gen->size; ++gene)
+    {
+	chrom = gene % CHROM_COUNT;
+	start = gen_random(gen) % (gen->chrom_len - 10000) + 1;
+	end = start + 1000 + gen_random(gen) % 8000;
+	strand = gen_random(gen) % 2 ? '+' : '-';
+	written += printf("%s\tBENCH\tgene\t%" PRIu64 "\t%" PRIu64
+			  "\t.\t%c\t.\tID=gene:BENG%011" PRIu64
+			  ";Name=bg%" PRIu64 ";biotype=protein_coding\n",
+			  Chroms[chrom], start, end, strand, gene, gene);
+	written += printf("%s\tBENCH\tmRNA\t%" PRIu64 "\t%" PRIu64
+			  "\t.\t%c\t.\tID=transcript:BENT%011" PRIu64
+			  ";Parent=gene:BENG%011" PRIu64
+			  ";Name=bg%" PRIu64 "-201\n",
+			  Chroms[chrom], start, end, strand, gene, gene, gene);
+	exons = 1 + gen_random(gen) % 4;
+	for (exon = 0; exon < exons; ++exon)
+	{
+	    exon_start = start + (end - start) * exon / exons;
+	    exon_end = exon_start + (end - start) / exons / 2;
+	    written += printf("%s\tBENCH\texon\t%" PRIu64 "\t%" PRIu64
+			      "\t.\t%c\t.\tParent=transcript:BENT%011" PRIu64
+			      ";Name=BENE%011" PRIu64 ".%d\n",
+			      Chroms[chrom], exon_start, exon_end, strand,
+			      gene, gene, exon + 1);
+	    written += printf("%s\tBENCH\tCDS\t%" PRIu64 "\t%" PRIu64
+			      "\t.\t%c\t0\tID=CDS:BENP%011" PRIu64
+			      ";Parent=transcript:BENT%011" PRIu64 "\n",
+			      Chroms[chrom], exon_start, exon_end, strand,
+			      gene, gene);
+	}
+	written += printf("###\n");
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Single-sample VCF sorted by chromosome and position, with
+ *      roughly equal numbers of calls per chromosome.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gen_vcf(gen_t *gen)
+
+{
+    static const char   *genotypes[] = { "0|1", "1|0", "1|1", "0/1" };
+    uint64_t    written, pos, step, chrom_size, chrom_start, ref_depth,
+		alt_depth;
+    int         chrom;
+    char        ref, alt;
+
+    written = printf("##fileformat=VCFv4.3\n##source=bench-gen\n");
+    for (chrom = 0; chrom < CHROM_COUNT; ++chrom)
+	written += printf("##contig=<ID=%s,length=%" PRIu64 ">\n",
+			  Chroms[chrom], gen->chrom_len);
+    written += printf("#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\t"
+		      "FORMAT\tsample1\n");
+
+    // About 50 bytes per call: spread each chromosome's share evenly
+    chrom_size = gen->size / CHROM_COUNT;
+    step = gen->chrom_len / (chrom_size / 50 + 1) * 2;
+    if ( step < 2 )
+	step = 2;
+    for (chrom = 0; chrom < CHROM_COUNT; ++chrom)
+    {
+	chrom_start = written;
+	for (pos = 1; (pos < gen->chrom_len) &&
+		      (written - chrom_start < chrom_size);
+	     pos += 1 + gen_random(gen) % step)
+	{
+	    ref = gen_base(gen);
+	    while ( (alt = gen_base(gen)) == ref )
+		;
+	    ref_depth = gen_random(gen) % 40;
+	    alt_depth = gen_random(gen) % 40;
+	    written += printf("%s\t%" PRIu64 "\t.\t%c\t%c\t%d\t.\t.\t"
+			      "GT:AD:DP\t%s:%" PRIu64 ",%" PRIu64 ":%" PRIu64
+			      "\n", Chroms[chrom], pos, ref, alt,
+			      (int)(gen_random(gen) % 60),
+			      genotypes[gen_random(gen) % 4],
+			      ref_depth, alt_depth, ref_depth + alt_depth);
+	}
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      xorshift64*: fast, and unlike random(3), identical everywhere.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint64_t gen_random(gen_t *gen)
+
+{
+    gen->state ^= gen->state >> 12;
+    gen->state ^= gen->state << 25;
+    gen->state ^= gen->state >> 27;
+    return (gen->state * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+
+char    gen_base(gen_t *gen)
+
+{
+    return "ACGT"[gen_random(gen) & 3];
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--seed N] [--genome-mib MiB] "
+	    "fasta|fastq|gff3|vcf MiB > file\n", argv[0]);
+    exit(EX_USAGE);
+}
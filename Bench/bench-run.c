@@ -0,0 +1,312 @@
+/***************************************************************************
+ *  Description:
+ *      Run a command repeatedly with stdin from a file and report wall,
+ *      user, and system time, throughput, and peak RSS as one line of
+ *      JSON, for "make bench".
+ *
+ *      Resource usage of each run is collected with wait4(2) rather
+ *      than time(1), whose output format differs between GNU and BSD.
+ *      Optionally pins the command to one CPU and evicts input files
+ *      from the page cache before each run (cold cache), neither of
+ *      which requires root.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifdef __linux__
+#define _GNU_SOURCE     // sched_setaffinity()
+#include <sched.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#ifdef __FreeBSD__
+#include <sys/param.h>
+#include <sys/cpuset.h>
+#endif
+
+#define MAX_RUNS    100
+#define MAX_FILES   8
+
+typedef struct
+{
+    const char  *tool;
+    const char  *input;
+    const char  *output;
+    const char  *files[MAX_FILES];  // Evicted for cold runs, incl. input
+    int         file_count;
+    int         runs;
+    int         cpu;                // -1 = not pinned
+    bool        cold;
+    uint64_t    bytes;
+    uint64_t    records;
+}   bench_t;
+
+typedef struct
+{
+    double      wall;
+    double      user;
+    double      sys;
+    long        max_rss_kib;
+    int         status;
+}   run_t;
+
+int     run_once(bench_t *bench, char *cmd[], run_t *run, bool quiet);
+void    evict(bench_t *bench);
+void    pin_cpu(int cpu);
+int     double_cmp(const void *p1, const void *p2);
+void    usage(char *argv[]);
+
+int     main(int argc, char *argv[])
+
+{
+    bench_t bench = { "", NULL, "/dev/null", { NULL }, 0, 3, -1, false, 0, 0 };
+    run_t   runs[MAX_RUNS], warmup;
+    double  walls[MAX_RUNS], median, user = 0, sys = 0;
+    long    max_rss_kib = 0;
+    char    *end;
+    int     arg, c, status = 0;
+
+    for (arg = 1; (arg < argc) && (strcmp(argv[arg], "--") != 0); ++arg)
+    {
+	if ( strcmp(argv[arg], "--cold") == 0 )
+	{
+	    bench.cold = true;
+	    continue;
+	}
+	if ( arg + 1 == argc )
+	    usage(argv);
+	end = "";
+	if ( strcmp(argv[arg], "--tool") == 0 )
+	    bench.tool = argv[++arg];
+	else if ( strcmp(argv[arg], "--input") == 0 )
+	    bench.input = bench.files[bench.file_count++] = argv[++arg];
+	else if ( strcmp(argv[arg], "--file") == 0 )
+	    bench.files[bench.file_count++] = argv[++arg];
+	else if ( strcmp(argv[arg], "--output") == 0 )
+	    bench.output = argv[++arg];
+	else if ( strcmp(argv[arg], "--runs") == 0 )
+	    bench.runs = strtol(argv[++arg], &end, 10);
+	else if ( strcmp(argv[arg], "--cpu") == 0 )
+	    bench.cpu = strtol(argv[++arg], &end, 10);
+	else if ( strcmp(argv[arg], "--bytes") == 0 )
+	    bench.bytes = strtoull(argv[++arg], &end, 10);
+	else if ( strcmp(argv[arg], "--records") == 0 )
+	    bench.records = strtoull(argv[++arg], &end, 10);
+	else
+	    usage(argv);
+	if ( (*end != '\0') || (bench.file_count == MAX_FILES) )
+	    usage(argv);
+    }
+    if ( (arg + 1 >= argc) || (bench.runs < 1) || (bench.runs > MAX_RUNS) )
+	usage(argv);
+
+    // Untimed run to load binaries, libraries, and (if warm) input.
+    // Only this run shows stderr, so messages are not repeated.
+    status = run_once(&bench, argv + arg + 1, &warmup, false);
+    if ( status != EX_OK )
+	return status;
+    for (c = 0; c < bench.runs; ++c)
+    {
+	if ( (status = run_once(&bench, argv + arg + 1, &runs[c], true))
+		!= EX_OK )
+	    return status;
+	walls[c] = runs[c].wall;
+	user += runs[c].user;
+	sys += runs[c].sys;
+	if ( runs[c].max_rss_kib > max_rss_kib )
+	    max_rss_kib = runs[c].max_rss_kib;
+	if ( (runs[c].status != 0) && (status == 0) )
+	    status = runs[c].status;
+    }
+    qsort(walls, bench.runs, sizeof(*walls), double_cmp);
+    median = bench.runs % 2 ? walls[bench.runs / 2] :
+	     (walls[bench.runs / 2 - 1] + walls[bench.runs / 2]) / 2;
+
+    printf("{\"tool\": \"%s\", \"runs\": %d, \"cache\": \"%s\", "
+	   "\"bytes\": %" PRIu64 ", \"records\": %" PRIu64 ", "
+	   "\"wall_median\": %.4f, \"wall_min\": %.4f, \"wall_max\": %.4f, "
+	   "\"user_mean\": %.4f, \"sys_mean\": %.4f, "
+	   "\"mb_per_sec\": %.2f, \"records_per_sec\": %.0f, "
+	   "\"max_rss_kib\": %ld, \"exit_status\": %d}\n",
+	   bench.tool, bench.runs, bench.cold ? "cold" : "warm",
+	   bench.bytes, bench.records,
+	   median, walls[0], walls[bench.runs - 1],
+	   user / bench.runs, sys / bench.runs,
+	   median > 0 ? bench.bytes / 1e6 / median : 0,
+	   median > 0 ? bench.records / median : 0,
+	   max_rss_kib, status);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fork and exec cmd with stdin and stdout redirected and collect
+ *      its resource usage.  Returns EX_OK if the command ran, even if
+ *      it exited nonzero (reported in run->status).  If quiet, the
+ *      command's stderr is discarded.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     run_once(bench_t *bench, char *cmd[], run_t *run, bool quiet)
+
+{
+    struct timespec start, end;
+    struct rusage   usage;
+    pid_t           pid;
+    int             status, infd, outfd;
+
+    if ( bench->cold )
+	evict(bench);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if ( (pid = fork()) == 0 )
+    {
+	if ( bench->cpu >= 0 )
+	    pin_cpu(bench->cpu);
+	infd = open(bench->input == NULL ? "/dev/null" : bench->input,
+		    O_RDONLY);
+	outfd = open(bench->output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if ( (infd == -1) || (outfd == -1) )
+	{
+	    fprintf(stderr, "bench-run: %s: %s\n", bench->tool,
+		    strerror(errno));
+	    _exit(EX_NOINPUT);
+	}
+	dup2(infd, STDIN_FILENO);
+	dup2(outfd, STDOUT_FILENO);
+	if ( quiet )
+	    dup2(open("/dev/null", O_WRONLY), STDERR_FILENO);
+	execvp(cmd[0], cmd);
+	fprintf(stderr, "bench-run: Cannot run %s: %s\n", cmd[0],
+		strerror(errno));
+	_exit(EX_UNAVAILABLE);
+    }
+    else if ( pid == -1 )
+    {
+	fprintf(stderr, "bench-run: fork() failed: %s\n", strerror(errno));
+	return EX_OSERR;
+    }
+    if ( wait4(pid, &status, 0, &usage) == -1 )
+    {
+	fprintf(stderr, "bench-run: wait4() failed: %s\n", strerror(errno));
+	return EX_OSERR;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    run->wall = (end.tv_sec - start.tv_sec) +
+		(end.tv_nsec - start.tv_nsec) / 1e9;
+    run->user = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    run->sys = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#ifdef __APPLE__
+    run->max_rss_kib = usage.ru_maxrss / 1024;  // Bytes on macOS
+#else
+    run->max_rss_kib = usage.ru_maxrss;
+#endif
+    run->status = WIFEXITED(status) ? WEXITSTATUS(status) :
+		  128 + WTERMSIG(status);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Drop input files from the page cache.  POSIX_FADV_DONTNEED
+ *      discards clean cached pages without root, unlike writing to
+ *      /proc/sys/vm/drop_caches.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    evict(bench_t *bench)
+
+{
+#ifdef POSIX_FADV_DONTNEED
+    int     c, fd;
+
+    for (c = 0; c < bench->file_count; ++c)
+    {
+	if ( (fd = open(bench->files[c], O_RDONLY)) != -1 )
+	{
+	    fdatasync(fd);
+	    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	    close(fd);
+	}
+    }
+#else
+    static bool warned = false;
+
+    if ( !warned )
+	fputs("bench-run: Cannot evict files on this platform, "
+	      "results are warm.\n", stderr);
+    warned = true;
+#endif
+}
+
+
+void    pin_cpu(int cpu)
+
+{
+#if defined(__linux__)
+    cpu_set_t   set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if ( sched_setaffinity(0, sizeof(set), &set) != 0 )
+	fprintf(stderr, "bench-run: Cannot pin to CPU %d: %s\n",
+		cpu, strerror(errno));
+#elif defined(__FreeBSD__)
+    cpuset_t    set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if ( cpuset_setaffinity(CPU_LEVEL_WHICH, CPU_WHICH_PID, -1,
+			    sizeof(set), &set) != 0 )
+	fprintf(stderr, "bench-run: Cannot pin to CPU %d: %s\n",
+		cpu, strerror(errno));
+#else
+    fprintf(stderr, "bench-run: CPU pinning not supported here.\n");
+#endif
+}
+
+
+int     double_cmp(const void *p1, const void *p2)
+
+{
+    double  d1 = *(const double *)p1,
+	    d2 = *(const double *)p2;
+
+    return (d1 > d2) - (d1 < d2);
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--tool name] [--input file] [--file file]\n"
+	    "\t[--output file] [--runs N] [--cpu N] [--cold]\n"
+	    "\t[--bytes N] [--records N] -- command [args]\n", argv[0]);
+    exit(EX_USAGE);
+}
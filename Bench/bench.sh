@@ -0,0 +1,268 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Synopsis:
+#       make bench [BENCH_SIZE=MiB] [BENCH_RUNS=N] [BENCH_CPU=N|""]
+#           [BENCH_CACHE=warm|cold] [BENCH_SEED=N] [BENCH_OUT=file.json]
+#
+#   Description:
+#       Benchmark every subcommand in BINS on synthetic data from
+#       bench-gen, which is regenerated identically on any machine, and
+#       write median wall time, MB/s, records/s, and peak RSS per
+#       subcommand as JSON.  Compare two result files with
+#       bench-compare.sh to catch regressions between commits.
+#
+#       Run from the top source directory after "make all", which
+#       "make bench" does automatically.  Every subcommand in BINS must
+#       have an entry in bench_tool() below, or this script fails after
+#       writing the results it could collect.
+#
+#   Environment:
+#       BENCH_SIZE  Size of each generated input in MiB (default 64)
+#       BENCH_RUNS  Timed runs per subcommand, after one warm-up (3)
+#       BENCH_CPU   CPU to pin each run to, or empty for no pinning (0)
+#       BENCH_CACHE warm, or cold to evict inputs before each run (warm)
+#       BENCH_SEED  Generator seed (1)
+#       BENCH_OUT   Output JSON (Bench/Results/<git describe>.json)
+#
+#   History:
+#   Date        Name        Modification
+#   2026-10-19  Jason Bacon Begin
+##########################################################################
+
+size=${BENCH_SIZE:-64}
+runs=${BENCH_RUNS:-3}
+cpu=${BENCH_CPU-0}
+cache=${BENCH_CACHE:-warm}
+seed=${BENCH_SEED:-1}
+commit=$(git describe --always --dirty 2>/dev/null || echo unknown)
+out=${BENCH_OUT:-Bench/Results/$commit.json}
+
+. Bench/bench-data.sh
+
+case $cache in
+warm)
+    cache_opt=''
+    ;;
+cold)
+    cache_opt='--cold'
+    ;;
+*)
+    printf "Invalid BENCH_CACHE: $cache\n" >&2
+    exit 1
+    ;;
+esac
+cpu_opt=${cpu:+--cpu $cpu}
+
+##########################################################################
+# Synthetic inputs, cached in Bench/Data by size and seed
+
+data=Bench/Data/$size-$seed
+mkdir -p $(dirname $out)
+bench_data $data bench $size $seed
+
+##########################################################################
+#   measure label stdin-file bytes records [other-input ...] -- command
+#   stdin-file may be "" for commands that open their own input.
+#   Other inputs are only listed so they can be evicted for cold runs.
+
+results=$out.tmp
+: > $results
+
+measure()
+{
+    label=$1
+    stdin=$2
+    bytes=$3
+    records=$4
+    shift 4
+    files=''
+    while [ "$1" != -- ]; do
+	files="$files --file $1"
+	shift
+    done
+    shift
+    result=$(Bench/bench-run --tool "$label" ${stdin:+--input $stdin} \
+	$files --runs $runs $cpu_opt $cache_opt \
+	--bytes $bytes --records $records -- "$@")
+    printf '%s\n' "$result" >> $results
+    printf "%-28s %s\n" "$label" "$(printf '%s\n' "$result" | sed -e \
+	's|.*"wall_median": \([^,]*\),.*"mb_per_sec": \([^,]*\),.*"max_rss_kib": \([^,]*\), "exit_status": \([^}]*\)}|\1 s  \2 MB/s  \3 KiB  exit \4|' \
+	-e 's|  exit 0$||')"
+    case "$result" in
+    *'"exit_status": 0}')
+	;;
+    *)
+	failed="$failed '$label'"
+	;;
+    esac
+}
+
+bench_tool()
+{
+    case $1 in
+    chrom-lens)
+	measure chrom-lens $fasta $fasta_bytes $fasta_records -- ./chrom-lens
+	;;
+    deromanize)
+	measure deromanize $gff3 $gff3_bytes $gff3_records -- ./deromanize 1
+	;;
+    ensemblid2gene)
+	measure ensemblid2gene '' $gff3_bytes $gff3_records $gff3 $ids \
+	    -- ./ensemblid2gene $gff3 $ids
+	measure 'ensemblid2gene --index' '' $gff3_bytes $gff3_records $gff3 \
+	    -- ./ensemblid2gene --index $gff3
+	measure 'ensemblid2gene --table' '' $gff3_bytes $gff3_records \
+	    $gff3.e2g $ids -- ./ensemblid2gene --table $gff3 $ids
+	rm -f $gff3.e2g
+	;;
+    extract-seq)
+	measure extract-seq '' $(($gff3_bytes + $fasta_bytes)) \
+	    $gff3_records $gff3 $fasta \
+	    -- ./extract-seq $gff3 $fasta gene 'Name=bg1;'
+	;;
+    fasta-pack)
+	measure fasta-pack $fasta $fasta_bytes $fasta_records -- ./fasta-pack
+	./fasta-pack < $fasta > $data/bench.2bit 2> /dev/null
+	measure 'chrom-lens 2bit' $data/bench.2bit $fasta_bytes \
+	    $fasta_records -- ./chrom-lens
+	measure 'fasta2seq 2bit' $data/bench.2bit $fasta_bytes \
+	    $fasta_records -- ./fasta2seq
+	measure 'extract-seq 2bit' '' $(($gff3_bytes + $fasta_bytes)) \
+	    $gff3_records $gff3 $data/bench.2bit \
+	    -- ./extract-seq $gff3 $data/bench.2bit gene 'Name=bg1;'
+	;;
+    fasta2seq)
+	measure fasta2seq $fasta $fasta_bytes $fasta_records -- ./fasta2seq
+	;;
+    fastx-derep)
+	measure fastx-derep $fastq $fastq_bytes $fastq_records -- ./fastx-derep
+	measure 'fastx-derep --bgzf' $fastq $fastq_bytes $fastq_records \
+	    -- ./fastx-derep --bgzf
+	;;
+    fastx-diff)
+	measure fastx-diff '' $(($fastq_bytes * 2)) $(($fastq_records * 2)) \
+	    $fastq -- ./fastx-diff $fastq $fastq
+	measure 'fastx-diff --unordered' '' $(($fastq_bytes * 2)) \
+	    $(($fastq_records * 2)) $fastq \
+	    -- ./fastx-diff --unordered $fastq $fastq
+	;;
+    fastx-filter)
+	measure fastx-filter $fastq $fastq_bytes $fastq_records \
+	    -- ./fastx-filter --min-length 100 --max-n 2 \
+	    --min-mean-quality 20 --window 10 --min-window-quality 12
+	;;
+    fastx-kmers)
+	measure fastx-kmers '' $fastq_bytes $fastq_records $fastq \
+	    -- ./fastx-kmers $fastq
+	measure 'fastx-kmers --histogram' '' $fastq_bytes $fastq_records \
+	    $fastq -- ./fastx-kmers --histogram $fastq
+	measure 'fastx-kmers --partitions' '' $fastq_bytes $fastq_records \
+	    $fastq -- ./fastx-kmers --partitions 16 --tmpdir $data $fastq
+	;;
+    fastx-split)
+	measure fastx-split $fastq $fastq_bytes $fastq_records \
+	    -- ./fastx-split --records 20000 --prefix $data/part
+	measure 'fastx-split --round-robin' $fastq $fastq_bytes \
+	    $fastq_records -- ./fastx-split --round-robin 8 --prefix $data/part
+	measure 'fastx-split --parts' $fastq $fastq_bytes $fastq_records \
+	    -- ./fastx-split --parts 8 --prefix $data/part
+	rm -f $data/part-*
+	;;
+    fastx-stats)
+	measure fastx-stats '' $fastq_bytes $fastq_records $fastq \
+	    -- ./fastx-stats $fastq
+	;;
+    fastx-translate)
+	measure fastx-translate $fastq $fastq_bytes $fastq_records \
+	    -- ./fastx-translate --frames 6
+	;;
+    fastx2tsv)
+	measure fastx2tsv $fastq $fastq_bytes $fastq_records -- ./fastx2tsv
+	measure 'fastx2tsv fasta' $fasta $fasta_bytes $fasta_records \
+	    -- ./fastx2tsv
+	;;
+    find-orfs)
+	measure find-orfs $fasta $fasta_bytes $fasta_records -- ./find-orfs
+	;;
+    gff3-query)
+	measure 'gff3-query --index' '' $gff3_bytes $gff3_records $gff3 \
+	    -- ./gff3-query --index $gff3
+	measure gff3-query '' $gff3_bytes $gff3_records $gff3 $gff3.gqi \
+	    -- ./gff3-query $gff3 I:1-1000000 IX:5000-6000 XVI:1-1
+	rm -f $gff3.gqi
+	;;
+    gff3-sort)
+	measure gff3-sort '' $gff3_bytes $gff3_records $gff3 \
+	    -- ./gff3-sort $gff3
+	;;
+    gff3-to-bed)
+	measure gff3-to-bed $gff3 $gff3_bytes $gff3_records -- ./gff3-to-bed
+	measure 'gff3-to-bed --bgzf' $gff3 $gff3_bytes $gff3_records \
+	    -- ./gff3-to-bed --bgzf
+	;;
+    phred-decode)
+	measure phred-decode $fastq $fastq_bytes $fastq_records \
+	    -- ./phred-decode
+	;;
+    phred-encode)
+	measure phred-encode $fastq $fastq_bytes $fastq_records \
+	    -- ./phred-encode --to 64
+	;;
+    vcf-downsample)
+	measure vcf-downsample $vcf $vcf_bytes $vcf_records \
+	    -- ./vcf-downsample 1000
+	;;
+    vcf-search)
+	measure vcf-search $vcf $vcf_bytes $vcf_records \
+	    -- ./vcf-search XVI 1000
+	;;
+    *)
+	return 1
+	;;
+    esac
+}
+
+##########################################################################
+# Run and assemble JSON
+
+printf "\n%s, %s MiB inputs, %s runs, %s cache, CPU %s\n\n" \
+    $commit $size $runs $cache "${cpu:-not pinned}"
+missing=''
+failed=''
+for tool in $BINS; do
+    if ! bench_tool $tool; then
+	printf "%-28s no benchmark defined\n" $tool
+	missing="$missing $tool"
+    fi
+done
+
+{
+    printf '{\n'
+    printf '  "commit": "%s",\n' $commit
+    printf '  "date": "%s",\n' "$(date -u '+%Y-%m-%dT%H:%M:%SZ')"
+    printf '  "host": "%s",\n' "$(hostname)"
+    printf '  "system": "%s",\n' "$(uname -srm)"
+    printf '  "size_mib": %s,\n' $size
+    printf '  "seed": %s,\n' $seed
+    printf '  "runs": %s,\n' $runs
+    printf '  "cpu": "%s",\n' "$cpu"
+    printf '  "cache": "%s",\n' $cache
+    printf '  "results": [\n'
+    sed -e 's|^|    |' -e '$!s|$|,|' $results
+    printf '  ]\n}\n'
+} > $out
+rm -f $results
+printf "\nResults saved to $out.\n"
+
+status=0
+if [ -n "$failed" ]; then
+    printf "Nonzero exit status from:$failed\n" >&2
+    status=1
+fi
+if [ -n "$missing" ]; then
+    printf "No benchmark defined for:$missing\n" >&2
+    printf "Add them to bench_tool() in $0.\n" >&2
+    status=1
+fi
+exit $status
@@ -0,0 +1,212 @@
+/***************************************************************************
+ *  Description:
+ *      Count heap allocations made by a command, for the resource
+ *      budget tests run by "make test".  Loaded with LD_PRELOAD by
+ *      budget-run, which sets BLT_ALLOC_COUNT to a file name.
+ *
+ *      malloc(), calloc(), realloc(), and the aligned allocators are
+ *      counted and forwarded to the real allocator found with
+ *      dlsym(RTLD_NEXT).  At exit, the number of calls is appended to
+ *      the BLT_ALLOC_COUNT file as one line, so commands that run
+ *      other commands report a line per process.
+ *
+ *      dlsym() itself may call calloc() before the real calloc() is
+ *      known, so the first few requests are served from a static
+ *      buffer, which free() recognizes and ignores.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#define _GNU_SOURCE     // RTLD_NEXT
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sysexits.h>
+
+#define BOOTSTRAP_SIZE  4096
+
+static void *(*Real_malloc)(size_t);
+static void *(*Real_calloc)(size_t, size_t);
+static void *(*Real_realloc)(void *, size_t);
+static void (*Real_free)(void *);
+static int  (*Real_posix_memalign)(void **, size_t, size_t);
+static void *(*Real_aligned_alloc)(size_t, size_t);
+
+static uint64_t Allocs;
+static char     Bootstrap[BOOTSTRAP_SIZE]
+		    __attribute__((aligned(16)));
+static size_t   Bootstrap_used;
+static int      Resolving;
+
+static void resolve(void);
+static void *bootstrap_alloc(size_t size);
+
+#define IN_BOOTSTRAP(p) \
+    ((char *)(p) >= Bootstrap && (char *)(p) < Bootstrap + BOOTSTRAP_SIZE)
+
+// Relaxed: only the total at exit matters, not ordering between threads
+#define COUNT()     __atomic_fetch_add(&Allocs, 1, __ATOMIC_RELAXED)
+
+void    *malloc(size_t size)
+
+{
+    if ( Real_malloc == NULL )
+    {
+	if ( Resolving )
+	    return bootstrap_alloc(size);
+	resolve();
+    }
+    COUNT();
+    return Real_malloc(size);
+}
+
+
+void    *calloc(size_t count, size_t size)
+
+{
+    if ( Real_calloc == NULL )
+    {
+	if ( Resolving )
+	{
+	    // Static buffer is already zeroed
+	    if ( (size != 0) && (count > SIZE_MAX / size) )
+		return NULL;
+	    return bootstrap_alloc(count * size);
+	}
+	resolve();
+    }
+    COUNT();
+    return Real_calloc(count, size);
+}
+
+
+void    *realloc(void *ptr, size_t size)
+
+{
+    void    *p;
+    size_t  avail;
+
+    if ( Real_realloc == NULL )
+	resolve();
+    if ( IN_BOOTSTRAP(ptr) )
+    {
+	// Size of the old block is unknown, but it lies within Bootstrap
+	avail = Bootstrap + BOOTSTRAP_SIZE - (char *)ptr;
+	if ( (p = malloc(size)) != NULL )
+	    memcpy(p, ptr, size < avail ? size : avail);
+	return p;
+    }
+    COUNT();
+    return Real_realloc(ptr, size);
+}
+
+
+void    free(void *ptr)
+
+{
+    if ( IN_BOOTSTRAP(ptr) )
+	return;
+    if ( Real_free == NULL )
+	resolve();
+    Real_free(ptr);
+}
+
+
+int     posix_memalign(void **ptr, size_t alignment, size_t size)
+
+{
+    if ( Real_posix_memalign == NULL )
+	resolve();
+    COUNT();
+    return Real_posix_memalign(ptr, alignment, size);
+}
+
+
+void    *aligned_alloc(size_t alignment, size_t size)
+
+{
+    if ( Real_aligned_alloc == NULL )
+	resolve();
+    COUNT();
+    return Real_aligned_alloc(alignment, size);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append the allocation count to $BLT_ALLOC_COUNT at exit.  Uses
+ *      only open() and write(), so nothing is allocated while
+ *      reporting.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+__attribute__((destructor))
+static void report(void)
+
+{
+    char        line[32], *p = line + sizeof(line);
+    const char  *filename;
+    uint64_t    count = __atomic_load_n(&Allocs, __ATOMIC_RELAXED);
+    int         fd;
+
+    if ( (filename = getenv("BLT_ALLOC_COUNT")) == NULL )
+	return;
+    *--p = '\n';
+    do
+    {
+	*--p = '0' + count % 10;
+	count /= 10;
+    }   while ( count > 0 );
+    if ( (fd = open(filename, O_WRONLY | O_APPEND | O_CREAT, 0600)) != -1 )
+    {
+	write(fd, p, line + sizeof(line) - p);
+	close(fd);
+    }
+}
+
+
+static void resolve(void)
+
+{
+    Resolving = 1;
+    Real_malloc = dlsym(RTLD_NEXT, "malloc");
+    Real_calloc = dlsym(RTLD_NEXT, "calloc");
+    Real_realloc = dlsym(RTLD_NEXT, "realloc");
+    Real_free = dlsym(RTLD_NEXT, "free");
+    Real_posix_memalign = dlsym(RTLD_NEXT, "posix_memalign");
+    Real_aligned_alloc = dlsym(RTLD_NEXT, "aligned_alloc");
+    Resolving = 0;
+    if ( (Real_malloc == NULL) || (Real_calloc == NULL) ||
+	 (Real_realloc == NULL) || (Real_free == NULL) )
+    {
+	static const char msg[] = "alloc-count: Cannot find allocator.\n";
+
+	write(STDERR_FILENO, msg, sizeof(msg) - 1);
+	_exit(EX_SOFTWARE);
+    }
+}
+
+
+static void *bootstrap_alloc(size_t size)
+
+{
+    void    *p;
+
+    // Keep 16-byte alignment, as malloc() guarantees
+    size = (size + 15) & ~(size_t)15;
+    if ( size > BOOTSTRAP_SIZE - Bootstrap_used )
+	return NULL;
+    p = Bootstrap + Bootstrap_used;
+    Bootstrap_used += size;
+    return p;
+}
@@ -0,0 +1,318 @@
+/***************************************************************************
+ *  Description:
+ *      Run a command once with stdin from a file and check its resource
+ *      use against limits, for the budget tests run by "make test".
+ *
+ *      Peak RSS comes from wait4(2), as in Bench/bench-run.  Heap
+ *      allocations are counted by preloading alloc-count.so and divided
+ *      by the number of input records.  On Linux, read and write system
+ *      calls are taken from /proc/<pid>/io, which is read after the
+ *      command exits but before it is reaped, and divided by MB of
+ *      input.  Where /proc/<pid>/io is not available, the system call
+ *      limit is reported as not measured rather than failing.
+ *
+ *      Unlike timings, these figures barely vary between runs or
+ *      machines, so tight limits catch a regression such as a
+ *      per-record malloc() or an unbuffered write without false alarms.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+typedef struct
+{
+    const char  *tool;
+    const char  *input;
+    const char  *output;
+    const char  *alloc_lib;
+    uint64_t    bytes;
+    uint64_t    records;
+    long        max_rss_kib;        // Limits, 0 = unchecked
+    double      max_allocs_per_record;
+    double      max_syscalls_per_mb;
+}   budget_t;
+
+typedef struct
+{
+    long        max_rss_kib;
+    int64_t     allocs;             // -1 = not measured
+    int64_t     syscalls;           // -1 = not measured
+    int         status;
+}   usage_t;
+
+int     run_once(budget_t *budget, char *cmd[], usage_t *usage);
+int64_t read_syscalls(pid_t pid);
+int64_t read_allocs(const char *filename);
+void    usage(char *argv[]);
+
+int     main(int argc, char *argv[])
+
+{
+    budget_t    budget = { "", NULL, "/dev/null", NULL, 0, 0, 0, 0, 0 };
+    usage_t     use;
+    double      allocs_per_record = 0, syscalls_per_mb = 0;
+    char        *end, allocs_text[32], syscalls_text[32];
+    int         arg, status;
+    bool        over = false;
+
+    for (arg = 1; (arg < argc) && (strcmp(argv[arg], "--") != 0); ++arg)
+    {
+	if ( arg + 1 == argc )
+	    usage(argv);
+	end = "";
+	if ( strcmp(argv[arg], "--tool") == 0 )
+	    budget.tool = argv[++arg];
+	else if ( strcmp(argv[arg], "--input") == 0 )
+	    budget.input = argv[++arg];
+	else if ( strcmp(argv[arg], "--output") == 0 )
+	    budget.output = argv[++arg];
+	else if ( strcmp(argv[arg], "--alloc-lib") == 0 )
+	    budget.alloc_lib = argv[++arg];
+	else if ( strcmp(argv[arg], "--bytes") == 0 )
+	    budget.bytes = strtoull(argv[++arg], &end, 10);
+	else if ( strcmp(argv[arg], "--records") == 0 )
+	    budget.records = strtoull(argv[++arg], &end, 10);
+	else if ( strcmp(argv[arg], "--max-rss-kib") == 0 )
+	    budget.max_rss_kib = strtol(argv[++arg], &end, 10);
+	else if ( strcmp(argv[arg], "--max-allocs-per-record") == 0 )
+	    budget.max_allocs_per_record = strtod(argv[++arg], &end);
+	else if ( strcmp(argv[arg], "--max-syscalls-per-mb") == 0 )
+	    budget.max_syscalls_per_mb = strtod(argv[++arg], &end);
+	else
+	    usage(argv);
+	if ( *end != '\0' )
+	    usage(argv);
+    }
+    if ( (arg + 1 >= argc) || (budget.bytes == 0) || (budget.records == 0) )
+	usage(argv);
+
+    if ( (status = run_once(&budget, argv + arg + 1, &use)) != EX_OK )
+	return status;
+    if ( use.status != 0 )
+    {
+	fprintf(stderr, "budget-run: %s: Exit status %d.\n", budget.tool,
+		use.status);
+	return EX_SOFTWARE;
+    }
+
+    strcpy(allocs_text, "not measured");
+    if ( use.allocs >= 0 )
+    {
+	allocs_per_record = (double)use.allocs / budget.records;
+	snprintf(allocs_text, sizeof(allocs_text), "%.3f", allocs_per_record);
+    }
+    strcpy(syscalls_text, "not measured");
+    if ( use.syscalls >= 0 )
+    {
+	syscalls_per_mb = use.syscalls / (budget.bytes / 1e6);
+	snprintf(syscalls_text, sizeof(syscalls_text), "%.1f",
+		 syscalls_per_mb);
+    }
+    printf("%-32s %8ld KiB  %12s allocs/record  %12s syscalls/MB\n",
+	   budget.tool, use.max_rss_kib, allocs_text, syscalls_text);
+
+    if ( (budget.max_rss_kib > 0) && (use.max_rss_kib > budget.max_rss_kib) )
+    {
+	printf("    Peak RSS %ld KiB exceeds budget of %ld KiB.\n",
+	       use.max_rss_kib, budget.max_rss_kib);
+	over = true;
+    }
+    if ( (budget.max_allocs_per_record > 0) && (use.allocs >= 0) &&
+	 (allocs_per_record > budget.max_allocs_per_record) )
+    {
+	printf("    %.3f allocations per record exceeds budget of %g.\n",
+	       allocs_per_record, budget.max_allocs_per_record);
+	over = true;
+    }
+    if ( (budget.max_syscalls_per_mb > 0) && (use.syscalls >= 0) &&
+	 (syscalls_per_mb > budget.max_syscalls_per_mb) )
+    {
+	printf("    %.1f system calls per MB exceeds budget of %g.\n",
+	       syscalls_per_mb, budget.max_syscalls_per_mb);
+	over = true;
+    }
+    return over ? 1 : EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fork and exec cmd with stdin and stdout redirected and the
+ *      allocation counter preloaded, and collect its resource usage.
+ *      Returns EX_OK if the command ran, even if it exited nonzero
+ *      (reported in use->status).
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     run_once(budget_t *budget, char *cmd[], usage_t *use)
+
+{
+    struct rusage   rusage;
+    siginfo_t       info;
+    pid_t           pid;
+    int             status, infd, outfd, countfd;
+    char            count_file[] = "/tmp/budget-run.XXXXXX";
+
+    if ( (countfd = mkstemp(count_file)) == -1 )
+    {
+	fprintf(stderr, "budget-run: Cannot create %s: %s\n", count_file,
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    close(countfd);
+
+    if ( (pid = fork()) == 0 )
+    {
+	infd = open(budget->input == NULL ? "/dev/null" : budget->input,
+		    O_RDONLY);
+	outfd = open(budget->output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if ( (infd == -1) || (outfd == -1) )
+	{
+	    fprintf(stderr, "budget-run: %s: %s\n", budget->tool,
+		    strerror(errno));
+	    _exit(EX_NOINPUT);
+	}
+	dup2(infd, STDIN_FILENO);
+	dup2(outfd, STDOUT_FILENO);
+	if ( budget->alloc_lib != NULL )
+	{
+	    setenv("LD_PRELOAD", budget->alloc_lib, 1);
+	    setenv("BLT_ALLOC_COUNT", count_file, 1);
+	}
+	execvp(cmd[0], cmd);
+	fprintf(stderr, "budget-run: Cannot run %s: %s\n", cmd[0],
+		strerror(errno));
+	_exit(EX_UNAVAILABLE);
+    }
+    else if ( pid == -1 )
+    {
+	fprintf(stderr, "budget-run: fork() failed: %s\n", strerror(errno));
+	unlink(count_file);
+	return EX_OSERR;
+    }
+
+    // Leave the command a zombie until its /proc entry has been read
+    if ( waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == -1 )
+    {
+	fprintf(stderr, "budget-run: waitid() failed: %s\n", strerror(errno));
+	unlink(count_file);
+	return EX_OSERR;
+    }
+    use->syscalls = read_syscalls(pid);
+    if ( wait4(pid, &status, 0, &rusage) == -1 )
+    {
+	fprintf(stderr, "budget-run: wait4() failed: %s\n", strerror(errno));
+	unlink(count_file);
+	return EX_OSERR;
+    }
+    use->allocs = budget->alloc_lib == NULL ? -1 : read_allocs(count_file);
+    unlink(count_file);
+
+#ifdef __APPLE__
+    use->max_rss_kib = rusage.ru_maxrss / 1024;  // Bytes on macOS
+#else
+    use->max_rss_kib = rusage.ru_maxrss;
+#endif
+    use->status = WIFEXITED(status) ? WEXITSTATUS(status) :
+		  128 + WTERMSIG(status);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read and write system calls of an exited, unreaped process,
+ *      including all of its threads.
+ *
+ *  Returns:
+ *      The sum of syscr and syscw, or -1 if not available
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int64_t read_syscalls(pid_t pid)
+
+{
+    char        filename[64], name[32];
+    FILE        *fp;
+    int64_t     count = 0, val;
+    int         found = 0;
+
+    snprintf(filename, sizeof(filename), "/proc/%d/io", (int)pid);
+    if ( (fp = fopen(filename, "r")) == NULL )
+	return -1;
+    while ( fscanf(fp, "%31[^:]: %" SCNd64 "\n", name, &val) == 2 )
+    {
+	if ( (strcmp(name, "syscr") == 0) || (strcmp(name, "syscw") == 0) )
+	{
+	    count += val;
+	    ++found;
+	}
+    }
+    fclose(fp);
+    return found == 2 ? count : -1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Total the counts written by alloc-count.so, one line per process.
+ *
+ *  Returns:
+ *      The number of allocations, or -1 if none were reported, e.g.
+ *      because the platform ignores LD_PRELOAD
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int64_t read_allocs(const char *filename)
+
+{
+    FILE        *fp;
+    int64_t     count = 0, val;
+    int         lines = 0;
+
+    if ( (fp = fopen(filename, "r")) == NULL )
+	return -1;
+    while ( fscanf(fp, "%" SCNd64, &val) == 1 )
+    {
+	count += val;
+	++lines;
+    }
+    fclose(fp);
+    return lines > 0 ? count : -1;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--tool name] [--input file] [--output file]\n"
+	    "\t[--alloc-lib alloc-count.so] --bytes N --records N\n"
+	    "\t[--max-rss-kib N] [--max-allocs-per-record N]\n"
+	    "\t[--max-syscalls-per-mb N] -- command [args]\n", argv[0]);
+    exit(EX_USAGE);
+}
@@ -0,0 +1,212 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Synopsis:
+#       make test [TEST_SIZE=MiB] [TEST_SEED=N]
+#
+#   Description:
+#       Check the resource use of every subcommand in BINS against the
+#       budget recorded for it in budget_tool() below, on synthetic data
+#       from Bench/bench-gen.  A subcommand fails if its peak RSS, heap
+#       allocations per input record, or read/write system calls per MB
+#       of input exceed its budget, so a change that buffers whole
+#       chromosomes, allocates per record, or writes unbuffered fails
+#       here even though its output is still correct.
+#
+#       test.sh checks output correctness on small files and is run
+#       separately.
+#
+#       Budgets are set with headroom over measured use at the default
+#       size, and RSS budgets assume it, so use the default size when
+#       checking for regressions.  When a change legitimately needs more,
+#       raise the budget in the same commit and explain why.
+#
+#       Run from the top source directory after "make all", which
+#       "make test" does automatically.  Every subcommand in BINS must
+#       have an entry in budget_tool().
+#
+#   Environment:
+#       TEST_SIZE   Size of each generated input in MiB (default 32)
+#       TEST_SEED   Generator seed (1)
+#
+#   History:
+#   Date        Name        Modification
+#   2026-10-19  Jason Bacon Begin
+##########################################################################
+
+size=${TEST_SIZE:-32}
+seed=${TEST_SEED:-1}
+
+. Bench/bench-data.sh
+
+##########################################################################
+# Synthetic inputs, cached in Test/Data by size and seed
+
+data=Test/Data/$size-$seed
+bench_data $data test $size $seed
+
+##########################################################################
+#   check label stdin-file bytes records max-rss-kib max-allocs-per-record
+#       max-syscalls-per-mb -- command
+#   stdin-file may be "" for commands that open their own input.
+
+alloc_lib=$(pwd)/Test/alloc-count.so
+failed=''
+
+check()
+{
+    label=$1
+    stdin=$2
+    bytes=$3
+    records=$4
+    rss=$5
+    allocs=$6
+    syscalls=$7
+    shift 8
+    if ! Test/budget-run --tool "$label" ${stdin:+--input $stdin} \
+	    --alloc-lib $alloc_lib --bytes $bytes --records $records \
+	    --max-rss-kib $rss --max-allocs-per-record $allocs \
+	    --max-syscalls-per-mb $syscalls -- "$@" 2> $data/stderr; then
+	cat $data/stderr >&2
+	failed="$failed '$label'"
+    fi
+}
+
+budget_tool()
+{
+    case $1 in
+    chrom-lens)
+	check chrom-lens $fasta $fasta_bytes $fasta_records 10240 4 8 \
+	    -- ./chrom-lens
+	;;
+    deromanize)
+	check deromanize $gff3 $gff3_bytes $gff3_records 6144 0.5 8 \
+	    -- ./deromanize 1
+	;;
+    ensemblid2gene)
+	check ensemblid2gene '' $gff3_bytes $gff3_records 4096 0.5 4 \
+	    -- ./ensemblid2gene $gff3 $ids
+	;;
+    extract-seq)
+	check extract-seq '' $(($gff3_bytes + $fasta_bytes)) $gff3_records \
+	    24576 1 400 -- ./extract-seq $gff3 $fasta gene 'Name=bg1;'
+	;;
+    fasta-pack)
+	check fasta-pack $fasta $fasta_bytes $fasta_records 12288 4 8 \
+	    -- ./fasta-pack
+	;;
+    fasta2seq)
+	check fasta2seq $fasta $fasta_bytes $fasta_records 6144 4 8 \
+	    -- ./fasta2seq
+	;;
+    fastx-derep)
+	check fastx-derep $fastq $fastq_bytes $fastq_records 12288 1.5 400 \
+	    -- ./fastx-derep
+	;;
+    fastx-diff)
+	check fastx-diff '' $(($fastq_bytes * 2)) $(($fastq_records * 2)) \
+	    49152 0.5 4 -- ./fastx-diff $fastq $fastq
+	;;
+    fastx-filter)
+	check fastx-filter $fastq $fastq_bytes $fastq_records 16384 0.5 8 \
+	    -- ./fastx-filter --min-length 100 --max-n 2 \
+	    --min-mean-quality 20 --window 10 --min-window-quality 12
+	;;
+    fastx-kmers)
+	check fastx-kmers '' $fastq_bytes $fastq_records 163840 3 8 \
+	    -- ./fastx-kmers -k 11 --histogram $fastq
+	check 'fastx-kmers --partitions' '' $fastq_bytes $fastq_records \
+	    131072 3 300 -- ./fastx-kmers --histogram --partitions 16 \
+	    --tmpdir $data $fastq
+	;;
+    fastx-split)
+	check fastx-split $fastq $fastq_bytes $fastq_records 12288 0.5 8 \
+	    -- ./fastx-split --records 20000 --prefix $data/part
+	check 'fastx-split --round-robin' $fastq $fastq_bytes $fastq_records \
+	    20480 0.5 8 -- ./fastx-split --round-robin 8 --prefix $data/part
+	check 'fastx-split --round-robin --bgzf' $fastq $fastq_bytes \
+	    $fastq_records 73728 0.5 16 \
+	    -- ./fastx-split --round-robin 64 --bgzf --prefix $data/part
+	check 'fastx-split --parts' $fastq $fastq_bytes $fastq_records \
+	    10240 0.5 4 -- ./fastx-split --parts 8 --prefix $data/part
+	rm -f $data/part-*
+	;;
+    fastx-stats)
+	check fastx-stats '' $fastq_bytes $fastq_records 8192 0.5 8 \
+	    -- ./fastx-stats $fastq
+	;;
+    fastx-translate)
+	check fastx-translate $fastq $fastq_bytes $fastq_records 16384 2 500 \
+	    -- ./fastx-translate --frames 6
+	;;
+    fastx2tsv)
+	check fastx2tsv $fastq $fastq_bytes $fastq_records 8192 0.5 800 \
+	    -- ./fastx2tsv
+	;;
+    find-orfs)
+	check find-orfs $fasta $fasta_bytes $fasta_records 98304 40 400 \
+	    -- ./find-orfs
+	;;
+    gff3-query)
+	check 'gff3-query --index' '' $gff3_bytes $gff3_records 81920 0.5 4 \
+	    -- ./gff3-query --index $gff3
+	check gff3-query '' $gff3_bytes $gff3_records 57344 0.5 16 \
+	    -- ./gff3-query $gff3 I:1-1000000 IX:5000-6000 XVI:1-1
+	rm -f $gff3.gqi
+	;;
+    gff3-sort)
+	check gff3-sort '' $gff3_bytes $gff3_records 57344 0.5 400 \
+	    -- ./gff3-sort $gff3
+	;;
+    gff3-to-bed)
+	check gff3-to-bed $gff3 $gff3_bytes $gff3_records 6144 0.5 8 \
+	    -- ./gff3-to-bed
+	;;
+    phred-decode)
+	check phred-decode $fastq $fastq_bytes $fastq_records 8192 0.5 500 \
+	    -- ./phred-decode
+	;;
+    phred-encode)
+	check phred-encode $fastq $fastq_bytes $fastq_records 8192 0.5 400 \
+	    -- ./phred-encode --to 64
+	;;
+    vcf-downsample)
+	check vcf-downsample $vcf $vcf_bytes $vcf_records 8192 0.5 400 \
+	    -- ./vcf-downsample 1000
+	;;
+    vcf-search)
+	check vcf-search $vcf $vcf_bytes $vcf_records 8192 0.5 8 \
+	    -- ./vcf-search XVI 1000
+	;;
+    *)
+	return 1
+	;;
+    esac
+}
+
+##########################################################################
+# Run and summarize
+
+printf "\n%s MiB inputs, seed %s\n\n" $size $seed
+missing=''
+for tool in $BINS; do
+    if ! budget_tool $tool; then
+	printf "%-28s no budget defined\n" $tool
+	missing="$missing $tool"
+    fi
+done
+
+status=0
+if [ -n "$failed" ]; then
+    printf "\nOver budget or failed:$failed\n" >&2
+    status=1
+fi
+if [ -n "$missing" ]; then
+    printf "No budget defined for:$missing\n" >&2
+    printf "Add them to budget_tool() in $0.\n" >&2
+    status=1
+fi
+if [ $status = 0 ]; then
+    printf "\nAll subcommands within budget.\n"
+fi
+exit $status
@@ -0,0 +1,76 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Synopsis:
+#       overlap-test.sh [gff3-query-command] [rounds]
+#
+#   Description:
+#       Compare gff3-query against a brute-force overlap scan on random
+#       GFF3 files.  Each round uses a new seed and feature counts that
+#       are mostly not powers of two, with a mix of short and long
+#       features, so that max_end errors in the interval tree show up as
+#       missing features.  Starts are unique within a seqid, so both
+#       sides list the features for each region in the same order.
+#
+#       Run from the Test directory.  Exits with status 1 and leaves
+#       temp-overlap.* behind if any region differs.
+#
+#   History:
+#   Date        Name        Modification
+#   2026-10-19  Jason Bacon Begin
+##########################################################################
+
+query=${1:-../gff3-query}
+rounds=${2:-20}
+
+gff3=temp-overlap.gff3
+round=1
+while [ $round -le $rounds ]; do
+    # Random features on a few seqids, sorted by start
+    awk -v seed=$round 'BEGIN {
+	srand(seed);
+	for (s = 1; s <= 4; ++s)
+	{
+	    n = 1 + int(rand() * 100);
+	    split("", used);
+	    for (f = 1; f <= n; ++f)
+	    {
+		do
+		    start = 1 + int(rand() * 5000);
+		while ( start in used );
+		used[start] = 1;
+		len = rand() < 0.3 ? int(rand() * 3000) : int(rand() * 60);
+		printf("chr%d\tsim\tgene\t%d\t%d\t.\t+\t.\tID=g%d.%d\n",
+		       s, start, start + len, s, f);
+	    }
+	}
+    }' | sort -k1,1 -k4,4n > $gff3
+
+    # Random regions, BED coordinates
+    awk -v seed=$round 'BEGIN {
+	srand(seed + 1000);
+	for (q = 0; q < 1000; ++q)
+	{
+	    start = int(rand() * 8000);
+	    printf("chr%d\t%d\t%d\n", 1 + int(rand() * 4), start,
+		   start + 1 + int(rand() * 100));
+	}
+    }' > temp-overlap.bed
+
+    $query --index $gff3 2> /dev/null
+    $query $gff3 --bed temp-overlap.bed > temp-overlap.out
+    awk -F '\t' 'NR == FNR { line[++n] = $0; seqid[n] = $1;
+			     start[n] = $4 - 1; end[n] = $5; next }
+	{
+	    for (f = 1; f <= n; ++f)
+		if ( seqid[f] == $1 && start[f] < $3 && $2 < end[f] )
+		    print line[f];
+	}' $gff3 temp-overlap.bed > temp-overlap.correct
+    if ! diff temp-overlap.correct temp-overlap.out > /dev/null; then
+	printf "Round $round differs.  Check temp-overlap.*\n"
+	exit 1
+    fi
+    round=$(($round + 1))
+done
+rm -f temp-overlap.* $gff3.gqi
+printf "$rounds rounds of random overlap queries passed.\n"
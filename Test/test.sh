@@ -44,6 +44,66 @@ else
 fi
 pause
 
+printf "\n===\nTesting fastx-diff...\n"
+../fastx2tsv < test.fastq | sort -r \
+    | awk -F '\t' '{ printf("%s\n%s\n%s\n%s\n", $1, $2, $3, $4) }' > temp.fastq
+# Same records, wrapped differently
+awk '/^>/ { print; next }
+    { for (c = 1; c <= length($0); c += 10) print substr($0, c, 10) }' \
+    test.fasta > temp.fasta
+if ../fastx-diff test.fastq test.fastq \
+	&& ../fastx-diff --unordered test.fastq temp.fastq \
+	&& ../fastx-diff test.fasta temp.fasta; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.fastq temp.fasta
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.fastq.\n"
+    pause
+    more temp.fastq
+fi
+pause
+
+printf "\n===\nTesting fastx-filter...\n"
+../fastx-filter --min-length 50 --max-n 0 --min-mean-quality 30 \
+    --window 5 --min-window-quality 28 < test.fastq > temp.fastq
+if diff correct-filter.fastq temp.fastq; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.fastq
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.fastq.\n"
+    pause
+fi
+pause
+
+printf "\n===\nTesting fastx-split...\n"
+../fastx-split --records 3 --prefix temp-records test.fastq
+../fastx-split --parts 3 --prefix temp-parts test.fasta
+if cat temp-records-*.fastq | diff test.fastq - && \
+   cat temp-parts-*.fasta | diff test.fasta -; then
+    printf "No differences found, test passed.\n"
+    rm -f temp-records-*.fastq temp-parts-*.fasta
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp-records-*.fastq and temp-parts-*.fasta.\n"
+    pause
+fi
+pause
+
+printf "\n===\nTesting fastx-kmers...\n"
+../fastx-kmers -k 11 test.fastq > temp-memory.kmers
+../fastx-kmers -k 11 --partitions 4 --tmpdir . test.fastq > temp-part.kmers
+if diff temp-memory.kmers temp-part.kmers; then
+    printf "No differences found, test passed.\n"
+    rm -f temp-memory.kmers temp-part.kmers
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp-memory.kmers and temp-part.kmers.\n"
+    pause
+fi
+pause
+
 printf "\n===\nTesting fasta2seq...\n"
 ../fasta2seq < test.fasta > temp.seq
 if diff correct.seq temp.seq; then
@@ -56,6 +116,39 @@ else
 fi
 pause
 
+printf "\n===\nTesting fasta-pack...\n"
+../fasta-pack < test.fasta > temp.2bit
+../chrom-lens < test.fasta > temp-fasta.lens
+../chrom-lens < temp.2bit > temp-2bit.lens
+# .2bit has no U, so fasta-pack stores it as T
+../fasta2seq < temp.2bit | tr T U > temp-2bit.seq
+tr T U < correct.seq > temp-correct.seq
+if diff temp-fasta.lens temp-2bit.lens && \
+   diff temp-correct.seq temp-2bit.seq; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.2bit temp-fasta.lens temp-2bit.lens temp-2bit.seq \
+	temp-correct.seq
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp-2bit.lens and temp-2bit.seq.\n"
+    pause
+fi
+pause
+
+printf "\n===\nTesting blt_zopen() on stdin already partly read...\n"
+(printf "skip this line\n"; cat test.fasta) > temp-offset.fasta
+{ read -r junk; ../chrom-lens; } < temp-offset.fasta > temp-offset.lens
+../chrom-lens < test.fasta > temp-fasta.lens
+if diff temp-fasta.lens temp-offset.lens; then
+    printf "No differences found, test passed.\n"
+    rm -f temp-offset.fasta temp-offset.lens temp-fasta.lens
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp-offset.lens.\n"
+    pause
+fi
+pause
+
 printf "\n===\nTesting find-orfs...\n"
 ../find-orfs 0 < temp.seq > temp.orfs
 if diff correct.orfs temp.orfs; then
@@ -69,6 +162,155 @@ else
 fi
 pause
 
+printf "\n===\nTesting find-orfs with FASTA input...\n"
+../find-orfs < test.fasta > temp.orfs
+if diff correct-fasta.orfs temp.orfs; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.orfs
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.orfs.\n"
+    pause
+    more temp.orfs
+fi
+pause
+
+printf "\n===\nTesting fastx-translate...\n"
+../fastx-translate --frames 6 < test.fasta > temp.faa
+if diff correct-translate.faa temp.faa; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.faa
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.faa.\n"
+    pause
+    more temp.faa
+fi
+pause
+
+printf "\n===\nTesting phred-encode and phred-decode...\n"
+../phred-encode --to 64 < test.fastq | ../phred-encode > temp.fastq
+../phred-decode < test.fastq > temp-33.txt
+../phred-encode --to 64 < test.fastq | ../phred-decode --from 64 > temp-64.txt
+if diff test.fastq temp.fastq && diff temp-33.txt temp-64.txt; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.fastq temp-33.txt temp-64.txt
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.fastq, temp-33.txt, and temp-64.txt.\n"
+    pause
+fi
+pause
+
+printf "\n===\nTesting in-process blt pipe stages...\n"
+../fastx-filter --min-length 30 < test.fastq | ../phred-encode --to 64 \
+    | ../fastx-derep > temp-shell.fastq
+../blt pipe fastx-filter --min-length 30 : phred-encode --to 64 \
+    : fastx-derep < test.fastq > temp.fastq
+if diff temp-shell.fastq temp.fastq; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.fastq temp-shell.fastq
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.fastq and temp-shell.fastq.\n"
+    pause
+fi
+pause
+
+printf "\n===\nTesting gff3-to-bed...\n"
+../gff3-to-bed < roman.gff3 > temp.bed
+if diff correct.bed temp.bed; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.bed
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.bed.\n"
+    pause
+    more temp.bed
+fi
+pause
+
+printf "\n===\nTesting gff3-to-bed --bgzf...\n"
+../gff3-to-bed --bgzf < roman.gff3 | gzip -dc > temp.bed
+if diff correct.bed temp.bed; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.bed
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.bed.\n"
+    pause
+    more temp.bed
+fi
+pause
+
+printf "\n===\nTesting gff3-query...\n"
+../gff3-query --index roman.gff3
+../gff3-query roman.gff3 IV:1000-2000 XVI:1-1 > temp.gff3
+if diff correct-query.gff3 temp.gff3; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.gff3 roman.gff3.gqi
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.gff3.\n"
+    pause
+    more temp.gff3
+fi
+./overlap-test.sh
+pause
+
+printf "\n===\nTesting gff3-sort...\n"
+printf "I\nII\nIII\nIV\nV\nVI\nVII\nVIII\nIX\nX\nXI\nXII\nXIII\nXIV\nXV\nXVI\n" \
+    > temp-order.txt
+../gff3-sort --order temp-order.txt roman.gff3 > temp.gff3
+if diff correct-sort.gff3 temp.gff3; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.gff3 temp-order.txt
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.gff3.\n"
+    pause
+    more temp.gff3
+fi
+pause
+
+printf "\n===\nTesting ensemblid2gene...\n"
+# IDs listed in mixed case and duplicated, exon with no ID=
+../ensemblid2gene ensembl.gff3 ensembl-ids.txt > temp.txt
+if diff correct-ensemblid2gene.txt temp.txt; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.txt
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.txt.\n"
+    pause
+    more temp.txt
+fi
+pause
+
+printf "\n===\nTesting ensemblid2gene --index and --table...\n"
+for gff3 in temp.gff3 temp-size.gff3 temp-mtime.gff3; do
+    cp ensembl.gff3 $gff3
+    touch -t 202001010000 $gff3
+done
+../ensemblid2gene --index temp.gff3 temp-size.gff3 temp-mtime.gff3
+# Tables are stale once the GFF3 size or modification time changes
+printf "###\n" >> temp-size.gff3
+touch -t 202001010000 temp-size.gff3
+touch -t 202001020000 temp-mtime.gff3
+../ensemblid2gene temp.gff3 ensembl-ids.txt > temp-scan.txt
+../ensemblid2gene --table temp.gff3 ensembl-ids.txt > temp.txt
+if diff temp-scan.txt temp.txt && \
+   ! ../ensemblid2gene --table temp-size.gff3 ensembl-ids.txt && \
+   ! ../ensemblid2gene --table temp-mtime.gff3 ensembl-ids.txt; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.gff3* temp-size.gff3* temp-mtime.gff3* temp-scan.txt temp.txt
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.txt and temp-scan.txt.\n"
+    pause
+fi
+pause
+
 printf "\n===\nTesting vcf-search...\n"
 ../vcf-search chr1 4580 < test.vcf > temp.vcf
 if diff correct-search.vcf temp.vcf; then
@@ -88,4 +330,32 @@ more temp.vcf
 rm -i temp.vcf
 
 printf "\n===\nTesting deromanize...\n"
-../deromanize 1 roman.gff3
+# Comments and a chromosome name that is not a numeral are left alone
+printf "##gff-version 3\n#!genome-build R64-1-1\n" > temp-roman.gff3
+cat roman.gff3 >> temp-roman.gff3
+printf "Mito\tR64-1-1\tchromosome\t1\t85779\t.\t.\t.\t%s\n" \
+    "ID=chromosome:Mito;Alias=KP263414.1" >> temp-roman.gff3
+../deromanize 1 temp-roman.gff3 > temp.gff3
+if diff correct-deromanize.gff3 temp.gff3; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.gff3 temp-roman.gff3
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.gff3.\n"
+    pause
+    more temp.gff3
+fi
+pause
+
+printf "\n===\nTesting deromanize with multiple columns...\n"
+# Listed out of order, with numerals in an unlisted column left alone
+../deromanize 3,1 < roman.tsv > temp.tsv
+if diff correct-deromanize.tsv temp.tsv; then
+    printf "No differences found, test passed.\n"
+    rm -f temp.tsv
+else
+    printf "Differences found, test failed.\n"
+    printf "Check temp.tsv.\n"
+    pause
+    more temp.tsv
+fi
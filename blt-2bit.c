@@ -0,0 +1,373 @@
+/***************************************************************************
+ *  Description:
+ *      Memory-mapped access to packed genomes in UCSC .2bit format, as
+ *      written by blt fasta-pack or UCSC faToTwoBit.
+ *
+ *      A .2bit file begins with an index of sequence names and file
+ *      offsets.  Each sequence record holds its length, lists of N runs
+ *      and lower-case (soft-masked) runs, and the bases packed 4 per
+ *      byte (T=0, C=1, A=2, G=3, first base in the high-order bits).
+ *
+ *      The file is mapped rather than read, so opening it costs only
+ *      the index, the length of any sequence is a single load, and
+ *      decoding a range touches only the pages holding those bases.
+ *      Repeated runs on the same reference are served from the page
+ *      cache, at one quarter of the memory of a FASTA sequence.
+ *
+ *      Files written on a host of the opposite byte order are detected
+ *      from the signature and swapped on access.  Both version 0
+ *      (32-bit offsets) and version 1 (64-bit offsets) are supported.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "blt-2bit.h"
+
+#define HEADER_LEN  16
+
+static uint32_t get32(const unsigned char *p, bool swap);
+static uint64_t get64(const unsigned char *p, bool swap);
+static void     apply_blocks(const unsigned char *blocks, uint32_t count,
+			     bool swap, uint32_t start, uint32_t end,
+			     char *buff, bool mask);
+
+// Packed byte -> 4 bases
+static char     Quads[256][4];
+
+/***************************************************************************
+ *  Description:
+ *      Check whether fd is a regular file starting with a .2bit
+ *      signature, without moving its file offset.  Pipes and other
+ *      unmappable inputs return false, so callers can fall back to
+ *      reading FASTA.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    blt_2bit_sniff(int fd)
+
+{
+    struct stat     st;
+    unsigned char   sig[4];
+
+    if ( (fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) )
+	return false;
+    if ( pread(fd, sig, sizeof(sig), 0) != sizeof(sig) )
+	return false;
+    return (get32(sig, false) == BLT_2BIT_SIGNATURE) ||
+	   (get32(sig, true) == BLT_2BIT_SIGNATURE);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Map a .2bit file and load its index.  fd may be closed
+ *      afterward.
+ *
+ *  Returns:
+ *      A blt_2bit_t to be released with blt_2bit_close(), or NULL with
+ *      errno set (EINVAL for a malformed file)
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+blt_2bit_t  *blt_2bit_fdopen(int fd)
+
+{
+    static const char   bases[] = "TCAG";
+    struct stat         st;
+    blt_2bit_t          *tb;
+    const unsigned char *p;
+    void                *map;
+    size_t              pos, name_len, offset_len;
+    uint32_t            version, c;
+    int                 b;
+
+    if ( fstat(fd, &st) != 0 )
+	return NULL;
+    if ( (size_t)st.st_size < HEADER_LEN )
+    {
+	errno = EINVAL;
+	return NULL;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if ( map == MAP_FAILED )
+	return NULL;
+    if ( (tb = calloc(1, sizeof(*tb))) == NULL )
+    {
+	munmap(map, st.st_size);
+	return NULL;
+    }
+    tb->map = p = map;
+    tb->map_len = st.st_size;
+
+    if ( get32(p, false) == BLT_2BIT_SIGNATURE )
+	tb->swap = false;
+    else if ( get32(p, true) == BLT_2BIT_SIGNATURE )
+	tb->swap = true;
+    else
+	goto invalid;
+    version = get32(p + 4, tb->swap);
+    if ( version > 1 )
+	goto invalid;
+    offset_len = version == 0 ? 4 : 8;
+    tb->count = get32(p + 8, tb->swap);
+    if ( (tb->names = calloc(tb->count, sizeof(*tb->names))) == NULL )
+	goto error;
+    if ( (tb->offsets = malloc(tb->count * sizeof(*tb->offsets))) == NULL )
+	goto error;
+
+    for (c = 0, pos = HEADER_LEN; c < tb->count; ++c)
+    {
+	if ( pos + 1 > tb->map_len )
+	    goto invalid;
+	name_len = p[pos++];
+	if ( pos + name_len + offset_len > tb->map_len )
+	    goto invalid;
+	if ( (tb->names[c] = malloc(name_len + 1)) == NULL )
+	    goto error;
+	memcpy(tb->names[c], p + pos, name_len);
+	tb->names[c][name_len] = '\0';
+	pos += name_len;
+	tb->offsets[c] = version == 0 ? get32(p + pos, tb->swap) :
+					get64(p + pos, tb->swap);
+	pos += offset_len;
+    }
+
+    for (b = 0; b < 256; ++b)
+    {
+	Quads[b][0] = bases[(b >> 6) & 3];
+	Quads[b][1] = bases[(b >> 4) & 3];
+	Quads[b][2] = bases[(b >> 2) & 3];
+	Quads[b][3] = bases[b & 3];
+    }
+    return tb;
+
+invalid:
+    errno = EINVAL;
+error:
+    b = errno;
+    blt_2bit_close(tb);
+    errno = b;
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Unmap a .2bit file and free its index
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    blt_2bit_close(blt_2bit_t *tb)
+
+{
+    uint32_t    c;
+
+    if ( tb->names != NULL )
+    {
+	for (c = 0; c < tb->count; ++c)
+	    free(tb->names[c]);
+	free(tb->names);
+    }
+    free(tb->offsets);
+    munmap((void *)tb->map, tb->map_len);
+    free(tb);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Look up a sequence by exact name
+ *
+ *  Returns:
+ *      The index of the sequence, or -1 if not found
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+long    blt_2bit_find(blt_2bit_t *tb, const char *name)
+
+{
+    uint32_t    c;
+
+    for (c = 0; c < tb->count; ++c)
+	if ( strcmp(tb->names[c], name) == 0 )
+	    return c;
+    return -1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Locate the record for sequence index and check that it lies
+ *      within the file.  Nothing is copied.
+ *
+ *  Returns:
+ *      0 on success, -1 with errno = EINVAL if the record is malformed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     blt_2bit_seq(blt_2bit_t *tb, uint32_t index, blt_2bit_seq_t *seq)
+
+{
+    uint64_t    pos = tb->offsets[index];
+
+    seq->name = tb->names[index];
+    seq->swap = tb->swap;
+    if ( pos + 8 > tb->map_len )
+	goto invalid;
+    seq->len = get32(tb->map + pos, tb->swap);
+    seq->n_count = get32(tb->map + pos + 4, tb->swap);
+    seq->n_blocks = tb->map + pos + 8;
+    pos += 8 + 8 * (uint64_t)seq->n_count;
+    if ( pos + 4 > tb->map_len )
+	goto invalid;
+    seq->mask_count = get32(tb->map + pos, tb->swap);
+    seq->mask_blocks = tb->map + pos + 4;
+    // Mask blocks, reserved word
+    pos += 4 + 8 * (uint64_t)seq->mask_count + 4;
+    seq->dna = tb->map + pos;
+    if ( pos + (seq->len + 3ULL) / 4 > tb->map_len )
+	goto invalid;
+    return 0;
+
+invalid:
+    errno = EINVAL;
+    return -1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Decode bases [start, end) of seq into buff, restoring N runs and
+ *      lower-case masking.  buff must hold end - start characters and is
+ *      not null-terminated.  The caller must ensure end <= seq->len.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    blt_2bit_decode(const blt_2bit_seq_t *seq, uint32_t start,
+			uint32_t end, char *buff)
+
+{
+    char        *p = buff;
+    uint32_t    c = start;
+
+    // Partial leading byte, whole bytes, partial trailing byte
+    for (; (c < end) && ((c & 3) != 0); ++c)
+	*p++ = Quads[seq->dna[c >> 2]][c & 3];
+    for (; c + 4 <= end; c += 4, p += 4)
+	memcpy(p, Quads[seq->dna[c >> 2]], 4);
+    for (; c < end; ++c)
+	*p++ = Quads[seq->dna[c >> 2]][c & 3];
+
+    apply_blocks(seq->n_blocks, seq->n_count, seq->swap, start, end,
+		 buff, false);
+    apply_blocks(seq->mask_blocks, seq->mask_count, seq->swap, start, end,
+		 buff, true);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Overwrite N runs or lower-case masked runs that overlap
+ *      [start, end).  Runs are sorted and disjoint, so the first
+ *      overlapping run is found by binary search on run ends.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void apply_blocks(const unsigned char *blocks, uint32_t count,
+			 bool swap, uint32_t start, uint32_t end,
+			 char *buff, bool mask)
+
+{
+    const unsigned char *sizes = blocks + 4 * (size_t)count;
+    uint32_t            lo = 0, hi = count, mid, b_start, b_end, c;
+
+    while ( lo < hi )
+    {
+	mid = lo + (hi - lo) / 2;
+	if ( get32(blocks + 4 * mid, swap) + get32(sizes + 4 * mid, swap)
+		<= start )
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    for (; lo < count; ++lo)
+    {
+	b_start = get32(blocks + 4 * lo, swap);
+	if ( b_start >= end )
+	    break;
+	b_end = b_start + get32(sizes + 4 * lo, swap);
+	if ( b_start < start )
+	    b_start = start;
+	if ( b_end > end )
+	    b_end = end;
+	if ( mask )
+	    for (c = b_start; c < b_end; ++c)
+		buff[c - start] |= 0x20;
+	else
+	    memset(buff + b_start - start, 'N', b_end - b_start);
+    }
+}
+
+
+static uint32_t get32(const unsigned char *p, bool swap)
+
+{
+    uint32_t    val;
+
+    memcpy(&val, p, sizeof(val));
+    if ( swap )
+	val = (val >> 24) | ((val >> 8) & 0xff00) |
+	      ((val << 8) & 0xff0000) | (val << 24);
+    return val;
+}
+
+
+static uint64_t get64(const unsigned char *p, bool swap)
+
+{
+    unsigned char   bytes[8];
+    uint64_t        val;
+    int             c;
+
+    if ( swap )
+    {
+	for (c = 0; c < 8; ++c)
+	    bytes[c] = p[7 - c];
+	p = bytes;
+    }
+    memcpy(&val, p, sizeof(val));
+    return val;
+}
@@ -0,0 +1,55 @@
+/***************************************************************************
+ *  Description:
+ *      Memory-mapped access to packed genomes in UCSC .2bit format,
+ *      shared by blt subcommands.  See blt-2bit.c.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifndef _BLT_2BIT_H_
+#define _BLT_2BIT_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BLT_2BIT_SIGNATURE      0x1A412743
+#define BLT_2BIT_NAME_MAX       255
+
+typedef struct
+{
+    const unsigned char *map;
+    size_t              map_len;
+    bool                swap;       // File written on opposite-endian host
+    uint32_t            count;
+    char                **names;
+    uint64_t            *offsets;
+}   blt_2bit_t;
+
+/*
+ *  One sequence, pointing into the map.  Block lists are arrays of
+ *  starts followed by arrays of sizes, as stored in the file.
+ */
+typedef struct
+{
+    const char          *name;
+    uint32_t            len;
+    uint32_t            n_count;
+    uint32_t            mask_count;
+    bool                swap;
+    const unsigned char *n_blocks;
+    const unsigned char *mask_blocks;
+    const unsigned char *dna;
+}   blt_2bit_seq_t;
+
+bool        blt_2bit_sniff(int fd);
+blt_2bit_t  *blt_2bit_fdopen(int fd);
+void        blt_2bit_close(blt_2bit_t *tb);
+long        blt_2bit_find(blt_2bit_t *tb, const char *name);
+int         blt_2bit_seq(blt_2bit_t *tb, uint32_t index, blt_2bit_seq_t *seq);
+void        blt_2bit_decode(const blt_2bit_seq_t *seq, uint32_t start,
+			    uint32_t end, char *buff);
+
+#endif  // _BLT_2BIT_H_
@@ -0,0 +1,249 @@
+/***************************************************************************
+ *  Description:
+ *      Phred quality string conversion and summaries shared by
+ *      phred-encode, phred-decode, and fastx-filter.
+ *
+ *      Quality characters are shifted in place 8 at a time using
+ *      ordinary 64-bit integer operations (SWAR), after checking that
+ *      every byte in the word is a valid quality character.  Words
+ *      containing an invalid character fall back to a byte loop, which
+ *      pinpoints the offending character.  This is portable C, needs
+ *      no intrinsics, and leaves the reader as the bottleneck.
+ *
+ *      The input offset (33 for Sanger and Illumina 1.8+, 64 for older
+ *      Illumina) is detected from a sample of records at the start of
+ *      the stream, which are kept so they can be converted like the
+ *      rest.  phred_sample_batch() does the same for records already
+ *      read, for the in-process stages of "blt pipe".
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifndef _BLT_PHRED_H_
+#define _BLT_PHRED_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <biolibc/fastx.h>
+
+#define PHRED_OFFSET_AUTO       0
+#define PHRED_MAX_CHAR          '~'
+#define PHRED_MAX_SCORE(offset) (PHRED_MAX_CHAR - (offset))
+#define PHRED_SAMPLE_RECORDS    1000
+
+#define PHRED_ONES              0x0101010101010101ULL
+#define PHRED_HIGHS             0x8080808080808080ULL
+#define PHRED_EVEN_BYTES        0x00ff00ff00ff00ffULL
+#define PHRED_EVEN_SHORTS       0x0000ffff0000ffffULL
+
+// Words summed into 16-bit lanes before they could overflow: 2 * 255 * 128
+#define PHRED_SUM_WORDS         128
+
+/***************************************************************************
+ *  Description:
+ *      Check that every character in qual[0..len-1] is in the range
+ *      [from, '~'] and add (to - from) to each.  When to > from, the
+ *      upper limit is lowered by (to - from) so that the result is
+ *      also at most '~'.  With to = 0 this converts characters to
+ *      numeric scores.
+ *
+ *  Returns:
+ *      len on success, or the index of the first invalid character.
+ *      Characters before it have been converted, the rest have not.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline size_t phred_shift(char *qual, size_t len, int from, int to)
+
+{
+    uint64_t        word, below, above;
+    size_t          c;
+    unsigned char   ch;
+    int             max = to > from ? PHRED_MAX_CHAR - (to - from) :
+			  PHRED_MAX_CHAR;
+
+    for (c = 0; c + 8 <= len; c += 8)
+    {
+	memcpy(&word, qual + c, 8);
+	// High bit set in any byte < from or > max
+	below = (word - PHRED_ONES * from) & ~word;
+	above = (word + PHRED_ONES * (127 - max)) | word;
+	if ( (below | above) & PHRED_HIGHS )
+	    break;
+	// No byte can borrow or carry once the range is known
+	if ( to >= from )
+	    word += PHRED_ONES * (to - from);
+	else
+	    word -= PHRED_ONES * (from - to);
+	memcpy(qual + c, &word, 8);
+    }
+    for (; c < len; ++c)
+    {
+	ch = qual[c];
+	if ( (ch < from) || (ch > max) )
+	    return c;
+	qual[c] = ch - from + to;
+    }
+    return len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Sum the characters of qual[0..len-1], 8 at a time.  Alternate
+ *      bytes of each word are added into four 16-bit lanes, which are
+ *      folded into the total every PHRED_SUM_WORDS words.  Subtract
+ *      len * offset from the result to get the sum of the scores.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline uint64_t phred_sum(const char *qual, size_t len)
+
+{
+    uint64_t    word, lanes, sum = 0;
+    size_t      c, end;
+
+    for (c = 0; c + 8 <= len; )
+    {
+	lanes = 0;
+	for (end = c + 8 * PHRED_SUM_WORDS; (c + 8 <= len) && (c < end); c += 8)
+	{
+	    memcpy(&word, qual + c, 8);
+	    lanes += (word & PHRED_EVEN_BYTES) + ((word >> 8) & PHRED_EVEN_BYTES);
+	}
+	lanes = (lanes & PHRED_EVEN_SHORTS) + ((lanes >> 16) & PHRED_EVEN_SHORTS);
+	sum += (lanes & 0xffffffff) + (lanes >> 32);
+    }
+    for (; c < len; ++c)
+	sum += (unsigned char)qual[c];
+    return sum;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return the lower of min and the lowest quality character of rec.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline unsigned char phred_min_char(bl_fastx_t *rec, unsigned char min)
+
+{
+    const unsigned char *qual = (unsigned char *)bl_fastx_qual(rec);
+    size_t  len = bl_fastx_qual_len(rec), c;
+
+    for (c = 0; c < len; ++c)
+	if ( qual[c] < min )
+	    min = qual[c];
+    return min;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read up to PHRED_SAMPLE_RECORDS records into recs[], stopping as
+ *      soon as a quality character below '@' (64) shows the offset must
+ *      be 33.  If none is found, the offset is taken to be 64.
+ *
+ *  Returns:
+ *      The number of records read, with the status of the last read in
+ *      *status and the offset in *offset
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline size_t phred_sample(FILE *stream, bl_fastx_t recs[],
+				  int *offset, int *status)
+
+{
+    size_t          count;
+    unsigned char   min = 255;
+
+    for (count = 0; (count < PHRED_SAMPLE_RECORDS) && (min >= 64); ++count)
+    {
+	bl_fastx_init(&recs[count], stream);
+	if ( (*status = bl_fastx_read(&recs[count], stream)) != BL_READ_OK )
+	{
+	    bl_fastx_free(&recs[count]);
+	    break;
+	}
+	min = phred_min_char(&recs[count], min);
+    }
+    *offset = min < 64 ? 33 : 64;
+    return count;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Continue sampling with count more records already read, for a
+ *      caller that receives records in batches.  *sampled and *min
+ *      carry the state between calls and must start at 0 and 255.  If
+ *      last is true, no more records will follow.
+ *
+ *  Returns:
+ *      true once the offset is known, with the offset in *offset, as
+ *      phred_sample() would find it, or false if more records are needed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline bool  phred_sample_batch(bl_fastx_t recs[], size_t count,
+				       size_t *sampled, unsigned char *min,
+				       bool last, int *offset)
+
+{
+    size_t  c;
+
+    for (c = 0; (c < count) && (*sampled < PHRED_SAMPLE_RECORDS) &&
+		(*min >= 64); ++c, ++*sampled)
+	*min = phred_min_char(&recs[c], *min);
+    if ( !last && (*sampled < PHRED_SAMPLE_RECORDS) && (*min >= 64) )
+	return false;
+    *offset = *min < 64 ? 33 : 64;
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse a Phred offset argument, which must be 33 or 64.
+ *
+ *  Returns:
+ *      The offset, or -1 after printing an error
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline int   phred_parse_offset(const char *arg)
+
+{
+    if ( strcmp(arg, "33") == 0 )
+	return 33;
+    else if ( strcmp(arg, "64") == 0 )
+	return 64;
+    fprintf(stderr, "Invalid Phred offset: %s (must be 33 or 64)\n", arg);
+    return -1;
+}
+
+#endif  // _BLT_PHRED_H_
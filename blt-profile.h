@@ -0,0 +1,248 @@
+/***************************************************************************
+ *  Description:
+ *      Opt-in run-time instrumentation shared by all blt subcommands.
+ *
+ *      A subcommand calls PROF_INIT() at the top of main() and may mark
+ *      phases and count work:
+ *
+ *          PROF_START(t);
+ *          status = bl_fastx_read(&rec, stdin);
+ *          PROF_STOP_IO(t, "read");    // Time waiting for input
+ *          PROF_RESTART(t);
+ *          hash = XXH64(...);
+ *          PROF_STOP(t, "hash");       // Time computing
+ *          PROF_RECORDS(1);
+ *          PROF_BYTES(len);
+ *
+ *      Subcommands that read records with a library parser, and so never
+ *      see their lengths, can instead count the input consumed once at
+ *      the end with PROF_STREAM_BYTES(stream), which uses ftello() and
+ *      so works with plain files and blt_zopen() streams, but not pipes
+ *      opened with xt_fopen().
+ *
+ *      Nothing is reported unless BLT_PROFILE is set in the environment
+ *      ("blt --profile subcommand ..." sets it), in which case a one-line
+ *      JSON summary is printed to stderr at exit: wall, user, and system
+ *      time, peak RSS, bytes and records with rates, and total time and
+ *      call count for each phase.  Phases marked with PROF_STOP_IO()
+ *      are also summed into "io_sec", so a slow job can be identified
+ *      as I/O-bound (io_sec close to wall), or parse- or compute-bound
+ *      (the phase with the largest share).
+ *
+ *      Timers read the CPU cycle counter where available (a few ns)
+ *      and CLOCK_MONOTONIC otherwise, and are calibrated against
+ *      CLOCK_MONOTONIC at exit.  When BLT_PROFILE is not set, each macro
+ *      costs one predictable branch.  Building with PROFILE_FLAGS=
+ *      (without -DBLT_PROFILE) removes the instrumentation entirely.
+ *
+ *      Phases and counters are not thread-safe: use them only in the
+ *      main thread, e.g. around waiting for worker threads.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifndef _BLT_PROFILE_H_
+#define _BLT_PROFILE_H_
+
+#ifdef BLT_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define PROF_MAX_PHASES 16
+
+typedef struct
+{
+    const char  *name;
+    uint64_t    ticks;
+    uint64_t    calls;
+    bool        io;
+}   prof_phase_t;
+
+typedef struct
+{
+    bool            enabled;
+    const char      *tool;
+    uint64_t        start_ticks;
+    struct timespec start_time;
+    uint64_t        bytes;
+    uint64_t        records;
+    prof_phase_t    phases[PROF_MAX_PHASES];
+    int             phase_count;
+}   prof_t;
+
+static prof_t   Prof;
+
+static inline uint64_t prof_ticks(void)
+
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t    ticks;
+
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add elapsed ticks to a phase.  The slot for each call site is
+ *      looked up by name once and cached in *slot.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline void prof_stop(int *slot, const char *phase, uint64_t start,
+			     bool io)
+
+{
+    uint64_t    end = prof_ticks();
+
+    if ( *slot == -1 )
+    {
+	for (*slot = 0; (*slot < Prof.phase_count) &&
+			(strcmp(Prof.phases[*slot].name, phase) != 0); ++*slot)
+	    ;
+	if ( *slot == Prof.phase_count )
+	{
+	    if ( Prof.phase_count == PROF_MAX_PHASES )
+	    {
+		*slot = -1;
+		return;
+	    }
+	    Prof.phases[*slot].name = phase;
+	    Prof.phases[*slot].io = io;
+	    ++Prof.phase_count;
+	}
+    }
+    Prof.phases[*slot].ticks += end - start;
+    ++Prof.phases[*slot].calls;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      atexit() handler: print the JSON summary to stderr.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void prof_report(void)
+
+{
+    struct timespec end_time;
+    struct rusage   usage;
+    uint64_t        end_ticks = prof_ticks();
+    double          wall, ticks_per_sec, io_sec = 0, sec;
+    int             c;
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    getrusage(RUSAGE_SELF, &usage);
+    wall = (end_time.tv_sec - Prof.start_time.tv_sec) +
+	   (end_time.tv_nsec - Prof.start_time.tv_nsec) / 1e9;
+    ticks_per_sec = wall > 0 ? (end_ticks - Prof.start_ticks) / wall : 1e9;
+    for (c = 0; c < Prof.phase_count; ++c)
+	if ( Prof.phases[c].io )
+	    io_sec += Prof.phases[c].ticks / ticks_per_sec;
+
+#ifdef __APPLE__
+    usage.ru_maxrss /= 1024;    // Bytes on macOS, KiB elsewhere
+#endif
+    fprintf(stderr, "{\"tool\": \"%s\", \"wall_sec\": %.6f, "
+	    "\"user_sec\": %.6f, \"sys_sec\": %.6f, \"io_sec\": %.6f, "
+	    "\"max_rss_kib\": %ld, ", Prof.tool, wall,
+	    usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6,
+	    usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6,
+	    io_sec, (long)usage.ru_maxrss);
+    fprintf(stderr, "\"bytes\": %llu, \"mb_per_sec\": %.2f, "
+	    "\"records\": %llu, \"records_per_sec\": %.0f, \"phases\": {",
+	    (unsigned long long)Prof.bytes,
+	    wall > 0 ? Prof.bytes / 1e6 / wall : 0,
+	    (unsigned long long)Prof.records,
+	    wall > 0 ? Prof.records / wall : 0);
+    for (c = 0; c < Prof.phase_count; ++c)
+    {
+	sec = Prof.phases[c].ticks / ticks_per_sec;
+	fprintf(stderr, "%s\"%s\": {\"sec\": %.6f, \"calls\": %llu, "
+		"\"io\": %s}", c == 0 ? "" : ", ", Prof.phases[c].name, sec,
+		(unsigned long long)Prof.phases[c].calls,
+		Prof.phases[c].io ? "true" : "false");
+    }
+    fputs("}}\n", stderr);
+}
+
+
+static inline void prof_init(const char *tool)
+
+{
+    const char  *env = getenv("BLT_PROFILE");
+
+    if ( (env == NULL) || (*env == '\0') )
+	return;
+    Prof.enabled = true;
+    Prof.tool = tool;
+    clock_gettime(CLOCK_MONOTONIC, &Prof.start_time);
+    Prof.start_ticks = prof_ticks();
+    atexit(prof_report);
+}
+
+#define PROF_INIT(tool)     prof_init(tool)
+#define PROF_START(t)       uint64_t t = Prof.enabled ? prof_ticks() : 0
+#define PROF_RESTART(t)     t = Prof.enabled ? prof_ticks() : 0
+#define PROF_STOP(t, phase) \
+	do { \
+	    static int prof_slot = -1; \
+	    if ( Prof.enabled ) prof_stop(&prof_slot, phase, t, false); \
+	} while ( 0 )
+#define PROF_STOP_IO(t, phase) \
+	do { \
+	    static int prof_slot = -1; \
+	    if ( Prof.enabled ) prof_stop(&prof_slot, phase, t, true); \
+	} while ( 0 )
+#define PROF_BYTES(n)       (Prof.bytes += (n))
+#define PROF_RECORDS(n)     (Prof.records += (n))
+#define PROF_STREAM_BYTES(stream) \
+	do { \
+	    off_t   prof_pos; \
+	    if ( Prof.enabled && ((prof_pos = ftello(stream)) > 0) ) \
+		Prof.bytes += prof_pos; \
+	} while ( 0 )
+
+#else   // BLT_PROFILE
+
+#define PROF_INIT(tool)
+#define PROF_START(t)
+#define PROF_RESTART(t)
+#define PROF_STOP(t, phase)
+#define PROF_STOP_IO(t, phase)
+#define PROF_BYTES(n)
+#define PROF_RECORDS(n)
+#define PROF_STREAM_BYTES(stream)
+
+#endif  // BLT_PROFILE
+
+#endif  // _BLT_PROFILE_H_
@@ -0,0 +1,555 @@
+/***************************************************************************
+ *  Description:
+ *      In-process FASTA/FASTQ pipelines for "blt pipe".
+ *
+ *      When consecutive stages of a pipe are subcommands listed in
+ *      Stages[], they run as threads of one process instead of
+ *      separate processes connected by kernel pipes.  A source thread
+ *      parses the input into batches of records, each stage thread
+ *      processes a batch in place and passes it on by pointer, and the
+ *      calling thread writes the records left in the batch and returns
+ *      it to the source for reuse.  Records are therefore parsed once
+ *      and formatted once for the whole pipeline, with no copying,
+ *      no pipe system calls, and no allocation after the first batches.
+ *
+ *      Batches move through one single-producer, single-consumer ring
+ *      per link, source -> stage 1 -> ... -> stage n -> writer -> source.
+ *      Every ring can hold all STAGE_BATCHES batches, so pushing never
+ *      waits and only an empty ring blocks its consumer.  A batch holds
+ *      up to BATCH_RECORDS records, so a ring lock is taken once per
+ *      thousand or so records.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <biolibc/fastx.h>
+#include "blt-stage.h"
+#include "blt-writer.h"
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+// Batches in flight, limits on records and bases per batch
+#define STAGE_BATCHES   8
+#define BATCH_RECORDS   1024
+#define BATCH_BASES     (4 * 1024 * 1024)
+
+#define WRITER_SIZE     (1024 * 1024)
+
+typedef struct
+{
+    blt_batch_t     *batches[STAGE_BATCHES];
+    unsigned        head,       // Next slot to push
+		    tail;       // Next slot to pop
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+}   ring_t;
+
+typedef struct pipeline pipeline_t;
+
+typedef struct
+{
+    const blt_stage_t   *stage;
+    void        *state;
+    blt_stage_io_t  io;
+    ring_t      *in,
+		*out;
+    pipeline_t  *pipeline;
+    int         status;
+}   stage_thread_t;
+
+struct pipeline
+{
+    FILE        *instream;
+    ring_t      *rings;         // rings[0] returns batches to the source
+    stage_thread_t  *threads;
+    unsigned    stages;
+    unsigned long   records;    // Read by the source
+    size_t      bytes;
+    int         read_status;
+    bool        failed;         // Set by a failed stage, under rings[0].lock
+};
+
+extern const blt_stage_t    blt_fastx_derep_stage,
+			    blt_fastx_filter_stage,
+			    blt_phred_encode_stage;
+
+static const blt_stage_t    *Stages[] =
+{
+    &blt_fastx_derep_stage,
+    &blt_fastx_filter_stage,
+    &blt_phred_encode_stage
+};
+
+#define STAGE_COUNT     (sizeof(Stages) / sizeof(*Stages))
+
+void    ring_init(ring_t *ring);
+void    ring_push(ring_t *ring, blt_batch_t *batch);
+blt_batch_t *ring_pop(ring_t *ring);
+void    ring_destroy(ring_t *ring);
+void    *stage_source(void *arg);
+void    *stage_thread(void *arg);
+int     stage_open(pipeline_t *pipeline, int argc[], char **argv[]);
+int     stage_alloc(pipeline_t *pipeline, blt_batch_t batches[]);
+void    stage_write(pipeline_t *pipeline, blt_writer_t *writer);
+void    stage_drain(pipeline_t *pipeline, pthread_t tids[], unsigned started);
+
+/***************************************************************************
+ *  Description:
+ *      Return the stage entry for a subcommand, or NULL if it can only
+ *      run as a separate process.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+const blt_stage_t   *blt_stage_find(const char *name)
+
+{
+    size_t  c;
+
+    for (c = 0; c < STAGE_COUNT; ++c)
+	if ( strcmp(Stages[c]->name, name) == 0 )
+	    return Stages[c];
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Run stages subcommands, all found by blt_stage_find(), as one
+ *      pipeline from standard input to standard output.  argc[] and
+ *      argv[] hold the arguments of each stage, starting with its name.
+ *      Input is opened with the --threads and --range options of the
+ *      first stage, and output with the --bgzf and --threads options of
+ *      the last, as the separate subcommands would.
+ *
+ *  Returns:
+ *      The first nonzero exit status among the stages in pipeline
+ *      order, or EX_OK
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     blt_stage_run(int stages, int argc[], char **argv[])
+
+{
+    pipeline_t  pipeline = { 0 };
+    blt_batch_t batches[STAGE_BATCHES] = { { 0 } };
+    pthread_t   *tids;
+    blt_writer_t    writer;
+    FILE        *outstream = stdout;
+    blt_stage_io_t  *first, *last;
+    unsigned    s, c;
+    int         status = EX_OK, error;
+
+    PROF_INIT("pipe");
+
+    pipeline.stages = stages;
+    pipeline.rings = calloc(stages + 2, sizeof(*pipeline.rings));
+    pipeline.threads = calloc(stages, sizeof(*pipeline.threads));
+    tids = calloc(stages + 1, sizeof(*tids));
+    if ( (pipeline.rings == NULL) || (pipeline.threads == NULL) ||
+	 (tids == NULL) )
+    {
+	fputs("blt pipe: Could not allocate stages.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    if ( (status = stage_open(&pipeline, argc, argv)) != EX_OK )
+	return status;
+
+    first = &pipeline.threads[0].io;
+    last = &pipeline.threads[stages - 1].io;
+    if ( first->range_end == -1 )
+	pipeline.instream = blt_zopen("-", first->threads);
+    else
+	pipeline.instream = blt_zopen_range("-", first->range_start,
+					    first->range_end);
+    if ( pipeline.instream == NULL )
+    {
+	fprintf(stderr, "%s: Cannot open input: %s\n", argv[0][0],
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( last->bgzf && ((outstream = blt_bgzf_fdopen(STDOUT_FILENO,
+						     last->threads)) == NULL) )
+    {
+	fprintf(stderr, "%s: Cannot open BGZF output: %s\n",
+		argv[stages - 1][0], strerror(errno));
+	return EX_CANTCREAT;
+    }
+    if ( (stage_alloc(&pipeline, batches) != 0) ||
+	 (blt_writer_init(&writer, outstream, WRITER_SIZE) != 0) )
+    {
+	fputs("blt pipe: Could not allocate batches.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    // Start consumers first, so a failure can be drained from the source
+    for (s = 0, error = 0; (s < pipeline.stages) && (error == 0); ++s)
+	error = pthread_create(&tids[s], NULL, stage_thread,
+			       &pipeline.threads[s]);
+    if ( error == 0 )
+	error = pthread_create(&tids[s], NULL, stage_source, &pipeline);
+    else
+	--s;
+    if ( error != 0 )
+    {
+	fprintf(stderr, "blt pipe: Cannot create thread: %s\n",
+		strerror(error));
+	stage_drain(&pipeline, tids, s);
+	status = EX_OSERR;
+    }
+    else
+    {
+	stage_write(&pipeline, &writer);
+	for (s = 0; s <= pipeline.stages; ++s)
+	    pthread_join(tids[s], NULL);
+	PROF_RECORDS(pipeline.records);
+	PROF_BYTES(pipeline.bytes);
+    }
+    blt_writer_free(&writer);
+    blt_zclose(pipeline.instream);
+
+    // Input errors are seen first by the first stage
+    if ( (status == EX_OK) && (pipeline.read_status != BL_READ_EOF) &&
+	 !pipeline.failed )
+    {
+	fprintf(stderr, "%s: Error reading record %lu.\n", argv[0][0],
+		pipeline.records + 1);
+	pipeline.threads[0].status = EX_DATAERR;
+    }
+    if ( (blt_zclose(outstream) != 0) && (status == EX_OK) &&
+	 (pipeline.threads[stages - 1].status == EX_OK) )
+    {
+	fprintf(stderr, "%s: Error writing output.\n", argv[stages - 1][0]);
+	pipeline.threads[stages - 1].status = EX_IOERR;
+    }
+    for (s = 0; s < pipeline.stages; ++s)
+    {
+	if ( status != EX_OK )
+	    pipeline.threads[s].status = status;
+	pipeline.threads[s].status =
+	    pipeline.threads[s].stage->close(pipeline.threads[s].state,
+					     pipeline.threads[s].status);
+	if ( status == EX_OK )
+	    status = pipeline.threads[s].status;
+    }
+
+    for (c = 0; c < STAGE_BATCHES; ++c)
+    {
+	for (s = 0; s < batches[c].capacity; ++s)
+	    bl_fastx_free(&batches[c].records[s]);
+	free(batches[c].records);
+    }
+    for (s = 0; s < pipeline.stages + 2; ++s)
+	ring_destroy(&pipeline.rings[s]);
+    free(pipeline.rings);
+    free(pipeline.threads);
+    free(tids);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse the arguments of each stage and link the stages to their
+ *      rings.  Stages exit through their usage() on invalid arguments,
+ *      as the separate subcommands would.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     stage_open(pipeline_t *pipeline, int argc[], char **argv[])
+
+{
+    stage_thread_t  *thread;
+    unsigned    s;
+
+    for (s = 0; s < pipeline->stages + 2; ++s)
+	ring_init(&pipeline->rings[s]);
+    for (s = 0; s < pipeline->stages; ++s)
+    {
+	thread = &pipeline->threads[s];
+	thread->stage = blt_stage_find(argv[s][0]);
+	if ( (thread->state = thread->stage->open(argc[s], argv[s],
+						  &thread->io)) == NULL )
+	{
+	    fprintf(stderr, "%s: Could not allocate state.\n", argv[s][0]);
+	    return EX_UNAVAILABLE;
+	}
+	if ( (s > 0) && (thread->io.range_end != -1) )
+	{
+	    fprintf(stderr, "%s: --range is only valid for the first "
+		    "stage of a pipe.\n", argv[s][0]);
+	    return EX_USAGE;
+	}
+	thread->in = &pipeline->rings[s + 1];
+	thread->out = &pipeline->rings[s + 2];
+	thread->pipeline = pipeline;
+	thread->status = EX_OK;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Allocate the batches, with records initialized for the input
+ *      stream, and queue them all for the source.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     stage_alloc(pipeline_t *pipeline, blt_batch_t batches[])
+
+{
+    unsigned    c, r;
+
+    for (c = 0; c < STAGE_BATCHES; ++c)
+    {
+	if ( (batches[c].records = calloc(BATCH_RECORDS,
+					  sizeof(*batches[c].records))) == NULL )
+	    return -1;
+	batches[c].capacity = BATCH_RECORDS;
+	for (r = 0; r < BATCH_RECORDS; ++r)
+	    bl_fastx_init(&batches[c].records[r], pipeline->instream);
+	ring_push(&pipeline->rings[0], &batches[c]);
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: read batches of records until EOF, an input
+ *      error, or a failed stage.  The last batch is marked eof.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *stage_source(void *arg)
+
+{
+    pipeline_t  *pipeline = arg;
+    blt_batch_t *batch;
+    bl_fastx_t  *rec;
+    size_t      bases;
+    int         status = BL_READ_OK;
+    bool        failed;
+
+    do
+    {
+	batch = ring_pop(&pipeline->rings[0]);
+	for (batch->count = 0, bases = 0;
+	     (batch->count < batch->capacity) && (bases < BATCH_BASES) &&
+	     ((status = bl_fastx_read(rec = &batch->records[batch->count],
+				      pipeline->instream)) == BL_READ_OK);
+	     ++batch->count)
+	{
+	    bases += bl_fastx_seq_len(rec);
+	    // Excluding line breaks and the FASTQ '+' line
+	    pipeline->bytes += bl_fastx_desc_len(rec) + bl_fastx_seq_len(rec) +
+			       bl_fastx_qual_len(rec);
+	}
+	pipeline->records += batch->count;
+
+	pthread_mutex_lock(&pipeline->rings[0].lock);
+	failed = pipeline->failed;
+	pthread_mutex_unlock(&pipeline->rings[0].lock);
+	batch->eof = (status != BL_READ_OK) || failed;
+	ring_push(&pipeline->rings[1], batch);
+    }   while ( !batch->eof );
+    pipeline->read_status = status;
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: run one stage on each batch and pass it on.
+ *      A stage with a sample() function sees batches first and holds
+ *      them until it is ready, at most half of all batches so that the
+ *      source can keep reading.  Only one stage holds batches at a
+ *      time, since no stage receives any until those before it have
+ *      released theirs.  After a stage fails, the source is stopped and
+ *      the remaining batches are passed on empty.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *stage_thread(void *arg)
+
+{
+    stage_thread_t  *thread = arg;
+    const blt_stage_t   *stage = thread->stage;
+    blt_batch_t *held[STAGE_BATCHES / 2];
+    unsigned    holding = 0, c;
+    bool        sampling = stage->sample != NULL, eof;
+
+    do
+    {
+	held[holding++] = ring_pop(thread->in);
+	eof = held[holding - 1]->eof;
+	if ( sampling )
+	{
+	    if ( !stage->sample(thread->state, held[holding - 1],
+				eof || (holding == STAGE_BATCHES / 2)) )
+		continue;
+	    sampling = false;
+	}
+	for (c = 0; c < holding; ++c)
+	{
+	    if ( thread->status != EX_OK )
+		held[c]->count = 0;
+	    else if ( (thread->status = stage->batch(thread->state, held[c]))
+		      != EX_OK )
+	    {
+		pthread_mutex_lock(&thread->pipeline->rings[0].lock);
+		thread->pipeline->failed = true;
+		pthread_mutex_unlock(&thread->pipeline->rings[0].lock);
+	    }
+	    ring_push(thread->out, held[c]);
+	}
+	holding = 0;
+    }   while ( !eof );
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write the records left in each batch on the calling thread and
+ *      return the batch to the source, until the last batch.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    stage_write(pipeline_t *pipeline, blt_writer_t *writer)
+
+{
+    blt_batch_t *batch;
+    ring_t      *in = &pipeline->rings[pipeline->stages + 1];
+    unsigned    c;
+    bool        eof;
+
+    do
+    {
+	PROF_START(t);
+	batch = ring_pop(in);
+	PROF_STOP(t, "wait");
+	PROF_RESTART(t);
+	for (c = 0; c < batch->count; ++c)
+	    blt_writer_record(writer, &batch->records[c]);
+	PROF_STOP_IO(t, "write");
+	eof = batch->eof;
+	ring_push(&pipeline->rings[0], batch);
+    }   while ( !eof );
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stop the stage threads started before a thread could not be
+ *      created, by sending them an empty last batch, and wait for them.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    stage_drain(pipeline_t *pipeline, pthread_t tids[], unsigned started)
+
+{
+    blt_batch_t *batch;
+    unsigned    s;
+
+    batch = ring_pop(&pipeline->rings[0]);
+    batch->count = 0;
+    batch->eof = true;
+    ring_push(&pipeline->rings[1], batch);
+    for (s = 0; s < started; ++s)
+	pthread_join(tids[s], NULL);
+    pipeline->read_status = BL_READ_EOF;
+}
+
+
+void    ring_init(ring_t *ring)
+
+{
+    ring->head = ring->tail = 0;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->changed, NULL);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Queue a batch.  Never waits, since a ring holds every batch.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    ring_push(ring_t *ring, blt_batch_t *batch)
+
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->batches[ring->head++ % STAGE_BATCHES] = batch;
+    pthread_cond_signal(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Dequeue the oldest batch, waiting until there is one.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+blt_batch_t *ring_pop(ring_t *ring)
+
+{
+    blt_batch_t *batch;
+
+    pthread_mutex_lock(&ring->lock);
+    while ( ring->tail == ring->head )
+	pthread_cond_wait(&ring->changed, &ring->lock);
+    batch = ring->batches[ring->tail++ % STAGE_BATCHES];
+    pthread_mutex_unlock(&ring->lock);
+    return batch;
+}
+
+
+void    ring_destroy(ring_t *ring)
+
+{
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->changed);
+}
@@ -0,0 +1,96 @@
+/***************************************************************************
+ *  Description:
+ *      In-process FASTA/FASTQ pipeline stages for "blt pipe".
+ *      See blt-stage.c.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifndef _BLT_STAGE_H_
+#define _BLT_STAGE_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <biolibc/fastx.h>
+
+/*
+ *  Records parsed by the pipeline source, passed between stages by
+ *  pointer.  A stage processes records[0..count-1] in place and drops
+ *  records by moving those it keeps to the front with blt_batch_keep()
+ *  and reducing count, so later stages see only the records kept, and
+ *  the source reuses the buffers of all of them.
+ */
+typedef struct
+{
+    bl_fastx_t  *records;
+    unsigned    count,
+		capacity;
+    bool        eof;            // Last batch from the source
+}   blt_batch_t;
+
+/*
+ *  I/O options of a stage, set by its argument parser.  The pipeline
+ *  reads its input with the options of the first stage and writes its
+ *  output with those of the last.
+ */
+typedef struct
+{
+    unsigned    threads;        // BGZF threads
+    bool        bgzf;           // Compress output
+    off_t       range_start,    // Input byte range, range_end -1 for all
+		range_end;
+}   blt_stage_io_t;
+
+/*
+ *  A subcommand that can run as an in-process stage.  open() parses the
+ *  subcommand's usual arguments, exiting through its usage() on errors
+ *  as the subcommand would, and returns its state.  If sample() is not
+ *  NULL, batches are passed to it before batch() until it returns true,
+ *  or last is true, so that a stage can look ahead before processing,
+ *  e.g. to detect a Phred offset.  batch() returns EX_OK or a sysexits
+ *  code, with count reduced to the records processed before an error.
+ *  close() prints the subcommand's summary if status is EX_OK, frees the
+ *  state, and returns status or a new error.
+ */
+typedef struct
+{
+    const char  *name;
+    void        *(*open)(int argc, char *argv[], blt_stage_io_t *io);
+    bool        (*sample)(void *state, blt_batch_t *batch, bool last);
+    int         (*batch)(void *state, blt_batch_t *batch);
+    int         (*close)(void *state, int status);
+}   blt_stage_t;
+
+const blt_stage_t   *blt_stage_find(const char *name);
+int     blt_stage_run(int stages, int argc[], char **argv[]);
+
+/***************************************************************************
+ *  Description:
+ *      Move record c of a batch to position kept, the next free slot
+ *      among the records kept so far, when scanning a batch in order.
+ *      Only the structures are swapped, not the data.  Set count to
+ *      the number kept after the scan.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline void  blt_batch_keep(blt_batch_t *batch, unsigned c,
+				   unsigned kept)
+
+{
+    bl_fastx_t  temp;
+
+    if ( c != kept )
+    {
+	temp = batch->records[kept];
+	batch->records[kept] = batch->records[c];
+	batch->records[c] = temp;
+    }
+}
+
+#endif  // _BLT_STAGE_H_
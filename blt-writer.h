@@ -0,0 +1,154 @@
+/***************************************************************************
+ *  Description:
+ *      Batched FASTA and FASTQ record output shared by fastx-filter and
+ *      fastx-split.
+ *
+ *      Records are copied into a large buffer that is written with a
+ *      single fwrite() when the next record does not fit, instead of
+ *      formatting each field through stdio.  This keeps output close to
+ *      the cost of a memcpy(), and a stream from blt_bgzf_fdopen()
+ *      receives whole batches to compress.  Records are written as
+ *      bl_fastx_write() does with BL_FASTX_LINE_UNLIMITED.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifndef _BLT_WRITER_H_
+#define _BLT_WRITER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <biolibc/fastx.h>
+
+typedef struct
+{
+    FILE        *stream;
+    char        *buf;
+    size_t      len,
+		size;
+}   blt_writer_t;
+
+/***************************************************************************
+ *  Description:
+ *      Set up a writer with a buffer of size bytes for stream.
+ *
+ *  Returns:
+ *      0 on success, -1 if the buffer cannot be allocated
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline int   blt_writer_init(blt_writer_t *writer, FILE *stream,
+				    size_t size)
+
+{
+    writer->stream = stream;
+    writer->len = 0;
+    writer->size = size;
+    return (writer->buf = malloc(size)) == NULL ? -1 : 0;
+}
+
+
+static inline void  blt_writer_flush(blt_writer_t *writer)
+
+{
+    if ( writer->len > 0 )
+	fwrite(writer->buf, writer->len, 1, writer->stream);
+    writer->len = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Flush remaining output and free the buffer.  The stream is left
+ *      open, so check it with ferror() or its close function.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline void  blt_writer_free(blt_writer_t *writer)
+
+{
+    blt_writer_flush(writer);
+    free(writer->buf);
+    writer->buf = NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Bytes a record occupies in the output, including line breaks.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline size_t    blt_writer_record_size(bl_fastx_t *rec)
+
+{
+    size_t  size = bl_fastx_desc_len(rec) + bl_fastx_seq_len(rec) + 2;
+
+    if ( BL_FASTX_FORMAT(rec) == BL_FASTX_FORMAT_FASTQ )
+	size += bl_fastx_plus_len(rec) + bl_fastx_qual_len(rec) + 2;
+    return size;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append a record to the buffer, writing the buffer first when
+ *      the record does not fit.  Fields too large for the buffer are
+ *      written directly.  FASTA sequences are written on one line.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline void  blt_writer_record(blt_writer_t *writer, bl_fastx_t *rec)
+
+{
+    const char  *field[4];
+    size_t      len[4], f, fields;
+
+    field[0] = bl_fastx_desc(rec);
+    len[0] = bl_fastx_desc_len(rec);
+    field[1] = bl_fastx_seq(rec);
+    len[1] = bl_fastx_seq_len(rec);
+    fields = 2;
+    if ( BL_FASTX_FORMAT(rec) == BL_FASTX_FORMAT_FASTQ )
+    {
+	field[2] = bl_fastx_plus(rec);
+	len[2] = bl_fastx_plus_len(rec);
+	field[3] = bl_fastx_qual(rec);
+	len[3] = bl_fastx_qual_len(rec);
+	fields = 4;
+    }
+
+    if ( blt_writer_record_size(rec) > writer->size - writer->len )
+	blt_writer_flush(writer);
+    for (f = 0; f < fields; ++f)
+    {
+	if ( len[f] + 1 > writer->size - writer->len )
+	{
+	    blt_writer_flush(writer);
+	    fwrite(field[f], len[f], 1, writer->stream);
+	}
+	else
+	{
+	    memcpy(writer->buf + writer->len, field[f], len[f]);
+	    writer->len += len[f];
+	}
+	writer->buf[writer->len++] = '\n';
+    }
+}
+
+#endif  // _BLT_WRITER_H_
@@ -0,0 +1,1704 @@
+/***************************************************************************
+ *  Description:
+ *      Compressed input and output shared by blt subcommands.
+ *
+ *      blt_zopen() returns an ordinary FILE stream, so it can replace
+ *      fopen() or xt_fopen() in front of any biolibc reader.  The format
+ *      is detected from the data, not the filename, so compressed stdin
+ *      ("-") works too:
+ *
+ *      BGZF (bgzip, samtools, most sequencer output pipelines) consists of
+ *      independent deflate blocks of at most 64 KiB.  A reader thread
+ *      splits the input into batches of blocks, a pool of worker threads
+ *      inflates batches concurrently, and the caller reads them back in
+ *      order, so throughput scales with cores.
+ *
+ *      Plain gzip cannot be split, so it is inflated with zlib on one
+ *      thread running ahead of the caller through a ring of large
+ *      buffers, which at least overlaps decompression with parsing.
+ *
+ *      bzip2, xz, and zstd files are handed to xt_fopen(), which runs an
+ *      external decompressor.
+ *
+ *      Uncompressed input larger than one read-ahead buffer is read by
+ *      a thread into a pair of large, page-aligned buffers, so that one
+ *      is loaded while the caller parses the other.  Read latency, which
+ *      dominates on network filesystems such as NFS and Lustre, is then
+ *      hidden behind parsing instead of stalling it every few KiB as
+ *      stdio does.  Regular files are also marked POSIX_FADV_SEQUENTIAL
+ *      so the kernel reads ahead aggressively.  Smaller files are
+ *      returned as plain streams with no extra layer.
+ *
+ *      blt_zopen_range() reads only a byte range of an uncompressed
+ *      file the same way, so a tool can process one of the record-aligned
+ *      ranges listed by "fastx-split --index" without the data being
+ *      copied to a separate file first.
+ *
+ *      blt_bgzf_fdopen() is the reverse for output: data written to the
+ *      stream is cut into 64 KiB BGZF blocks, batches of blocks are
+ *      deflated concurrently by a pool of worker threads, and a writer
+ *      thread writes them in order, followed by the BGZF EOF marker.
+ *      The result is a valid gzip file that bgzip, tabix, samtools, and
+ *      gzip can read and index.
+ *
+ *      A tool writing many BGZF streams at once, such as the parts of
+ *      "fastx-split --round-robin", would start a writer and workers for
+ *      each.  blt_bgzf_fdopen_pool() instead opens a stream with no
+ *      threads of its own and two small slots, sized to fit a buffer
+ *      budget.  Filled slots from all such streams are queued to the
+ *      workers of one blt_zpool_create() pool, and whichever worker
+ *      finishes the next slot of a stream in order writes it.
+ *
+ *      Streams are built with fopencookie() (Linux) or funopen() (BSD,
+ *      macOS).  Elsewhere, blt_zopen() falls back to xt_fopen() and
+ *      blt_bgzf_fdopen() fails with ENOTSUP.  The streams cannot seek,
+ *      but ftello() reports the uncompressed bytes read or written so
+ *      far.  Close with blt_zclose().
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#if defined(__linux__) || defined(__CYGWIN__)
+#define _GNU_SOURCE     // fopencookie()
+#define HAVE_FOPENCOOKIE
+#elif defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || \
+      defined(__DragonFly__) || defined(__APPLE__)
+#define HAVE_FUNOPEN
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <xtend/file.h>
+#include "blt-zio.h"
+
+#define SNIFF_BYTES     18          // gzip header through BGZF BSIZE
+#define IN_BUFF_SIZE    (4 * 1024 * 1024)
+#define BGZF_MAX_BLOCK  65536       // Compressed or uncompressed
+#define BGZF_BLOCK_DATA 0xff00      // Input per output block, as bgzip
+#define BGZF_HEADER_LEN 18
+#define BGZF_TRAILER_LEN 8
+#define BATCH_BLOCKS    16          // BGZF blocks per slot
+#define SLOT_SIZE       (BATCH_BLOCKS * BGZF_MAX_BLOCK)
+#define MAX_SLOTS       64
+#define GZIP_SLOTS      8
+#define AHEAD_SLOTS     2           // Double buffering
+#define AHEAD_SLOT_SIZE (2 * 1024 * 1024)
+#define POOL_SLOTS      2           // Per stream: fill one, compress one
+#define POOL_SLOT_MIN   (16 * 1024)
+
+typedef enum
+{
+    ZIO_PLAIN,
+    ZIO_GZIP,
+    ZIO_BGZF,
+    ZIO_BGZF_OUT
+}   zio_format_t;
+
+typedef enum
+{
+    SLOT_FREE,      // Available to the producer
+    SLOT_FILLED,    // Holds work for a worker
+    SLOT_BUSY,      // Being inflated or deflated by a worker
+    SLOT_DONE       // Holds data for the consumer
+}   slot_state_t;
+
+typedef struct zslot
+{
+    unsigned char   *comp;
+    size_t          comp_len;
+    char            *data;
+    size_t          data_len;
+    size_t          data_pos;
+    slot_state_t    state;
+    struct zio      *owner;         // Stream, for pool workers
+    struct zslot    *next_job;      // Pool queue
+}   zslot_t;
+
+typedef struct zio
+{
+    const char      *filename;
+    int             fd;
+    zio_format_t    format;
+    unsigned char   *in_buff;       // Raw input staging
+    size_t          in_pos;
+    size_t          in_len;
+    zslot_t         slots[MAX_SLOTS];
+    unsigned        slot_count;
+    uint64_t        next_fill,      // Next slot for the caller (output)
+		    next_work,      // Next slot for a worker
+		    next_read,      // Next slot for the caller (input)
+		    total;          // Slots produced, valid once eof
+    bool            eof;
+    bool            error;
+    bool            stop;
+    bool            own_fd;         // Close fd with the stream
+    bool            regular;        // fd is a regular file, not a pipe
+    uint64_t        remaining;      // Bytes left to read from a range
+    uint64_t        offset;         // Uncompressed bytes read or written
+    size_t          slot_data;      // Output data per slot
+    size_t          comp_size;      // Output buffer per slot
+    blt_zpool_t     *pool;          // Shared workers instead of our own
+    uint64_t        next_write;     // Next slot for the pool to write
+    bool            writing;        // A pool worker is writing our slots
+    pthread_t       thread;         // Reader or writer
+    pthread_t       *workers;
+    unsigned        worker_count;
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+}   zio_t;
+
+struct blt_zpool
+{
+    zslot_t         *head,          // Filled slots from any stream
+		    *tail;
+    bool            stop;
+    pthread_t       *workers;
+    unsigned        worker_count;
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+};
+
+static int      bgzf_start(zio_t *z, unsigned threads,
+			   void *(*thread)(void *));
+static void     *bgzf_reader(void *arg);
+static void     *bgzf_writer(void *arg);
+static void     *bgzf_worker(void *arg);
+static void     *pool_worker(void *arg);
+static void     pool_submit(blt_zpool_t *pool, zslot_t *slot);
+static void     pool_write(zio_t *z, zslot_t *slot, bool ok);
+static void     *gzip_reader(void *arg);
+static int      plain_start(zio_t *z);
+static void     *plain_reader(void *arg);
+static bool     bgzf_inflate(zio_t *z, zslot_t *slot, z_stream *strm);
+static bool     bgzf_deflate(zio_t *z, zslot_t *slot, z_stream *strm);
+static int      write_all(int fd, const void *buff, size_t len);
+static void     put_le32(unsigned char *p, uint32_t val);
+static size_t   input_fill(zio_t *z, size_t need);
+static size_t   bgzf_block_len(const unsigned char *p, size_t avail);
+static zslot_t  *slot_wait(zio_t *z, uint64_t seq, slot_state_t state);
+static void     slot_set(zio_t *z, zslot_t *slot, slot_state_t state);
+static void     set_eof(zio_t *z, uint64_t total, bool error);
+static FILE     *zio_stream(zio_t *z);
+static int      zio_close(void *cookie);
+static int      zio_tell(zio_t *z, int whence, off_t offset, off_t *pos);
+static void     zio_free(zio_t *z);
+
+/***************************************************************************
+ *  Description:
+ *      Open filename ("-" for stdin) for reading, decompressing gzip and
+ *      BGZF on background threads.  threads is the number of BGZF
+ *      inflate threads, or BLT_ZIO_THREADS_DEFAULT for one per CPU.
+ *
+ *  Returns:
+ *      A FILE stream, or NULL with errno set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *blt_zopen(const char *filename, unsigned threads)
+
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    zio_t       *z;
+    unsigned    c;
+    ssize_t     bytes;
+    FILE        *stream;
+    struct stat st;
+    off_t       start;
+    int         fd;
+    bool        is_stdin = strcmp(filename, "-") == 0;
+
+    if ( is_stdin )
+	fd = STDIN_FILENO;
+    else if ( (fd = open(filename, O_RDONLY)) == -1 )
+	return NULL;
+    // Where the data starts, e.g. after lines read from stdin by a shell
+    start = lseek(fd, 0, SEEK_CUR);
+
+    if ( (z = calloc(1, sizeof(*z))) == NULL )
+	return NULL;
+    pthread_mutex_init(&z->lock, NULL);
+    pthread_cond_init(&z->changed, NULL);
+    z->filename = is_stdin ? "standard input" : filename;
+    z->fd = fd;
+    z->own_fd = !is_stdin;
+    z->remaining = UINT64_MAX;
+    if ( (z->in_buff = malloc(IN_BUFF_SIZE)) == NULL )
+    {
+	zio_free(z);
+	return NULL;
+    }
+    while ( (z->in_len < SNIFF_BYTES) &&
+	    ((bytes = read(fd, z->in_buff + z->in_len,
+			   SNIFF_BYTES - z->in_len)) > 0) )
+	z->in_len += bytes;
+
+    if ( (z->in_len >= 3) && (memcmp(z->in_buff, "\x1f\x8b\x08", 3) == 0) )
+    {
+	// FEXTRA with a "BC" subfield first, as written by bgzip
+	if ( (z->in_len == SNIFF_BYTES) && (z->in_buff[3] & 0x04) &&
+	     (memcmp(z->in_buff + 12, "BC\x02\x00", 4) == 0) )
+	    z->format = ZIO_BGZF;
+	else
+	    z->format = ZIO_GZIP;
+    }
+    else if ( !is_stdin &&
+	      (((z->in_len >= 3) && (memcmp(z->in_buff, "BZh", 3) == 0)) ||
+	       ((z->in_len >= 6) &&
+		(memcmp(z->in_buff, "\xfd" "7zXZ\x00", 6) == 0)) ||
+	       ((z->in_len >= 4) &&
+		(memcmp(z->in_buff, "\x28\xb5\x2f\xfd", 4) == 0))) )
+    {
+	zio_free(z);
+	return xt_fopen(filename, "r");
+    }
+    else
+    {
+	z->regular = (fstat(fd, &st) == 0) && S_ISREG(st.st_mode);
+	if ( z->regular && (start != -1) &&
+	     (st.st_size - start <= AHEAD_SLOT_SIZE) &&
+	     (lseek(fd, start, SEEK_SET) == start) )
+	{
+	    // Small enough that read-ahead cannot help
+	    free(z->in_buff);
+	    free(z);
+	    return is_stdin ? stdin : fdopen(fd, "r");
+	}
+	z->format = ZIO_PLAIN;  // Sniffed bytes, then read-ahead
+    }
+
+    if ( z->format == ZIO_BGZF )
+    {
+	if ( bgzf_start(z, threads, bgzf_reader) != 0 )
+	{
+	    zio_free(z);
+	    return NULL;
+	}
+    }
+    else if ( z->format == ZIO_GZIP )
+    {
+	z->slot_count = GZIP_SLOTS;
+	for (c = 0; c < z->slot_count; ++c)
+	{
+	    if ( (z->slots[c].data = malloc(SLOT_SIZE)) == NULL )
+	    {
+		zio_free(z);
+		return NULL;
+	    }
+	}
+	if ( pthread_create(&z->thread, NULL, gzip_reader, z) != 0 )
+	{
+	    zio_free(z);
+	    return NULL;
+	}
+    }
+    else
+    {
+#ifdef POSIX_FADV_SEQUENTIAL
+	if ( z->regular )
+	    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	if ( plain_start(z) != 0 )
+	{
+	    zio_free(z);
+	    return NULL;
+	}
+    }
+
+    if ( (stream = zio_stream(z)) == NULL )
+	zio_free(z);
+    return stream;
+#else
+    return strcmp(filename, "-") == 0 ? stdin : xt_fopen(filename, "r");
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Open bytes [start, end) of an uncompressed regular file ("-" for
+ *      stdin redirected from one) for reading, with read-ahead on a
+ *      thread as for large files in blt_zopen().  The range should be
+ *      record-aligned, such as one listed by "fastx-split --index".
+ *
+ *  Returns:
+ *      A FILE stream, or NULL with errno set, ESPIPE if the file is not
+ *      a regular file
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *blt_zopen_range(const char *filename, off_t start, off_t end)
+
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    zio_t       *z;
+    FILE        *stream;
+    struct stat st;
+    int         fd;
+    bool        is_stdin = strcmp(filename, "-") == 0;
+
+    if ( (start < 0) || (end < start) )
+    {
+	errno = EINVAL;
+	return NULL;
+    }
+    if ( is_stdin )
+	fd = STDIN_FILENO;
+    else if ( (fd = open(filename, O_RDONLY)) == -1 )
+	return NULL;
+    if ( (fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) ||
+	 (lseek(fd, start, SEEK_SET) != start) )
+    {
+	if ( !is_stdin )
+	    close(fd);
+	errno = ESPIPE;
+	return NULL;
+    }
+
+    if ( (z = calloc(1, sizeof(*z))) == NULL )
+	return NULL;
+    pthread_mutex_init(&z->lock, NULL);
+    pthread_cond_init(&z->changed, NULL);
+    z->filename = is_stdin ? "standard input" : filename;
+    z->fd = fd;
+    z->own_fd = !is_stdin;
+    z->format = ZIO_PLAIN;
+    z->regular = true;
+    z->remaining = end - start;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, start, end - start, POSIX_FADV_SEQUENTIAL);
+#endif
+    if ( plain_start(z) != 0 )
+    {
+	zio_free(z);
+	return NULL;
+    }
+    if ( (stream = zio_stream(z)) == NULL )
+	zio_free(z);
+    return stream;
+#else
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse a byte range for blt_zopen_range() given as START-END,
+ *      as listed by "fastx-split --index".
+ *
+ *  Returns:
+ *      0 on success, -1 if arg is not a valid range
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     blt_parse_range(const char *arg, off_t *start, off_t *end)
+
+{
+    char    *p;
+
+    if ( (*arg < '0') || (*arg > '9') )
+	return -1;
+    *start = strtoll(arg, &p, 10);
+    if ( (*p != '-') || (p[1] < '0') || (p[1] > '9') )
+	return -1;
+    *end = strtoll(p + 1, &p, 10);
+    return (*p == '\0') && (*end >= *start) ? 0 : -1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse the argument of a --threads option, a positive integer.
+ *      Reports invalid counts to stderr, so the caller need only print
+ *      its usage message.
+ *
+ *  Returns:
+ *      0 on success, -1 if arg is not a valid thread count
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     blt_parse_threads(const char *arg, unsigned *threads)
+
+{
+    char            *end;
+    unsigned long   count;
+
+    if ( (*arg >= '0') && (*arg <= '9') )
+    {
+	count = strtoul(arg, &end, 10);
+	if ( (*end == '\0') && (count >= 1) && (count <= UINT_MAX) )
+	{
+	    *threads = count;
+	    return 0;
+	}
+    }
+    fprintf(stderr, "Invalid thread count: %s\n", arg);
+    return -1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Open a stream that writes BGZF to fd, compressing on threads
+ *      worker threads, or BLT_ZIO_THREADS_DEFAULT for one per CPU.
+ *      fd is not closed by blt_zclose(), which flushes remaining data,
+ *      writes the EOF marker, and returns EOF if any write failed.
+ *
+ *  Returns:
+ *      A FILE stream, or NULL with errno set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *blt_bgzf_fdopen(int fd, unsigned threads)
+
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    zio_t       *z;
+    FILE        *stream;
+
+    if ( (z = calloc(1, sizeof(*z))) == NULL )
+	return NULL;
+    pthread_mutex_init(&z->lock, NULL);
+    pthread_cond_init(&z->changed, NULL);
+    z->filename = "output";
+    z->fd = fd;
+    z->format = ZIO_BGZF_OUT;
+    if ( bgzf_start(z, threads, bgzf_writer) != 0 )
+    {
+	zio_free(z);
+	return NULL;
+    }
+    if ( (stream = zio_stream(z)) == NULL )
+    {
+	zio_close(z);
+	return NULL;
+    }
+    return stream;
+#else
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Start a pool of threads BGZF compression threads, or
+ *      BLT_ZIO_THREADS_DEFAULT for one per CPU, shared by streams from
+ *      blt_bgzf_fdopen_pool().
+ *
+ *  Returns:
+ *      A pool, or NULL with errno set if memory is short or no thread
+ *      could be started
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+blt_zpool_t *blt_zpool_create(unsigned threads)
+
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    blt_zpool_t *pool;
+    unsigned    c;
+    long        cpus;
+    int         error = 0;
+
+    if ( threads == BLT_ZIO_THREADS_DEFAULT )
+	threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1 ? 1 : cpus;
+    if ( (pool = calloc(1, sizeof(*pool))) == NULL )
+	return NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->changed, NULL);
+    if ( (pool->workers = malloc(threads * sizeof(*pool->workers))) == NULL )
+    {
+	blt_zpool_destroy(pool);
+	return NULL;
+    }
+    for (c = 0; c < threads; ++c)
+	if ( (error = pthread_create(&pool->workers[pool->worker_count],
+				     NULL, pool_worker, pool)) == 0 )
+	    ++pool->worker_count;
+    if ( pool->worker_count == 0 )
+    {
+	blt_zpool_destroy(pool);
+	errno = error;
+	return NULL;
+    }
+    return pool;
+#else
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stop and free a pool.  Every stream using it must be closed
+ *      first.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    blt_zpool_destroy(blt_zpool_t *pool)
+
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    unsigned    c;
+
+    if ( pool == NULL )
+	return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    for (c = 0; c < pool->worker_count; ++c)
+	pthread_join(pool->workers[c], NULL);
+    free(pool->workers);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->changed);
+    free(pool);
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Open a stream that writes BGZF to fd like blt_bgzf_fdopen(), but
+ *      compressed and written by the workers of pool.  The stream
+ *      starts no threads and its slots use about buff_size bytes in
+ *      all, so many can be open at once.
+ *
+ *  Returns:
+ *      A FILE stream, or NULL with errno set
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *blt_bgzf_fdopen_pool(int fd, blt_zpool_t *pool, size_t buff_size)
+
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    zio_t       *z;
+    FILE        *stream;
+    unsigned    c;
+
+    if ( (z = calloc(1, sizeof(*z))) == NULL )
+	return NULL;
+    pthread_mutex_init(&z->lock, NULL);
+    pthread_cond_init(&z->changed, NULL);
+    z->filename = "output";
+    z->fd = fd;
+    z->format = ZIO_BGZF_OUT;
+    z->pool = pool;
+
+    // Each slot holds data plus room for it compressed, a little more
+    // than the data for each block
+    z->slot_count = POOL_SLOTS;
+    z->slot_data = buff_size / (2 * POOL_SLOTS);
+    if ( z->slot_data < POOL_SLOT_MIN )
+	z->slot_data = POOL_SLOT_MIN;
+    else if ( z->slot_data > BATCH_BLOCKS * BGZF_BLOCK_DATA )
+	z->slot_data = BATCH_BLOCKS * BGZF_BLOCK_DATA;
+    z->comp_size = z->slot_data +
+		   (z->slot_data + BGZF_BLOCK_DATA - 1) / BGZF_BLOCK_DATA *
+		   (BGZF_MAX_BLOCK - BGZF_BLOCK_DATA);
+    for (c = 0; c < z->slot_count; ++c)
+    {
+	z->slots[c].comp = malloc(z->comp_size);
+	z->slots[c].data = malloc(z->slot_data);
+	z->slots[c].owner = z;
+	if ( (z->slots[c].comp == NULL) || (z->slots[c].data == NULL) )
+	{
+	    zio_free(z);
+	    return NULL;
+	}
+    }
+    if ( (stream = zio_stream(z)) == NULL )
+	zio_free(z);
+    return stream;
+#else
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Close a stream from blt_zopen() or blt_bgzf_fdopen().  Threaded
+ *      streams have no file descriptor and are cleaned up by fclose();
+ *      others may be pipes from xt_fopen().  stdin and stdout are left
+ *      open.
+ *
+ *  Returns:
+ *      0 on success, EOF if an error occurred, as fclose()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     blt_zclose(FILE *stream)
+
+{
+    if ( stream == stdin )
+	return 0;
+    if ( stream == stdout )
+	return fflush(stdout);
+    if ( fileno(stream) == -1 )
+	return fclose(stream);
+    return xt_fclose(stream);
+}
+
+
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+
+/***************************************************************************
+ *  Description:
+ *      Stream read function: copy out of the next slot in order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static ssize_t  zio_read(void *cookie, char *buff, size_t size)
+
+{
+    zio_t       *z = cookie;
+    zslot_t     *slot;
+    size_t      len;
+
+    if ( (slot = slot_wait(z, z->next_read, SLOT_DONE)) == NULL )
+    {
+	if ( z->error )
+	{
+	    errno = EIO;
+	    return -1;
+	}
+	return 0;   // EOF
+    }
+    len = slot->data_len - slot->data_pos;
+    if ( len > size )
+	len = size;
+    memcpy(buff, slot->data + slot->data_pos, len);
+    slot->data_pos += len;
+    z->offset += len;
+    if ( slot->data_pos == slot->data_len )
+    {
+	pthread_mutex_lock(&z->lock);
+	++z->next_read;
+	pthread_mutex_unlock(&z->lock);
+	slot_set(z, slot, SLOT_FREE);
+    }
+    return len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stream write function: copy into the current slot, handing it to
+ *      the workers when full.  Returns 0 on error, which both
+ *      fopencookie() and funopen() treat as a failed write.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static ssize_t  zio_write(void *cookie, const char *buff, size_t size)
+
+{
+    zio_t       *z = cookie;
+    zslot_t     *slot;
+    size_t      len, done;
+
+    for (done = 0; done < size; done += len)
+    {
+	if ( (slot = slot_wait(z, z->next_fill, SLOT_FREE)) == NULL )
+	    return 0;
+	len = z->slot_data - slot->data_len;
+	if ( len > size - done )
+	    len = size - done;
+	memcpy(slot->data + slot->data_len, buff + done, len);
+	slot->data_len += len;
+	if ( slot->data_len == z->slot_data )
+	{
+	    ++z->next_fill;
+	    slot_set(z, slot, SLOT_FILLED);
+	    if ( z->pool != NULL )
+		pool_submit(z->pool, slot);
+	}
+    }
+    z->offset += done;
+    return done;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stream seek function.  The streams cannot seek, but report the
+ *      current uncompressed offset so that ftello() works, e.g. to
+ *      count the bytes a subcommand has processed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static int  zio_tell(zio_t *z, int whence, off_t offset, off_t *pos)
+
+{
+    if ( (whence != SEEK_CUR) || (offset != 0) )
+    {
+	errno = ESPIPE;
+	return -1;
+    }
+    *pos = z->offset;
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stream close function.  Input threads are stopped wherever they
+ *      are.  Output threads are allowed to finish the remaining data,
+ *      and the BGZF EOF marker is appended.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static int  zio_close(void *cookie)
+
+{
+    zio_t       *z = cookie;
+    zslot_t     *slot;
+    unsigned    c;
+    int         status = 0;
+    bool        partial;
+    // Empty block, as written by bgzip
+    static const unsigned char  eof_block[28] =
+	"\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0\x1b\0"
+	"\x03\0\0\0\0\0\0\0\0\0";
+
+    if ( z->format == ZIO_BGZF_OUT )
+    {
+	// Hand off the partial batch, if any
+	slot = &z->slots[z->next_fill % z->slot_count];
+	pthread_mutex_lock(&z->lock);
+	if ( (partial = (slot->state == SLOT_FREE) && (slot->data_len > 0)) )
+	{
+	    ++z->next_fill;
+	    slot->state = SLOT_FILLED;
+	}
+	pthread_mutex_unlock(&z->lock);
+	if ( z->pool != NULL )
+	{
+	    if ( partial )
+		pool_submit(z->pool, slot);
+	    pthread_mutex_lock(&z->lock);
+	    while ( z->next_write < z->next_fill )
+		pthread_cond_wait(&z->changed, &z->lock);
+	    pthread_mutex_unlock(&z->lock);
+	}
+	else
+	{
+	    set_eof(z, z->next_fill, false);
+	    pthread_join(z->thread, NULL);
+	    for (c = 0; c < z->worker_count; ++c)
+		pthread_join(z->workers[c], NULL);
+	}
+	if ( z->error || (write_all(z->fd, eof_block, sizeof(eof_block)) != 0) )
+	    status = EOF;
+    }
+    else
+    {
+	pthread_mutex_lock(&z->lock);
+	z->stop = true;
+	pthread_cond_broadcast(&z->changed);
+	pthread_mutex_unlock(&z->lock);
+	pthread_join(z->thread, NULL);
+	for (c = 0; c < z->worker_count; ++c)
+	    pthread_join(z->workers[c], NULL);
+    }
+    zio_free(z);
+    return status;
+}
+
+
+#ifdef HAVE_FOPENCOOKIE
+static int  zio_seek(void *cookie, off64_t *offset, int whence)
+
+{
+    off_t   pos;
+
+    if ( zio_tell(cookie, whence, *offset, &pos) != 0 )
+	return -1;
+    *offset = pos;
+    return 0;
+}
+
+
+static FILE *zio_stream(zio_t *z)
+
+{
+    cookie_io_functions_t   funcs = { zio_read, zio_write, zio_seek,
+				      zio_close };
+
+    return fopencookie(z, z->format == ZIO_BGZF_OUT ? "w" : "r", funcs);
+}
+#else
+static int  zio_funread(void *cookie, char *buff, int size)
+
+{
+    return zio_read(cookie, buff, size);
+}
+
+
+static int  zio_funwrite(void *cookie, const char *buff, int size)
+
+{
+    return zio_write(cookie, buff, size);
+}
+
+
+static fpos_t   zio_funseek(void *cookie, fpos_t offset, int whence)
+
+{
+    off_t   pos;
+
+    if ( zio_tell(cookie, whence, offset, &pos) != 0 )
+	return -1;
+    return pos;
+}
+
+
+static FILE *zio_stream(zio_t *z)
+
+{
+    if ( z->format == ZIO_BGZF_OUT )
+	return funopen(z, NULL, zio_funwrite, zio_funseek, zio_close);
+    return funopen(z, zio_funread, NULL, zio_funseek, zio_close);
+}
+#endif
+
+
+/***************************************************************************
+ *  Description:
+ *      Allocate slots for BGZF input or output and start the reader or
+ *      writer thread and the worker pool.  Returns -1 with errno set if
+ *      memory is short or no worker could be started.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static int  bgzf_start(zio_t *z, unsigned threads, void *(*thread)(void *))
+
+{
+    unsigned    c;
+    long        cpus;
+    int         error = 0;
+
+    if ( threads == BLT_ZIO_THREADS_DEFAULT )
+	threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1 ? 1 : cpus;
+    z->slot_count = 2 * threads + 2;
+    if ( z->slot_count > MAX_SLOTS )
+	z->slot_count = MAX_SLOTS;
+    z->slot_data = BATCH_BLOCKS * BGZF_BLOCK_DATA;
+    z->comp_size = SLOT_SIZE;
+    for (c = 0; c < z->slot_count; ++c)
+    {
+	z->slots[c].comp = malloc(SLOT_SIZE);
+	z->slots[c].data = malloc(SLOT_SIZE);
+	if ( (z->slots[c].comp == NULL) || (z->slots[c].data == NULL) )
+	    return -1;
+    }
+    if ( (z->workers = malloc(threads * sizeof(*z->workers))) == NULL )
+	return -1;
+    if ( (error = pthread_create(&z->thread, NULL, thread, z)) != 0 )
+    {
+	errno = error;
+	return -1;
+    }
+    for (c = 0; c < threads; ++c)
+	if ( (error = pthread_create(&z->workers[z->worker_count], NULL,
+				     bgzf_worker, z)) == 0 )
+	    ++z->worker_count;
+
+    // Fewer workers only slow things down, but with none, the reader
+    // or writer would wait forever for a slot
+    if ( z->worker_count == 0 )
+    {
+	pthread_mutex_lock(&z->lock);
+	z->stop = true;
+	pthread_cond_broadcast(&z->changed);
+	pthread_mutex_unlock(&z->lock);
+	pthread_join(z->thread, NULL);
+	errno = error;
+	return -1;
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: split BGZF input into batches of whole blocks
+ *      for the workers.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void *bgzf_reader(void *arg)
+
+{
+    zio_t       *z = arg;
+    zslot_t     *slot;
+    size_t      avail, block_len;
+    unsigned    blocks;
+    uint64_t    seq;
+
+    for (seq = 0; ; ++seq)
+    {
+	if ( (slot = slot_wait(z, seq, SLOT_FREE)) == NULL )
+	    return NULL;
+	slot->comp_len = 0;
+	for (blocks = 0; blocks < BATCH_BLOCKS; ++blocks)
+	{
+	    if ( (avail = input_fill(z, SNIFF_BYTES)) == 0 )
+		break;
+	    if ( (block_len = bgzf_block_len(z->in_buff + z->in_pos, avail))
+		    == 0 )
+	    {
+		fprintf(stderr, "blt_zopen(): %s: Invalid BGZF block.\n",
+			z->filename);
+		set_eof(z, seq, true);
+		return NULL;
+	    }
+	    if ( input_fill(z, block_len) < block_len )
+	    {
+		fprintf(stderr, "blt_zopen(): %s: Truncated BGZF block.\n",
+			z->filename);
+		set_eof(z, seq, true);
+		return NULL;
+	    }
+	    memcpy(slot->comp + slot->comp_len, z->in_buff + z->in_pos,
+		   block_len);
+	    slot->comp_len += block_len;
+	    z->in_pos += block_len;
+	}
+	if ( blocks == 0 )
+	{
+	    set_eof(z, seq, false);
+	    return NULL;
+	}
+	slot_set(z, slot, SLOT_FILLED);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: write deflated batches in order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void *bgzf_writer(void *arg)
+
+{
+    zio_t       *z = arg;
+    zslot_t     *slot;
+    uint64_t    seq;
+
+    for (seq = 0; (slot = slot_wait(z, seq, SLOT_DONE)) != NULL; ++seq)
+    {
+	if ( write_all(z->fd, slot->comp, slot->comp_len) != 0 )
+	{
+	    fprintf(stderr, "blt_bgzf_fdopen(): Error writing %s: %s\n",
+		    z->filename, strerror(errno));
+	    set_eof(z, 0, true);
+	    break;
+	}
+	slot->data_len = 0;
+	slot_set(z, slot, SLOT_FREE);
+    }
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: inflate or deflate batches in the order they
+ *      were filled, several at a time across workers.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void *bgzf_worker(void *arg)
+
+{
+    zio_t       *z = arg;
+    zslot_t     *slot;
+    z_stream    strm;
+    bool        ok;
+    int         status;
+
+    memset(&strm, 0, sizeof(strm));
+    if ( z->format == ZIO_BGZF_OUT )
+	status = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15,
+			      8, Z_DEFAULT_STRATEGY);
+    else
+	status = inflateInit2(&strm, -15);
+    if ( status != Z_OK )
+    {
+	set_eof(z, 0, true);
+	return NULL;
+    }
+    while ( true )
+    {
+	pthread_mutex_lock(&z->lock);
+	while ( !z->stop && !(z->eof && (z->next_work >= z->total)) &&
+		(z->slots[z->next_work % z->slot_count].state
+		    != SLOT_FILLED) )
+	    pthread_cond_wait(&z->changed, &z->lock);
+	if ( z->stop || (z->eof && (z->next_work >= z->total)) )
+	{
+	    pthread_mutex_unlock(&z->lock);
+	    break;
+	}
+	slot = &z->slots[z->next_work++ % z->slot_count];
+	slot->state = SLOT_BUSY;
+	pthread_mutex_unlock(&z->lock);
+
+	if ( z->format == ZIO_BGZF_OUT )
+	    ok = bgzf_deflate(z, slot, &strm);
+	else
+	    ok = bgzf_inflate(z, slot, &strm);
+	slot_set(z, slot, SLOT_DONE);
+	if ( !ok )
+	    set_eof(z, 0, true);
+    }
+    if ( z->format == ZIO_BGZF_OUT )
+	deflateEnd(&strm);
+    else
+	inflateEnd(&strm);
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: deflate slots queued by any stream of a pool,
+ *      in the order they were filled.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void *pool_worker(void *arg)
+
+{
+    blt_zpool_t *pool = arg;
+    zslot_t     *slot;
+    z_stream    strm;
+    bool        ready;
+
+    // On failure, keep taking slots so that streams fail instead of
+    // waiting forever
+    memset(&strm, 0, sizeof(strm));
+    ready = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15,
+			 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    while ( true )
+    {
+	pthread_mutex_lock(&pool->lock);
+	while ( !pool->stop && (pool->head == NULL) )
+	    pthread_cond_wait(&pool->changed, &pool->lock);
+	if ( (slot = pool->head) == NULL )
+	{
+	    pthread_mutex_unlock(&pool->lock);
+	    break;
+	}
+	if ( (pool->head = slot->next_job) == NULL )
+	    pool->tail = NULL;
+	pthread_mutex_unlock(&pool->lock);
+
+	pool_write(slot->owner, slot,
+		   ready && bgzf_deflate(slot->owner, slot, &strm));
+    }
+    if ( ready )
+	deflateEnd(&strm);
+    return NULL;
+}
+
+
+static void pool_submit(blt_zpool_t *pool, zslot_t *slot)
+
+{
+    slot->next_job = NULL;
+    pthread_mutex_lock(&pool->lock);
+    if ( pool->tail == NULL )
+	pool->head = slot;
+    else
+	pool->tail->next_job = slot;
+    pool->tail = slot;
+    pthread_cond_signal(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Mark a slot deflated by a pool worker, then write every slot of
+ *      the stream that is ready in order, unless another worker already
+ *      is.  After an error, slots are freed without being written.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void pool_write(zio_t *z, zslot_t *slot, bool ok)
+
+{
+    bool    error;
+
+    pthread_mutex_lock(&z->lock);
+    slot->state = SLOT_DONE;
+    if ( !ok )
+	z->error = true;
+    if ( !z->writing )
+    {
+	z->writing = true;
+	while ( (slot = &z->slots[z->next_write % z->slot_count])->state
+		== SLOT_DONE )
+	{
+	    error = z->error;
+	    pthread_mutex_unlock(&z->lock);
+	    if ( !error && (write_all(z->fd, slot->comp, slot->comp_len) != 0) )
+	    {
+		fprintf(stderr, "blt_bgzf_fdopen(): Error writing %s: %s\n",
+			z->filename, strerror(errno));
+		error = true;
+	    }
+	    pthread_mutex_lock(&z->lock);
+	    z->error |= error;
+	    slot->data_len = 0;
+	    slot->state = SLOT_FREE;
+	    ++z->next_write;
+	    pthread_cond_broadcast(&z->changed);
+	}
+	z->writing = false;
+    }
+    pthread_cond_broadcast(&z->changed);
+    pthread_mutex_unlock(&z->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Inflate every block in a slot and verify its CRC and length.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static bool bgzf_inflate(zio_t *z, zslot_t *slot, z_stream *strm)
+
+{
+    unsigned char   *block, *trailer;
+    size_t          pos, block_len, xlen;
+    uint32_t        crc, isize;
+
+    slot->data_len = slot->data_pos = 0;
+    for (pos = 0; pos < slot->comp_len; pos += block_len)
+    {
+	block = slot->comp + pos;
+	block_len = bgzf_block_len(block, slot->comp_len - pos);
+	xlen = block[10] | (block[11] << 8);
+	trailer = block + block_len - 8;
+	crc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) |
+	      ((uint32_t)trailer[3] << 24);
+	isize = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) |
+		((uint32_t)trailer[7] << 24);
+	if ( isize > BGZF_MAX_BLOCK )
+	    break;
+
+	inflateReset(strm);
+	strm->next_in = block + 12 + xlen;
+	strm->avail_in = block_len - 20 - xlen;
+	strm->next_out = (unsigned char *)slot->data + slot->data_len;
+	strm->avail_out = isize;
+	if ( (inflate(strm, Z_FINISH) != Z_STREAM_END) ||
+	     (strm->avail_out != 0) ||
+	     (crc32(0, (unsigned char *)slot->data + slot->data_len, isize)
+		!= crc) )
+	    break;
+	slot->data_len += isize;
+    }
+    if ( pos < slot->comp_len )
+    {
+	fprintf(stderr, "blt_zopen(): %s: Corrupt BGZF block.\n",
+		z->filename);
+	return false;
+    }
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Deflate the data in a slot into BGZF blocks of at most
+ *      BGZF_BLOCK_DATA bytes each, so every compressed block fits in
+ *      64 KiB even if the data is incompressible.  The smaller slots of
+ *      pool streams leave the same margin per block.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static bool bgzf_deflate(zio_t *z, zslot_t *slot, z_stream *strm)
+
+{
+    unsigned char   *block;
+    size_t          pos, len, cdata_len, room;
+    static const unsigned char  header[BGZF_HEADER_LEN] =
+	"\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0";
+
+    slot->comp_len = 0;
+    for (pos = 0; pos < slot->data_len; pos += len)
+    {
+	len = slot->data_len - pos;
+	if ( len > BGZF_BLOCK_DATA )
+	    len = BGZF_BLOCK_DATA;
+	block = slot->comp + slot->comp_len;
+	if ( (room = z->comp_size - slot->comp_len) > BGZF_MAX_BLOCK )
+	    room = BGZF_MAX_BLOCK;
+
+	deflateReset(strm);
+	strm->next_in = (unsigned char *)slot->data + pos;
+	strm->avail_in = len;
+	strm->next_out = block + BGZF_HEADER_LEN;
+	strm->avail_out = room - BGZF_HEADER_LEN - BGZF_TRAILER_LEN;
+	if ( deflate(strm, Z_FINISH) != Z_STREAM_END )
+	{
+	    fprintf(stderr, "blt_bgzf_fdopen(): %s: Block overflow.\n",
+		    z->filename);
+	    return false;
+	}
+	cdata_len = strm->next_out - (block + BGZF_HEADER_LEN);
+
+	memcpy(block, header, BGZF_HEADER_LEN);
+	block[16] = (cdata_len + BGZF_HEADER_LEN + BGZF_TRAILER_LEN - 1) & 0xff;
+	block[17] = (cdata_len + BGZF_HEADER_LEN + BGZF_TRAILER_LEN - 1) >> 8;
+	put_le32(block + BGZF_HEADER_LEN + cdata_len,
+		 crc32(0, (unsigned char *)slot->data + pos, len));
+	put_le32(block + BGZF_HEADER_LEN + cdata_len + 4, len);
+	slot->comp_len += BGZF_HEADER_LEN + cdata_len + BGZF_TRAILER_LEN;
+    }
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: inflate plain gzip (including concatenated
+ *      members) into the slot ring ahead of the caller.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void *gzip_reader(void *arg)
+
+{
+    zio_t       *z = arg;
+    zslot_t     *slot;
+    z_stream    strm;
+    uint64_t    seq;
+    int         status = Z_OK;
+    bool        in_member = true;
+
+    memset(&strm, 0, sizeof(strm));
+    if ( inflateInit2(&strm, 15 + 16) != Z_OK )
+    {
+	set_eof(z, 0, true);
+	return NULL;
+    }
+    for (seq = 0; ; ++seq)
+    {
+	if ( (slot = slot_wait(z, seq, SLOT_FREE)) == NULL )
+	    break;
+	strm.next_out = (unsigned char *)slot->data;
+	strm.avail_out = SLOT_SIZE;
+	while ( strm.avail_out > 0 )
+	{
+	    if ( z->in_pos == z->in_len )
+	    {
+		z->in_pos = z->in_len = 0;
+		if ( input_fill(z, 1) == 0 )
+		{
+		    if ( in_member )
+			status = Z_BUF_ERROR;   // Truncated
+		    break;
+		}
+	    }
+	    strm.next_in = z->in_buff + z->in_pos;
+	    strm.avail_in = z->in_len - z->in_pos;
+	    status = inflate(&strm, Z_NO_FLUSH);
+	    if ( z->in_len - strm.avail_in > z->in_pos )
+		in_member = true;
+	    z->in_pos = z->in_len - strm.avail_in;
+	    if ( status == Z_STREAM_END )
+	    {
+		// Another member may follow
+		inflateReset(&strm);
+		status = Z_OK;
+		in_member = false;
+	    }
+	    else if ( status != Z_OK )
+		break;
+	}
+	slot->data_len = SLOT_SIZE - strm.avail_out;
+	slot->data_pos = 0;
+	if ( status != Z_OK )
+	{
+	    fprintf(stderr, "blt_zopen(): %s: Corrupt gzip data.\n",
+		    z->filename);
+	    set_eof(z, seq, true);
+	    break;
+	}
+	if ( slot->data_len == 0 )
+	{
+	    set_eof(z, seq, false);
+	    break;
+	}
+	slot_set(z, slot, SLOT_DONE);
+    }
+    inflateEnd(&strm);
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Allocate read-ahead buffers for uncompressed input and start the
+ *      reader thread.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static int  plain_start(zio_t *z)
+
+{
+    unsigned    c;
+
+    z->slot_count = AHEAD_SLOTS;
+    for (c = 0; c < z->slot_count; ++c)
+    {
+	// Page-aligned, so reads can go straight to the page cache
+	if ( posix_memalign((void **)&z->slots[c].data,
+			    sysconf(_SC_PAGESIZE), AHEAD_SLOT_SIZE) != 0 )
+	    return -1;
+    }
+    return pthread_create(&z->thread, NULL, plain_reader, z) != 0 ? -1 : 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read-ahead thread for uncompressed input: fill buffers in order
+ *      while the caller parses earlier ones, starting with the bytes
+ *      read to detect the format.  Buffers from a regular file are
+ *      filled completely to keep reads large.  Data from a pipe is
+ *      passed on as soon as it arrives, so a slow producer does not
+ *      delay the caller.  Reading stops after z->remaining bytes for
+ *      a range.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void *plain_reader(void *arg)
+
+{
+    zio_t       *z = arg;
+    zslot_t     *slot;
+    uint64_t    seq;
+    size_t      len, want;
+    ssize_t     bytes;
+
+    for (seq = 0; ; ++seq)
+    {
+	if ( (slot = slot_wait(z, seq, SLOT_FREE)) == NULL )
+	    break;
+	len = z->in_len - z->in_pos;
+	if ( len > 0 )
+	    memcpy(slot->data, z->in_buff + z->in_pos, len);
+	z->in_pos = z->in_len;
+	while ( (len < AHEAD_SLOT_SIZE) && (z->remaining > 0) )
+	{
+	    want = AHEAD_SLOT_SIZE - len;
+	    if ( want > z->remaining )
+		want = z->remaining;
+	    bytes = read(z->fd, slot->data + len, want);
+	    if ( (bytes < 0) && (errno == EINTR) )
+		continue;
+	    if ( bytes < 0 )
+	    {
+		fprintf(stderr, "blt_zopen(): %s: %s\n", z->filename,
+			strerror(errno));
+		set_eof(z, seq, true);
+		return NULL;
+	    }
+	    if ( bytes == 0 )
+		break;
+	    len += bytes;
+	    z->remaining -= bytes;
+	    if ( !z->regular )
+		break;
+	}
+	slot->data_len = len;
+	slot->data_pos = 0;
+	if ( len == 0 )
+	{
+	    set_eof(z, seq, false);
+	    break;
+	}
+	slot_set(z, slot, SLOT_DONE);
+    }
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Make at least need bytes of raw input available at in_pos,
+ *      reading more if necessary.  Returns the bytes available, which
+ *      is less than need only at EOF.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static size_t   input_fill(zio_t *z, size_t need)
+
+{
+    ssize_t bytes;
+
+    if ( z->in_len - z->in_pos >= need )
+	return z->in_len - z->in_pos;
+    memmove(z->in_buff, z->in_buff + z->in_pos, z->in_len - z->in_pos);
+    z->in_len -= z->in_pos;
+    z->in_pos = 0;
+    while ( z->in_len < need )
+    {
+	bytes = read(z->fd, z->in_buff + z->in_len, IN_BUFF_SIZE - z->in_len);
+	if ( (bytes < 0) && (errno == EINTR) )
+	    continue;
+	if ( bytes <= 0 )
+	    break;
+	z->in_len += bytes;
+    }
+    return z->in_len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return the total length of the BGZF block at p from its BSIZE
+ *      subfield, or 0 if p is not a valid BGZF block header.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static size_t   bgzf_block_len(const unsigned char *p, size_t avail)
+
+{
+    size_t  xlen, pos, slen;
+
+    if ( (avail < 12) || (memcmp(p, "\x1f\x8b\x08", 3) != 0) ||
+	 !(p[3] & 0x04) )
+	return 0;
+    xlen = p[10] | (p[11] << 8);
+    if ( avail < 12 + xlen )
+	return 0;
+    for (pos = 12; pos + 4 <= 12 + xlen; pos += 4 + slen)
+    {
+	slen = p[pos + 2] | (p[pos + 3] << 8);
+	if ( (p[pos] == 'B') && (p[pos + 1] == 'C') && (slen == 2) &&
+	     (pos + 6 <= 12 + xlen) )
+	    return (p[pos + 4] | (p[pos + 5] << 8)) + 1;
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Wait until slot seq is in state, or return NULL if the stream is
+ *      stopped or seq is past the end of the data.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static zslot_t  *slot_wait(zio_t *z, uint64_t seq, slot_state_t state)
+
+{
+    zslot_t *slot = &z->slots[seq % z->slot_count];
+
+    pthread_mutex_lock(&z->lock);
+    while ( !z->stop && !z->error && !(z->eof && (seq >= z->total)) &&
+	    (slot->state != state) )
+	pthread_cond_wait(&z->changed, &z->lock);
+    if ( z->stop || z->error || (z->eof && (seq >= z->total) &&
+				 (slot->state != state || state == SLOT_FREE)) )
+	slot = NULL;
+    pthread_mutex_unlock(&z->lock);
+    return slot;
+}
+
+
+static void slot_set(zio_t *z, zslot_t *slot, slot_state_t state)
+
+{
+    pthread_mutex_lock(&z->lock);
+    slot->state = state;
+    pthread_cond_broadcast(&z->changed);
+    pthread_mutex_unlock(&z->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Record that total slots were produced, or that an error occurred.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static void set_eof(zio_t *z, uint64_t total, bool error)
+
+{
+    pthread_mutex_lock(&z->lock);
+    if ( error )
+	z->error = true;
+    else
+    {
+	z->eof = true;
+	z->total = total;
+    }
+    pthread_cond_broadcast(&z->changed);
+    pthread_mutex_unlock(&z->lock);
+}
+
+
+static int  write_all(int fd, const void *buff, size_t len)
+
+{
+    const char  *p = buff;
+    ssize_t     bytes;
+
+    while ( len > 0 )
+    {
+	if ( (bytes = write(fd, p, len)) < 0 )
+	{
+	    if ( errno == EINTR )
+		continue;
+	    return -1;
+	}
+	p += bytes;
+	len -= bytes;
+    }
+    return 0;
+}
+
+
+static void put_le32(unsigned char *p, uint32_t val)
+
+{
+    p[0] = val & 0xff;
+    p[1] = (val >> 8) & 0xff;
+    p[2] = (val >> 16) & 0xff;
+    p[3] = val >> 24;
+}
+
+
+static void zio_free(zio_t *z)
+
+{
+    unsigned    c;
+
+    if ( z->own_fd )
+	close(z->fd);
+    for (c = 0; c < MAX_SLOTS; ++c)
+    {
+	free(z->slots[c].comp);
+	free(z->slots[c].data);
+    }
+    free(z->workers);
+    free(z->in_buff);
+    pthread_mutex_destroy(&z->lock);
+    pthread_cond_destroy(&z->changed);
+    free(z);
+}
+
+#endif  // HAVE_FOPENCOOKIE || HAVE_FUNOPEN
@@ -0,0 +1,32 @@
+/***************************************************************************
+ *  Description:
+ *      Compressed input and output shared by blt subcommands.
+ *      See blt-zio.c.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifndef _BLT_ZIO_H_
+#define _BLT_ZIO_H_
+
+#include <stdio.h>
+#include <sys/types.h>
+
+// Use all online CPUs
+#define BLT_ZIO_THREADS_DEFAULT 0
+
+typedef struct blt_zpool    blt_zpool_t;
+
+FILE    *blt_zopen(const char *filename, unsigned threads);
+FILE    *blt_zopen_range(const char *filename, off_t start, off_t end);
+int     blt_parse_range(const char *arg, off_t *start, off_t *end);
+int     blt_parse_threads(const char *arg, unsigned *threads);
+FILE    *blt_bgzf_fdopen(int fd, unsigned threads);
+blt_zpool_t *blt_zpool_create(unsigned threads);
+void    blt_zpool_destroy(blt_zpool_t *pool);
+FILE    *blt_bgzf_fdopen_pool(int fd, blt_zpool_t *pool, size_t buff_size);
+int     blt_zclose(FILE *stream);
+
+#endif  // _BLT_ZIO_H_
@@ -24,6 +24,27 @@
  *
  *          env PATH=prefix/bin:$PATH fastx-derep args
  *
+ *      When built with -DBLT_MULTICALL ("make multicall"), the main()
+ *      of every subcommand is linked into this program and called
+ *      directly through a table generated at build time, with no
+ *      exec or directory scan.  Like busybox, a multicall blt also runs
+ *      the subcommand named by argv[0], so symlinks named after each
+ *      subcommand work like the separate binaries.
+ *
+ *      "blt --profile subcommand args" sets BLT_PROFILE so that the
+ *      subcommand prints a JSON summary of where its time went to
+ *      stderr.  In a pipe, each stage run as a separate process prints
+ *      its own, while in-process stages are covered by one "pipe"
+ *      summary.  See blt-profile.h.
+ *
+ *      "blt pipe stage1 args : stage2 args ..." runs a pipeline of
+ *      subcommands (or other programs in PATH) without a shell, each
+ *      stage in its own process connected by pipes enlarged where the
+ *      OS allows.  In a multicall build, blt subcommands are forked
+ *      without an exec.  Consecutive FASTA/FASTQ subcommands that have
+ *      in-process stages (see blt-stage.c) run as threads of one
+ *      process instead, passing parsed records without a pipe.
+ *
  *  Arguments:
  *      The subcommand and its specific arguments, as if it were run
  *      directly.
@@ -33,22 +54,87 @@
  *  2021-09-13  Jason Bacon Begin
  ***************************************************************************/
 
+#ifdef __linux__
+#define _GNU_SOURCE // F_SETPIPE_SZ
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <sysexits.h>
 #include <limits.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include "blt-stage.h"
+
+#define MAX_STAGES      64
+#define PIPE_BUFF_SIZE  (1024 * 1024)
+
+#ifdef BLT_MULTICALL
+typedef struct
+{
+    const char  *name;
+    int         (*main)(int argc, char *argv[]);
+}   subcommand_t;
+
+// blt-subcommands.h is generated from BINS by "make multicall"
+#define BLT_SUBCOMMAND(name, sym)   int sym(int argc, char *argv[]);
+#include "blt-subcommands.h"
+#undef BLT_SUBCOMMAND
+
+#define BLT_SUBCOMMAND(name, sym)   { name, sym },
+static const subcommand_t Subcommands[] =
+{
+#include "blt-subcommands.h"
+};
+#undef BLT_SUBCOMMAND
+
+#define SUBCOMMAND_COUNT    (sizeof(Subcommands) / sizeof(*Subcommands))
+
+const subcommand_t  *find_subcommand(const char *name);
+#endif
+
+int     blt_pipe(int argc, char *argv[]);
+void    run_stage(char *argv[]);
 
 int     main(int argc,char *argv[])
 
 {
     char    cmd[PATH_MAX + 1];
+    struct stat     inode;
+#ifdef BLT_MULTICALL
+    const subcommand_t  *sub;
+    const char  *name;
+    size_t      c;
+#else
     DIR     *dp;
     struct dirent   *dir_entry;
-    struct stat     inode;
+#endif
+
+#ifdef BLT_MULTICALL
+    // Invoked through a symlink named after a subcommand
+    if ( (name = strrchr(argv[0], '/')) == NULL )
+	name = argv[0];
+    else
+	++name;
+    if ( (sub = find_subcommand(name)) != NULL )
+	return sub->main(argc, argv);
+#endif
     
+    // "blt --profile subcommand ...": see blt-profile.h
+    if ( (argc >= 2) && (strcmp(argv[1], "--profile") == 0) )
+    {
+	setenv("BLT_PROFILE", "1", 1);
+	argv[1] = argv[0];
+	++argv;
+	--argc;
+    }
+
     if ( (argc == 2) && (strcmp(argv[1],"--version") == 0) )
     {
 	printf("%s %s\n", argv[0], VERSION);
@@ -56,9 +142,13 @@ int     main(int argc,char *argv[])
     }
     else if ( argc < 2 )
     {
-	// LIBEXECDIR must be set by Makefile
-	fprintf(stderr, "Usage: %s subcommand [args]\n", argv[0]);
+	fprintf(stderr, "Usage: %s [--profile] subcommand [args]\n", argv[0]);
 	fprintf(stderr, "\nSubcommands:\n\n");
+#ifdef BLT_MULTICALL
+	for (c = 0; c < SUBCOMMAND_COUNT; ++c)
+	    fprintf(stderr, "%s\n", Subcommands[c].name);
+#else
+	// LIBEXECDIR must be set by Makefile
 	if ( (dp = opendir(LIBEXECDIR)) != NULL )
 	{
 	    while ( (dir_entry = readdir(dp)) != NULL )
@@ -69,10 +159,21 @@ int     main(int argc,char *argv[])
 	    }
 	    closedir(dp);
 	}
-	fprintf(stderr, "\nRun \"blt subcommand\" or \"man blt-subcommand\" for more details.\n\n");
+#endif
+	fprintf(stderr, "\nRun \"blt subcommand\" or \"man blt-subcommand\" for more details.\n");
+	fprintf(stderr, "\nRun \"blt pipe subcommand [args] : subcommand [args] ...\" for a pipeline.\n\n");
 	return EX_USAGE;
     }
 
+    if ( strcmp(argv[1], "pipe") == 0 )
+	return blt_pipe(argc - 2, argv + 2);
+
+#ifdef BLT_MULTICALL
+    if ( (sub = find_subcommand(argv[1])) != NULL )
+	return sub->main(argc - 1, argv + 1);
+#endif
+
+    // Scripts such as fastq-derep.sh are always separate
     snprintf(cmd, PATH_MAX, "%s/%s", LIBEXECDIR, argv[1]);
     if ( stat(cmd, &inode) == 0 )
 	execv(cmd, argv + 1);
@@ -82,3 +183,187 @@ int     main(int argc,char *argv[])
 	return EX_USAGE;
     }
 }
+
+
+#ifdef BLT_MULTICALL
+/***************************************************************************
+ *  Description:
+ *      Return the table entry for a subcommand, or NULL if it is not
+ *      linked into this program.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+const subcommand_t  *find_subcommand(const char *name)
+
+{
+    size_t  c;
+
+    for (c = 0; c < SUBCOMMAND_COUNT; ++c)
+	if ( strcmp(Subcommands[c].name, name) == 0 )
+	    return &Subcommands[c];
+    return NULL;
+}
+#endif
+
+
+/***************************************************************************
+ *  Description:
+ *      Run a pipeline of stages separated by ":" arguments, like a shell
+ *      pipeline without the shell.  Each stage is forked and its
+ *      standard input and output connected to its neighbors by pipes,
+ *      except that two or more consecutive subcommands that can run as
+ *      in-process stages (see blt-stage.c) run together in one process,
+ *      passing parsed records instead of text.  If they make up the
+ *      whole pipeline, no process is forked.  Returns the first nonzero
+ *      exit status among the stages, so that a failure anywhere in the
+ *      pipeline is reported.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     blt_pipe(int argc, char *argv[])
+
+{
+    pid_t   pids[MAX_STAGES];
+    char    **stage_argv[MAX_STAGES];
+    int     stage_argc[MAX_STAGES];
+    int     start, arg, stages, group, next, procs, in_fd = -1, fds[2],
+	    wstatus, status = EX_OK;
+
+    if ( (argc == 0) || (strcmp(argv[argc - 1], ":") == 0) )
+    {
+	fputs("Usage: blt pipe subcommand [args] : subcommand [args] ...\n",
+	      stderr);
+	return EX_USAGE;
+    }
+
+    for (start = stages = 0; start < argc; start = arg + 1, ++stages)
+    {
+	for (arg = start; (arg < argc) && (strcmp(argv[arg], ":") != 0); ++arg)
+	    ;
+	if ( (arg == start) || (stages == MAX_STAGES) )
+	{
+	    fprintf(stderr, "blt pipe: Empty stage or more than %d stages.\n",
+		    MAX_STAGES);
+	    return EX_USAGE;
+	}
+	argv[arg] = NULL;   // argv[argc] is already NULL
+	stage_argv[stages] = argv + start;
+	stage_argc[stages] = arg - start;
+    }
+
+    for (group = procs = 0; group < stages; group = next, ++procs)
+    {
+	for (next = group; (next < stages) &&
+			   (blt_stage_find(stage_argv[next][0]) != NULL); ++next)
+	    ;
+	if ( next - group < 2 )
+	    next = group + 1;
+	else if ( (group == 0) && (next == stages) )
+	    return blt_stage_run(stages, stage_argc, stage_argv);
+
+	if ( next < stages )
+	{
+	    if ( pipe(fds) != 0 )
+	    {
+		fprintf(stderr, "blt pipe: Cannot create pipe: %s\n",
+			strerror(errno));
+		return EX_OSERR;
+	    }
+#ifdef F_SETPIPE_SZ
+	    // Fewer context switches between stages; failure is harmless
+	    fcntl(fds[1], F_SETPIPE_SZ, PIPE_BUFF_SIZE);
+#endif
+	}
+
+	if ( (pids[procs] = fork()) == -1 )
+	{
+	    fprintf(stderr, "blt pipe: Cannot fork: %s\n", strerror(errno));
+	    return EX_OSERR;
+	}
+	if ( pids[procs] == 0 )
+	{
+	    if ( in_fd != -1 )
+	    {
+		dup2(in_fd, STDIN_FILENO);
+		close(in_fd);
+	    }
+	    if ( next < stages )
+	    {
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+	    }
+	    if ( next - group > 1 )
+		exit(blt_stage_run(next - group, stage_argc + group,
+				   stage_argv + group));
+	    run_stage(stage_argv[group]);
+	}
+
+	if ( in_fd != -1 )
+	    close(in_fd);
+	if ( next < stages )
+	{
+	    close(fds[1]);
+	    in_fd = fds[0];
+	}
+    }
+
+    for (start = 0; start < procs; ++start)
+    {
+	waitpid(pids[start], &wstatus, 0);
+	if ( status == EX_OK )
+	{
+	    if ( WIFEXITED(wstatus) )
+		status = WEXITSTATUS(wstatus);
+	    else if ( WIFSIGNALED(wstatus) && (WTERMSIG(wstatus) != SIGPIPE) )
+		status = 128 + WTERMSIG(wstatus);
+	}
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Run one pipeline stage, argv terminated by NULL, in a forked
+ *      child.  Does not return.
+ *      blt subcommands are called directly in a multicall build, or
+ *      run from LIBEXECDIR.  Anything else is looked up in PATH, so
+ *      stages such as sort and awk can be mixed with blt subcommands.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    run_stage(char *argv[])
+
+{
+    char    cmd[PATH_MAX + 1];
+    struct stat     inode;
+#ifdef BLT_MULTICALL
+    const subcommand_t  *sub;
+    int     argc;
+
+    if ( (sub = find_subcommand(argv[0])) != NULL )
+    {
+	for (argc = 0; argv[argc] != NULL; ++argc)
+	    ;
+	exit(sub->main(argc, argv));
+    }
+#endif
+
+    snprintf(cmd, PATH_MAX, "%s/%s", LIBEXECDIR, argv[0]);
+    if ( (strchr(argv[0], '/') == NULL) && (stat(cmd, &inode) == 0) )
+	execv(cmd, argv);
+    else
+	execvp(argv[0], argv);
+    fprintf(stderr, "blt pipe: Cannot run %s: %s\n", argv[0], strerror(errno));
+    _exit(EX_UNAVAILABLE);
+}
@@ -5,6 +5,9 @@
  *      risk of getting inaccurate results by accidentally getting
  *      information from a different build/release of the genome.
  *
+ *      A .2bit file from blt fasta-pack on stdin is mapped instead, so
+ *      only the index and one length per sequence are read.
+ *
  *  History: 
  *  Date        Name        Modification
  *  2021-11-28  Jason Bacon Begin
@@ -15,8 +18,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
+#include <inttypes.h>
 #include <biolibc/fasta.h>
+#include "blt-2bit.h"
+#include "blt-zio.h"
+#include "blt-profile.h"
 
+int     chrom_lens_2bit(int fd);
 void    usage(char *argv[]);
 
 int     main(int argc,char *argv[])
@@ -25,7 +34,10 @@ int     main(int argc,char *argv[])
     bl_fasta_t  record;
     char        *p;
     int         status;
+    FILE        *instream;
     
+    PROF_INIT("chrom-lens");
+
     switch(argc)
     {
 	case 1:
@@ -35,12 +47,30 @@ int     main(int argc,char *argv[])
 	    usage(argv);
     }
     
+    if ( blt_2bit_sniff(STDIN_FILENO) )
+	return chrom_lens_2bit(STDIN_FILENO);
+
+    // Decompress gzip or BGZF input on other cores
+    if ( (instream = blt_zopen("-", BLT_ZIO_THREADS_DEFAULT)) == NULL )
+    {
+	fprintf(stderr, "%s: Cannot open input: %s\n", argv[0],
+		strerror(errno));
+	return EX_NOINPUT;
+    }
     bl_fasta_init(&record);
-    while ( (status = bl_fasta_read(&record, stdin)) == BL_READ_OK )
+    PROF_START(t);
+    while ( (status = bl_fasta_read(&record, instream)) == BL_READ_OK )
     {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
+	PROF_BYTES(BL_FASTA_DESC_LEN(&record) + BL_FASTA_SEQ_LEN(&record));
+	PROF_RESTART(t);
 	p = BL_FASTA_DESC(&record) + 1;
 	printf("%s\t%zu\n", strsep(&p, " \t"), strlen(BL_FASTA_SEQ(&record)));
+	PROF_STOP_IO(t, "write");
+	PROF_RESTART(t);
     }
+    blt_zclose(instream);
     if ( status != BL_READ_EOF )
     {
 	fprintf(stderr, "%s: Error reading FASTA stream: %s\n",
@@ -51,6 +81,50 @@ int     main(int argc,char *argv[])
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Print names and lengths from a mapped .2bit file
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     chrom_lens_2bit(int fd)
+
+{
+    blt_2bit_t      *tb;
+    blt_2bit_seq_t  seq;
+    uint32_t        c;
+    int             status = EX_OK;
+
+    if ( (tb = blt_2bit_fdopen(fd)) == NULL )
+    {
+	fprintf(stderr, "chrom-lens: Cannot map .2bit input: %s\n",
+		strerror(errno));
+	return EX_DATAERR;
+    }
+    for (c = 0; (c < tb->count) && (status == EX_OK); ++c)
+    {
+	PROF_RECORDS(1);
+	if ( blt_2bit_seq(tb, c, &seq) == 0 )
+	{
+	    PROF_START(t);
+	    printf("%s\t%" PRIu32 "\n", seq.name, seq.len);
+	    PROF_STOP_IO(t, "write");
+	}
+	else
+	{
+	    fprintf(stderr, "chrom-lens: Corrupt .2bit record for %s.\n",
+		    tb->names[c]);
+	    status = EX_DATAERR;
+	}
+    }
+    blt_2bit_close(tb);
+    return status;
+}
+
+
 void    usage(char *argv[])
 
 {
@@ -2,7 +2,18 @@
  *  Description:
  *      Convert Roman numerals to Arabic in specified columns
  *
- *  History: 
+ *      Input is read in large blocks and each line is examined in place:
+ *      the columns are located with memchr() in one pass and, where they
+ *      hold Roman numerals, the Arabic numbers are spliced into the
+ *      output buffer.  Unchanged text is copied in spans covering as
+ *      many lines as possible, so there is no per-line allocation or
+ *      copying.
+ *
+ *      Canonical numerals up to ROMAN_MAX are looked up in a hash table
+ *      of precomputed conversions.  Anything else starting with a Roman
+ *      numeral character falls back to xt_romantoi().
+ *
+ *  History:
  *  Date        Name        Modification
  *  2022-11-05  Jason Bacon Begin
  ***************************************************************************/
@@ -12,80 +23,465 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
-#include <xtend/dsv.h>
-#include <xtend/string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <xtend/stdlib.h>   // xt_romantoi()
+#include "blt-profile.h"
 
+#define BUFF_SIZE           (1024 * 1024)
 #define MAX_ARABIC_DIGITS   64
+#define MAX_COLS            64
+#define ROMAN_MAX           3999    // MMMCMXCIX
+#define ROMAN_LEN_MAX       15      // MMMDCCCLXXXVIII
+#define ROMAN_SLOTS         8192    // Power of 2, > 2 * ROMAN_MAX
 
+typedef struct
+{
+    char    *buff;
+    size_t  len;
+    int     fd;
+}   out_buff_t;
+
+typedef struct
+{
+    char    roman[ROMAN_LEN_MAX + 1],
+	    arabic[5];
+    uint8_t roman_len,      // 0 = empty slot
+	    arabic_len;
+}   roman_t;
+
+typedef struct
+{
+    int     cols[MAX_COLS];     // 0-based, ascending
+    int     count;
+}   col_list_t;
+
+int     parse_cols(const char *arg, col_list_t *cols);
+void    roman_table_init(void);
+unsigned roman_hash(const char *str, size_t len);
+int     deromanize(int infd, int outfd, col_list_t *cols);
+char    *deromanize_line(char *line, char *eol, char *span, col_list_t *cols,
+			 out_buff_t *out);
+char    *deromanize_field(char *field, char *field_end, char *span,
+			  out_buff_t *out);
+int     out_flush(out_buff_t *out);
+int     out_append(out_buff_t *out, const char *str, size_t len);
 void    usage(char *argv[]);
 
+static roman_t  Roman_table[ROMAN_SLOTS];
+
 int     main(int argc,char *argv[])
 
 {
-    int     col, num, ch;
-    char    *end, *field, arabic[MAX_ARABIC_DIGITS];
-    FILE    *infile = stdin, *outfile = stdout;
-    xt_dsv_line_t  *dsv_line = xt_dsv_line_new();
-    
+    col_list_t  cols;
+    int         infd = STDIN_FILENO;
+
+    PROF_INIT("deromanize");
+
     switch(argc)
     {
 	case 3:
-	    infile = fopen(argv[2], "r");
-	    if ( infile == NULL )
+	    if ( (infd = open(argv[2], O_RDONLY)) == -1 )
 	    {
 		fprintf(stderr, "%s: Cannot open %s: %s\n", argv[0],
 			argv[2], strerror(errno));
 		return EX_DATAERR;
 	    }
 	case 2:
-	    col = strtol(argv[1], &end, 10) - 1;
-	    if ( *end != '\0' )
+	    if ( parse_cols(argv[1], &cols) != 0 )
 		usage(argv);
 	    break;
-	
+
 	default:
 	    usage(argv);
     }
-    
-    xt_dsv_line_init(dsv_line);
-    while ( !feof(infile) )
+
+    roman_table_init();
+    return deromanize(infd, STDOUT_FILENO, &cols);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse a comma-separated list of 1-based column numbers into a
+ *      sorted list of distinct 0-based columns.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     parse_cols(const char *arg, col_list_t *cols)
+
+{
+    const char  *p = arg;
+    char        *end;
+    long        col;
+    int         c, i;
+
+    for (cols->count = 0; ; p = end + 1)
+    {
+	col = strtol(p, &end, 10) - 1;
+	if ( (end == p) || ((*end != ',') && (*end != '\0')) || (col < 0) ||
+	     (col > INT32_MAX) )
+	    return -1;
+
+	// Insertion sort, skipping duplicates
+	for (c = 0; (c < cols->count) && (cols->cols[c] < col); ++c)
+	    ;
+	if ( (c == cols->count) || (cols->cols[c] != col) )
+	{
+	    if ( cols->count == MAX_COLS )
+		return -1;
+	    for (i = cols->count++; i > c; --i)
+		cols->cols[i] = cols->cols[i - 1];
+	    cols->cols[c] = col;
+	}
+	if ( *end == '\0' )
+	    return 0;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fill the hash table with the canonical numerals from 1 to
+ *      ROMAN_MAX and their Arabic equivalents.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    roman_table_init(void)
+
+{
+    static const struct
+    {
+	int         value;
+	const char  *symbols;
+    }   units[] =
+    {
+	{ 1000, "M" }, { 900, "CM" }, { 500, "D" }, { 400, "CD" },
+	{ 100, "C" }, { 90, "XC" }, { 50, "L" }, { 40, "XL" },
+	{ 10, "X" }, { 9, "IX" }, { 5, "V" }, { 4, "IV" }, { 1, "I" }
+    };
+    char        roman[ROMAN_LEN_MAX + 1];
+    size_t      len;
+    unsigned    slot;
+    int         num, rest, u;
+
+    for (num = 1; num <= ROMAN_MAX; ++num)
+    {
+	for (rest = num, len = 0, u = 0; rest > 0; )
+	{
+	    if ( rest >= units[u].value )
+	    {
+		strcpy(roman + len, units[u].symbols);
+		len += strlen(units[u].symbols);
+		rest -= units[u].value;
+	    }
+	    else
+		++u;
+	}
+	for (slot = roman_hash(roman, len); Roman_table[slot].roman_len != 0;
+	     slot = (slot + 1) & (ROMAN_SLOTS - 1))
+	    ;
+	memcpy(Roman_table[slot].roman, roman, len);
+	Roman_table[slot].roman_len = len;
+	Roman_table[slot].arabic_len =
+	    snprintf(Roman_table[slot].arabic, sizeof(Roman_table[slot].arabic),
+		     "%d", num);
+    }
+}
+
+
+unsigned roman_hash(const char *str, size_t len)
+
+{
+    unsigned    hash = 0;
+    size_t      c;
+
+    for (c = 0; c < len; ++c)
+	hash = hash * 31 + (unsigned char)str[c];
+    return hash & (ROMAN_SLOTS - 1);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read input in large blocks and convert complete lines in place.
+ *      A partial line at the end of a block is moved to the front of
+ *      the buffer before the next read, and the buffer is enlarged if
+ *      a single line does not fit.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     deromanize(int infd, int outfd, col_list_t *cols)
+
+{
+    char        *in_buff, *line, *eol, *end, *span, *new_buff;
+    size_t      in_size = BUFF_SIZE, kept = 0;
+    ssize_t     bytes;
+    out_buff_t  out;
+    int         status = EX_OK;
+
+    // One spare byte to terminate a field at the end of the buffer
+    in_buff = malloc(in_size + 1);
+    out.buff = malloc(BUFF_SIZE);
+    if ( (in_buff == NULL) || (out.buff == NULL) )
+    {
+	fputs("deromanize: Could not allocate buffers.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    out.len = 0;
+    out.fd = outfd;
+
+    PROF_START(t);
+    while ( (bytes = read(infd, in_buff + kept, in_size - kept)) > 0 )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(bytes);
+	end = in_buff + kept + bytes;
+	for (line = span = in_buff;
+	     (eol = memchr(line, '\n', end - line)) != NULL; line = eol + 1)
+	    if ( (*line != '#') &&
+		 ((span = deromanize_line(line, eol, span, cols, &out)) == NULL) )
+		return EX_IOERR;
+
+	// Copy unchanged text up to the partial line
+	if ( out_append(&out, span, line - span) != 0 )
+	    return EX_IOERR;
+
+	// Keep partial line for the next read
+	kept = end - line;
+	if ( kept == in_size )
+	{
+	    in_size *= 2;
+	    if ( (new_buff = realloc(in_buff, in_size + 1)) == NULL )
+	    {
+		fputs("deromanize: Could not enlarge input buffer.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    in_buff = new_buff;
+	}
+	else
+	    memmove(in_buff, line, kept);
+	PROF_RESTART(t);
+    }
+    if ( bytes < 0 )
+    {
+	fprintf(stderr, "deromanize: Error reading input: %s\n",
+		strerror(errno));
+	status = EX_IOERR;
+    }
+
+    // Last line with no newline
+    else if ( kept > 0 )
+    {
+	span = in_buff;
+	if ( (*in_buff != '#') &&
+	     ((span = deromanize_line(in_buff, in_buff + kept, span, cols,
+				    &out))
+		== NULL) )
+	    return EX_IOERR;
+	if ( out_append(&out, span, in_buff + kept - span) != 0 )
+	    return EX_IOERR;
+    }
+
+    if ( out_flush(&out) != 0 )
+	status = EX_IOERR;
+    free(in_buff);
+    free(out.buff);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert the listed columns of one line (eol points to the newline
+ *      or end of data) that hold Roman numerals.  Text from span up to
+ *      the first converted column has not yet been copied to the output.
+ *      Returns the new span start, which is unchanged if nothing was
+ *      converted, so runs of unchanged lines are copied in one piece.
+ *      Returns NULL on write errors.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *deromanize_line(char *line, char *eol, char *span, col_list_t *cols,
+			 out_buff_t *out)
+
+{
+    char    *field, *field_end;
+    int     c, col;
+
+    if ( (eol > line) && (eol[-1] == '\r') )
+	--eol;
+    for (c = 0, col = 0, field = line; c < cols->count; ++c, field = field_end + 1)
     {
-	if ( (ch = getc(infile)) == '#' )
+	// Skip to the next listed column
+	for (; col < cols->cols[c]; ++col, ++field)
+	    if ( (field = memchr(field, '\t', eol - field)) == NULL )
+		return span;    // Not enough columns, leave the rest alone
+	if ( (field_end = memchr(field, '\t', eol - field)) == NULL )
+	    field_end = eol;
+	++col;
+	if ( (field_end > field) &&
+	     ((span = deromanize_field(field, field_end, span, out)) == NULL) )
+	    return NULL;
+	if ( field_end == eol )
+	    break;
+    }
+    return span;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      If the field is a Roman numeral, write the text from span up to
+ *      the field and the Arabic number, and return the position after
+ *      the field as the new span start.  Otherwise return span.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *deromanize_field(char *field, char *field_end, char *span,
+			  out_buff_t *out)
+
+{
+    char        *num_end, save, arabic[MAX_ARABIC_DIGITS], *digits;
+    size_t      len = field_end - field;
+    unsigned    slot;
+    int         num, digits_len;
+
+    if ( strchr("IVXLCDMivxlcdm", *field) == NULL )
+	return span;
+
+    digits = NULL;
+    if ( len <= ROMAN_LEN_MAX )
+    {
+	for (slot = roman_hash(field, len); Roman_table[slot].roman_len != 0;
+	     slot = (slot + 1) & (ROMAN_SLOTS - 1))
+	    if ( (Roman_table[slot].roman_len == len) &&
+		 (memcmp(Roman_table[slot].roman, field, len) == 0) )
+	    {
+		digits = Roman_table[slot].arabic;
+		digits_len = Roman_table[slot].arabic_len;
+		break;
+	    }
+    }
+
+    if ( digits == NULL )
+    {
+	// Not canonical: terminate the field temporarily for xt_romantoi()
+	save = *field_end;
+	*field_end = '\0';
+	num = xt_romantoi(field, &num_end);
+	*field_end = save;
+
+	// Convert Roman numerals, leave other data alone
+	if ( num_end != field_end )
+	    return span;
+	digits = arabic;
+	digits_len = snprintf(arabic, MAX_ARABIC_DIGITS, "%d", num);
+    }
+
+    if ( (out_append(out, span, field - span) != 0) ||
+	 (out_append(out, digits, digits_len) != 0) )
+	return NULL;
+    return field_end;
+}
+
+
+int     out_flush(out_buff_t *out)
+
+{
+    char        *p = out->buff;
+    ssize_t     bytes;
+
+    while ( out->len > 0 )
+    {
+	PROF_START(t);
+	bytes = write(out->fd, p, out->len);
+	PROF_STOP_IO(t, "write");
+	if ( bytes < 0 )
 	{
-	    putc(ch, outfile);
-	    while ( ((ch = getc(infile)) != '\n') && (ch != EOF) )
-		putc(ch, outfile);
-	    if ( ch == '\n' )
-		putc(ch, outfile);
+	    if ( errno == EINTR )
+		continue;
+	    fprintf(stderr, "deromanize: Error writing output: %s\n",
+		    strerror(errno));
+	    return -1;
 	}
-	else if ( ch != EOF )
+	p += bytes;
+	out->len -= bytes;
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append a string of arbitrary length to the output buffer,
+ *      flushing as needed.  Large spans are written directly when the
+ *      buffer is empty, avoiding a copy.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     out_append(out_buff_t *out, const char *str, size_t len)
+
+{
+    size_t  chunk;
+    ssize_t bytes;
+
+    while ( len > 0 )
+    {
+	if ( out->len == BUFF_SIZE )
+	    if ( out_flush(out) != 0 )
+		return -1;
+	if ( (out->len == 0) && (len >= BUFF_SIZE) )
 	{
-	    ungetc(ch, infile);
-	    xt_dsv_line_read(dsv_line, infile, "\t");
-	    field = xt_dsv_line_get_fields_ae(dsv_line, col);
-	    if ( field != NULL )
+	    PROF_START(t);
+	    bytes = write(out->fd, str, len);
+	    PROF_STOP_IO(t, "write");
+	    if ( bytes < 0 )
 	    {
-		num = xt_romantoi(field, &end);
-		// Convert Roman numerals, leave other data alone
-		if ( *end == '\0' )
-		{
-		    snprintf(arabic, MAX_ARABIC_DIGITS, "%d", num);
-		    free(xt_dsv_line_get_fields_ae(dsv_line, col));
-		    xt_dsv_line_set_fields_ae(dsv_line, col, strdup(arabic));
-		}
-		xt_dsv_line_write(dsv_line, outfile);
+		if ( errno == EINTR )
+		    continue;
+		fprintf(stderr, "deromanize: Error writing output: %s\n",
+			strerror(errno));
+		return -1;
 	    }
-	    xt_dsv_line_free(dsv_line);
+	    str += bytes;
+	    len -= bytes;
+	    continue;
 	}
+	chunk = BUFF_SIZE - out->len;
+	if ( chunk > len )
+	    chunk = len;
+	memcpy(out->buff + out->len, str, chunk);
+	out->len += chunk;
+	str += chunk;
+	len -= chunk;
     }
-    return EX_OK;
+    return 0;
 }
 
 
 void    usage(char *argv[])
 
 {
-    fprintf(stderr, "Usage: %s column [input-file]\n", argv[0]);
+    fprintf(stderr, "Usage: %s column[,column...] [input-file]\n", argv[0]);
     exit(EX_USAGE);
 }
@@ -3,8 +3,20 @@
  *      Report the gane names for a list of ensembl IDs.  IDs should
  *      be genes, transcripts, or other elements containing both
  *      ID=<ensembl-id> and Name=<gene> in the attributes.
- *  
- *  History: 
+ *
+ *      IDs are loaded into a single arena and indexed by an open
+ *      addressing hash set with case-folded keys.  The GFF3 file is
+ *      then read in large blocks and only column 9 of each feature is
+ *      examined, stopping as soon as ID= and Name= are found.
+ *
+ *      For repeated lookups against the same annotation release,
+ *      --index saves a table of IDs and gene names sorted by case-folded
+ *      ID next to the GFF3 file.  With --table, the table is mmap()ed and
+ *      each ID is found by binary search, with no GFF3 parsing at all.
+ *      The GFF3 size and modification time are recorded in the table so
+ *      that a stale table is detected.
+ *
+ *  History:
  *  Date        Name        Modification
  *  2022-02-21  Jason Bacon Begin
  ***************************************************************************/
@@ -12,90 +24,755 @@
 #include <stdio.h>
 #include <sysexits.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
-#include <xtend/file.h>
-#include <xtend/mem.h>
-#include <xtend/string.h>
-#include <biolibc/gff3.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "blt-profile.h"
 
+#define BUFF_SIZE       (1024 * 1024)
+#define GFF3_COLS       9
+#define E2G_MAGIC       "BLTE2G1"
+#define E2G_EXT         ".e2g"
+
+typedef struct
+{
+    char        *arena;         // ID file contents, null-terminated IDs
+    char        **slots;        // Open addressing, NULL = empty
+    size_t      mask;           // Slot count - 1
+}   id_set_t;
+
+typedef struct
+{
+    char        magic[8];
+    uint64_t    gff3_size;
+    int64_t     gff3_mtime;
+    uint64_t    entry_count,
+		pool_size;
+}   e2g_header_t;
+
+typedef struct
+{
+    uint64_t    id_offset,      // In string pool, null-terminated
+		name_offset,
+		ordinal;        // Position of feature in GFF3 file
+    uint32_t    id_len,
+		name_len;
+}   e2g_entry_t;
+
+typedef struct
+{
+    e2g_entry_t *entries;
+    size_t      count,
+		array_size;
+    char        *pool;
+    size_t      pool_len,
+		pool_size,
+		last_name_offset,
+		last_name_len;
+}   e2g_build_t;
+
+typedef struct
+{
+    e2g_entry_t *entry;
+    char        *listed;
+}   e2g_hit_t;
+
+typedef int (*gff3_visit_t)(void *data, const char *id, size_t id_len,
+			    const char *name, size_t name_len);
+
+int     load_ids(const char *id_file, id_set_t *set);
+uint64_t id_hash(const char *id, size_t len);
+char    *id_find(id_set_t *set, const char *id, size_t len);
+int     gff3_scan(const char *gff3_file, gff3_visit_t visit, void *data);
+int     print_if_listed(void *data, const char *id, size_t id_len,
+			const char *name, size_t name_len);
+int     e2g_build(const char *gff3_file);
+int     add_entry(void *data, const char *id, size_t id_len,
+		  const char *name, size_t name_len);
+int     id_cmp(const char *id1, size_t len1, const char *id2, size_t len2);
+int     entry_cmp(const void *p1, const void *p2);
+int     e2g_query(const char *gff3_file, id_set_t *set);
+int     hit_cmp(const void *p1, const void *p2);
+int     gff3_id_name(char *line, char *end, char **id, size_t *id_len,
+		     char **name, size_t *name_len);
+size_t  strip_name_suffix(const char *name, size_t len);
 void    usage(char *argv[]);
 
+// String pool for entry_cmp(), which qsort() does not pass
+static const char   *Pool;
+
 int     main(int argc,char *argv[])
 
 {
-    char    *gff3_file, *id_file;
-    FILE    *gff3_stream, *id_stream;
-    char    **id_list, *id, *p, **found;
-    size_t  id_count;
-    bl_gff3_t    feature;
-    
-    switch(argc)
+    static char out_buff[BUFF_SIZE];
+    id_set_t    set;
+    int         arg, status;
+    bool        use_table = false;
+
+    PROF_INIT("ensemblid2gene");
+
+    if ( (argc >= 3) && (strcmp(argv[1], "--index") == 0) )
     {
-	case 3:
-	    gff3_file = argv[1];
-	    id_file = argv[2];
-	    break;
-	
-	default:
-	    usage(argv);
+	for (arg = 2; arg < argc; ++arg)
+	    if ( (status = e2g_build(argv[arg])) != EX_OK )
+		return status;
+	return EX_OK;
     }
+    if ( (argc == 4) && (strcmp(argv[1], "--table") == 0) )
+    {
+	use_table = true;
+	++argv;
+    }
+    else if ( argc != 3 )
+	usage(argv);
+
+    if ( (status = load_ids(argv[2], &set)) != EX_OK )
+	return status;
+    setvbuf(stdout, out_buff, _IOFBF, BUFF_SIZE);
+    if ( use_table )
+	status = e2g_query(argv[1], &set);
+    else
+	status = gff3_scan(argv[1], print_if_listed, &set);
+    fflush(stdout);
+    free(set.slots);
+    free(set.arena);
+    return status;
+}
 
-    if ( (id_stream = fopen(id_file, "r")) == NULL )
+
+/***************************************************************************
+ *  Description:
+ *      Read the ID file into one arena, terminate each ID in place,
+ *      and insert it into a hash set at most half full.  Duplicate IDs
+ *      (ignoring case) are stored once.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     load_ids(const char *id_file, id_set_t *set)
+
+{
+    struct stat st;
+    char        *p, *eol, *end;
+    size_t      len, count, slot_count, slot;
+    ssize_t     bytes;
+    int         fd;
+
+    if ( ((fd = open(id_file, O_RDONLY)) == -1) || (fstat(fd, &st) != 0) )
     {
 	fprintf(stderr, "ensemblid2gene: Could not open %s for read.\n",
 		id_file);
-	exit(EX_NOINPUT);
+	return EX_NOINPUT;
+    }
+    if ( (set->arena = malloc(st.st_size + 1)) == NULL )
+    {
+	fputs("ensemblid2gene: Could not allocate ID arena.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    PROF_START(t);
+    for (len = 0; len < (size_t)st.st_size; len += bytes)
+    {
+	if ( (bytes = read(fd, set->arena + len, st.st_size - len)) <= 0 )
+	{
+	    fprintf(stderr, "ensemblid2gene: Error reading %s.\n", id_file);
+	    return EX_IOERR;
+	}
+    }
+    PROF_STOP_IO(t, "read");
+    PROF_BYTES(len);
+    close(fd);
+    end = set->arena + len;
+    *end = '\n';
+
+    // Upper bound on IDs is the number of lines
+    for (p = set->arena, count = 0; p < end; p = eol + 1, ++count)
+	eol = memchr(p, '\n', end + 1 - p);
+    for (slot_count = 16; slot_count < count * 2; slot_count *= 2)
+	;
+    set->mask = slot_count - 1;
+    if ( (set->slots = calloc(slot_count, sizeof(*set->slots))) == NULL )
+    {
+	fputs("ensemblid2gene: Could not allocate ID hash.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    for (p = set->arena; p < end; p = eol + 1)
+    {
+	eol = memchr(p, '\n', end + 1 - p);
+	for (len = eol - p; (len > 0) && isspace((unsigned char)p[len - 1]);
+	     --len)
+	    ;
+	if ( len == 0 )
+	    continue;
+	p[len] = '\0';
+	for (slot = id_hash(p, len) & set->mask; set->slots[slot] != NULL;
+	     slot = (slot + 1) & set->mask)
+	    if ( strcasecmp(set->slots[slot], p) == 0 )
+		break;
+	if ( set->slots[slot] == NULL )
+	    set->slots[slot] = p;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      FNV-1a hash of a case-folded string, so that IDs differing only
+ *      in case land in the same slot.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint64_t id_hash(const char *id, size_t len)
+
+{
+    uint64_t    hash = 0xcbf29ce484222325ULL;
+    size_t      c;
+
+    for (c = 0; c < len; ++c)
+    {
+	hash ^= (unsigned char)tolower((unsigned char)id[c]);
+	hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Look up an ID that is not null-terminated, ignoring case.
+ *      Return the ID as listed in the ID file, or NULL if not present.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *id_find(id_set_t *set, const char *id, size_t len)
+
+{
+    size_t  slot;
+    char    *listed;
+
+    for (slot = id_hash(id, len) & set->mask;
+	 (listed = set->slots[slot]) != NULL; slot = (slot + 1) & set->mask)
+	if ( (strncasecmp(listed, id, len) == 0) && (listed[len] == '\0') )
+	    return listed;
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stream the GFF3 file in large blocks and call visit() with the
+ *      ID and Name of each feature that has both.  A partial line at
+ *      the end of a block is carried over to the next read.  Processing
+ *      stops at a ##FASTA directive.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gff3_scan(const char *gff3_file, gff3_visit_t visit, void *data)
+
+{
+    char        *in_buff, *line, *eol, *end, *new_buff, *id, *name;
+    size_t      in_size = BUFF_SIZE, kept = 0, id_len, name_len;
+    ssize_t     bytes;
+    int         fd, status = EX_OK;
+    bool        fasta = false;
+
+    if ( (fd = open(gff3_file, O_RDONLY)) == -1 )
+    {
+	fprintf(stderr, "ensemblid2gene: Could not open %s for read.\n",
+		gff3_file);
+	return EX_NOINPUT;
+    }
+    if ( (in_buff = malloc(in_size)) == NULL )
+    {
+	fputs("ensemblid2gene: Could not allocate input buffer.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    PROF_START(t);
+    while ( !fasta && (status == EX_OK) &&
+	    (bytes = read(fd, in_buff + kept, in_size - kept)) > 0 )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(bytes);
+	PROF_RESTART(t);
+	end = in_buff + kept + bytes;
+	for (line = in_buff; !fasta && (status == EX_OK) &&
+	     (eol = memchr(line, '\n', end - line)) != NULL; line = eol + 1)
+	{
+	    if ( *line == '#' )
+	    {
+		fasta = (eol - line >= 7) && (memcmp(line, "##FASTA", 7) == 0);
+		continue;
+	    }
+	    PROF_RECORDS(1);
+	    if ( gff3_id_name(line, eol, &id, &id_len, &name, &name_len)
+		    == EX_OK )
+		status = visit(data, id, id_len, name,
+			       strip_name_suffix(name, name_len));
+	}
+	PROF_STOP(t, "scan");
+
+	// Keep partial line for the next read
+	kept = end - line;
+	if ( kept == in_size )
+	{
+	    in_size *= 2;
+	    if ( (new_buff = realloc(in_buff, in_size)) == NULL )
+	    {
+		fputs("ensemblid2gene: Could not enlarge input buffer.\n",
+		      stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    in_buff = new_buff;
+	}
+	else
+	    memmove(in_buff, line, kept);
+	PROF_RESTART(t);
+    }
+    if ( fasta || (status != EX_OK) )
+	kept = 0;
+    else if ( bytes < 0 )
+    {
+	fprintf(stderr, "ensemblid2gene: Error reading %s: %s\n", gff3_file,
+		strerror(errno));
+	status = EX_IOERR;
+    }
+
+    // Last line with no newline
+    if ( (kept > 0) && (*in_buff != '#') &&
+	 (gff3_id_name(in_buff, in_buff + kept, &id, &id_len,
+		       &name, &name_len) == EX_OK) )
+	status = visit(data, id, id_len, name,
+		       strip_name_suffix(name, name_len));
+
+    close(fd);
+    free(in_buff);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      gff3_scan() visitor: print the listed ID and gene name if the
+ *      feature ID is in the set.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     print_if_listed(void *data, const char *id, size_t id_len,
+			const char *name, size_t name_len)
+
+{
+    char    *listed;
+
+    if ( (listed = id_find(data, id, id_len)) != NULL )
+	printf("%s\t%.*s\n", listed, (int)name_len, name);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Build a lookup table for a GFF3 file and save it as
+ *      file.gff3.e2g.  The table holds one entry per feature with ID=
+ *      and Name=, sorted by case-folded ID, and a string pool of IDs
+ *      and gene names with the -### suffix already removed.  Runs of
+ *      features sharing a name (a gene and its transcripts) share one
+ *      copy in the pool.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     e2g_build(const char *gff3_file)
+
+{
+    char        table_file[PATH_MAX + 1], tmp_file[PATH_MAX + 8];
+    struct stat st;
+    e2g_header_t    header;
+    e2g_build_t build;
+    FILE        *out;
+    int         status;
+
+    if ( stat(gff3_file, &st) != 0 )
+    {
+	fprintf(stderr, "ensemblid2gene: Could not open %s for read.\n",
+		gff3_file);
+	return EX_NOINPUT;
     }
-    id_count = xt_inhale_strings(id_stream, &id_list);
-    fclose(id_stream);
-    qsort(id_list, id_count, sizeof(*id_list), (int(*)(const void *,const void*))xt_strptrcmp);
-    if ( (gff3_stream = fopen(gff3_file, "r")) == NULL )
+    memset(&build, 0, sizeof(build));
+    if ( (status = gff3_scan(gff3_file, add_entry, &build)) != EX_OK )
+	return status;
+
+    Pool = build.pool;
+    PROF_START(t);
+    qsort(build.entries, build.count, sizeof(*build.entries), entry_cmp);
+    PROF_STOP(t, "sort");
+
+    snprintf(table_file, PATH_MAX, "%s%s", gff3_file, E2G_EXT);
+    snprintf(tmp_file, PATH_MAX + 8, "%s.tmp", table_file);
+    if ( (out = fopen(tmp_file, "w")) == NULL )
+    {
+	fprintf(stderr, "ensemblid2gene: Cannot create %s: %s\n",
+		tmp_file, strerror(errno));
+	return EX_CANTCREAT;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, E2G_MAGIC, sizeof(header.magic));
+    header.gff3_size = st.st_size;
+    header.gff3_mtime = st.st_mtime;
+    header.entry_count = build.count;
+    header.pool_size = build.pool_len;
+    PROF_RESTART(t);
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(build.entries, sizeof(*build.entries), build.count, out);
+    fwrite(build.pool, build.pool_len, 1, out);
+    status = fclose(out);
+    PROF_STOP_IO(t, "write");
+    if ( (status != 0) || (rename(tmp_file, table_file) != 0) )
+    {
+	fprintf(stderr, "ensemblid2gene: Error writing %s: %s\n",
+		table_file, strerror(errno));
+	unlink(tmp_file);
+	return EX_IOERR;
+    }
+
+    fprintf(stderr, "ensemblid2gene: Saved %zu IDs in %s.\n",
+	    build.count, table_file);
+    free(build.entries);
+    free(build.pool);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      gff3_scan() visitor: add an ID and name to the table being built.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     add_entry(void *data, const char *id, size_t id_len,
+		  const char *name, size_t name_len)
+
+{
+    e2g_build_t *build = data;
+    e2g_entry_t *entry;
+    void        *p;
+
+    if ( build->count == build->array_size )
+    {
+	build->array_size = build->array_size == 0 ? 65536 :
+			    build->array_size * 2;
+	p = realloc(build->entries, build->array_size * sizeof(*build->entries));
+	if ( p == NULL )
+	{
+	    fputs("ensemblid2gene: Could not allocate table.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+	build->entries = p;
+    }
+    if ( build->pool_len + id_len + name_len + 2 > build->pool_size )
+    {
+	build->pool_size = build->pool_size == 0 ? 1024 * 1024 :
+			   build->pool_size * 2;
+	if ( build->pool_size < build->pool_len + id_len + name_len + 2 )
+	    build->pool_size = build->pool_len + id_len + name_len + 2;
+	if ( (p = realloc(build->pool, build->pool_size)) == NULL )
+	{
+	    fputs("ensemblid2gene: Could not allocate string pool.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+	build->pool = p;
+    }
+
+    entry = &build->entries[build->count];
+    entry->ordinal = build->count++;
+    entry->id_offset = build->pool_len;
+    entry->id_len = id_len;
+    memcpy(build->pool + build->pool_len, id, id_len);
+    build->pool[build->pool_len + id_len] = '\0';
+    build->pool_len += id_len + 1;
+
+    if ( (build->last_name_len != name_len) ||
+	 (memcmp(build->pool + build->last_name_offset, name, name_len) != 0) )
+    {
+	build->last_name_offset = build->pool_len;
+	build->last_name_len = name_len;
+	memcpy(build->pool + build->pool_len, name, name_len);
+	build->pool[build->pool_len + name_len] = '\0';
+	build->pool_len += name_len + 1;
+    }
+    entry->name_offset = build->last_name_offset;
+    entry->name_len = name_len;
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compare strings ignoring case, with lengths, so that the table
+ *      order matches lookups of IDs that are not null-terminated.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     id_cmp(const char *id1, size_t len1, const char *id2, size_t len2)
+
+{
+    int     status;
+
+    if ( (status = strncasecmp(id1, id2, len1 < len2 ? len1 : len2)) != 0 )
+	return status;
+    return (len1 > len2) - (len1 < len2);
+}
+
+
+int     entry_cmp(const void *p1, const void *p2)
+
+{
+    const e2g_entry_t   *e1 = p1, *e2 = p2;
+    int     status;
+
+    if ( (status = id_cmp(Pool + e1->id_offset, e1->id_len,
+			  Pool + e2->id_offset, e2->id_len)) != 0 )
+	return status;
+    return (e1->ordinal > e2->ordinal) - (e1->ordinal < e2->ordinal);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Look up listed IDs in the mmap()ed table for a GFF3 file,
+ *      rather than scanning the GFF3 file.  Output is the same as a
+ *      scan: one line per matching feature, in GFF3 order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     e2g_query(const char *gff3_file, id_set_t *set)
+
+{
+    char            table_file[PATH_MAX + 1];
+    struct stat     gff3_st, table_st;
+    e2g_header_t    *h;
+    e2g_entry_t     *entries;
+    const char      *pool;
+    e2g_hit_t       *hits;
+    size_t          hit_count = 0, hit_array_size, slot, lo, hi, mid, len;
+    void            *map, *p;
+    int             fd;
+
+    snprintf(table_file, PATH_MAX, "%s%s", gff3_file, E2G_EXT);
+    if ( stat(gff3_file, &gff3_st) != 0 )
     {
 	fprintf(stderr, "ensemblid2gene: Could not open %s for read.\n",
 		gff3_file);
-	exit(EX_NOINPUT);
+	return EX_NOINPUT;
+    }
+    if ( ((fd = open(table_file, O_RDONLY)) == -1) ||
+	 (fstat(fd, &table_st) != 0) )
+    {
+	fprintf(stderr, "ensemblid2gene: Run \"blt ensemblid2gene --index %s\" first.\n",
+		gff3_file);
+	return EX_NOINPUT;
     }
-    bl_gff3_skip_header(gff3_stream);
-    
-    bl_gff3_init(&feature);
-    while ( bl_gff3_read(&feature, gff3_stream, BL_GFF3_FIELD_ALL) == BL_READ_OK )
+    map = mmap(NULL, table_st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    h = map;
+    if ( (map == MAP_FAILED) || ((size_t)table_st.st_size < sizeof(*h)) ||
+	 (memcmp(h->magic, E2G_MAGIC, sizeof(h->magic)) != 0) ||
+	 ((size_t)table_st.st_size != sizeof(*h) +
+	    h->entry_count * sizeof(*entries) + h->pool_size) )
     {
-	//printf("%s ", BL_GFF3_FEATURE_NAME(&feature));
-	//fflush(stdout);
-	id = BL_GFF3_FEATURE_ID(&feature);
-	if ( id != NULL )
+	fprintf(stderr, "ensemblid2gene: %s is not a valid table.\n",
+		table_file);
+	return EX_DATAERR;
+    }
+    if ( (h->gff3_size != (uint64_t)gff3_st.st_size) ||
+	 (h->gff3_mtime != (int64_t)gff3_st.st_mtime) )
+    {
+	fprintf(stderr, "ensemblid2gene: %s is out of date.  Run \"blt ensemblid2gene --index %s\".\n",
+		table_file, gff3_file);
+	return EX_DATAERR;
+    }
+    entries = (e2g_entry_t *)(h + 1);
+    pool = (const char *)(entries + h->entry_count);
+
+    // Collect matching entries for each distinct listed ID
+    PROF_START(t);
+    hit_array_size = set->mask + 1;
+    if ( (hits = malloc(hit_array_size * sizeof(*hits))) == NULL )
+    {
+	fputs("ensemblid2gene: Could not allocate hits.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    for (slot = 0; slot <= set->mask; ++slot)
+    {
+	if ( set->slots[slot] == NULL )
+	    continue;
+	len = strlen(set->slots[slot]);
+
+	// Lower bound: first entry >= ID
+	for (lo = 0, hi = h->entry_count; lo < hi; )
+	{
+	    mid = lo + (hi - lo) / 2;
+	    if ( id_cmp(pool + entries[mid].id_offset, entries[mid].id_len,
+			set->slots[slot], len) < 0 )
+		lo = mid + 1;
+	    else
+		hi = mid;
+	}
+	for (; (lo < h->entry_count) &&
+	       (id_cmp(pool + entries[lo].id_offset, entries[lo].id_len,
+		       set->slots[slot], len) == 0); ++lo)
 	{
-	    // GFF ID format is  ID=feature-type:feature-id
-	    // E.g. ID=gene:ENS00000000
-	    if ( (p = strchr(id, ':')) != NULL )
-		id = p + 1;
-	
-	    // Find ID in the list matching this feature's ID= attribute
-	    // Name= should then contain the gene name, assuming this ID
-	    // is for a transcript or gene as it should be
-	    found = bsearch(&id, id_list, id_count, sizeof(*id_list),
-		    (int (*)(const void *, const void *))xt_strptrcasecmp);
-	    
-	    // Print feature name without trailing -###
-	    if ( found != NULL )
+	    // Only duplicate IDs in the GFF3 can exceed one hit per slot
+	    if ( hit_count == hit_array_size )
 	    {
-		p = BL_GFF3_FEATURE_NAME(&feature);
-		printf("%s\t%s\n", *found, strsep(&p, "-"));
-		if ( p != NULL )
-		    p[-1] = '-';
+		hit_array_size *= 2;
+		if ( (p = realloc(hits, hit_array_size * sizeof(*hits))) == NULL )
+		{
+		    fputs("ensemblid2gene: Could not allocate hits.\n", stderr);
+		    return EX_UNAVAILABLE;
+		}
+		hits = p;
 	    }
+	    hits[hit_count].entry = &entries[lo];
+	    hits[hit_count++].listed = set->slots[slot];
 	}
     }
-    fclose(gff3_stream);
 
-    xt_free_strings(id_list);
+    qsort(hits, hit_count, sizeof(*hits), hit_cmp);
+    PROF_STOP(t, "lookup");
+    PROF_RECORDS(hit_count);
+
+    PROF_RESTART(t);
+    for (slot = 0; slot < hit_count; ++slot)
+	printf("%s\t%.*s\n", hits[slot].listed, (int)hits[slot].entry->name_len,
+	       pool + hits[slot].entry->name_offset);
+    PROF_STOP_IO(t, "write");
+
+    free(hits);
+    munmap(map, table_st.st_size);
     return EX_OK;
 }
 
 
+int     hit_cmp(const void *p1, const void *p2)
+
+{
+    const e2g_hit_t *h1 = p1, *h2 = p2;
+
+    return (h1->entry->ordinal > h2->entry->ordinal) -
+	   (h1->entry->ordinal < h2->entry->ordinal);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Locate the ID (without the feature-type: prefix, e.g. gene:) and
+ *      Name attributes in column 9 of a GFF3 line, without copying.
+ *      Scanning stops as soon as both are found.  Returns EX_DATAERR
+ *      if either is missing.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gff3_id_name(char *line, char *end, char **id, size_t *id_len,
+		     char **name, size_t *name_len)
+
+{
+    char    *p, *val_end, *colon;
+    int     c;
+
+    if ( (end > line) && (end[-1] == '\r') )
+	--end;
+    for (c = 1, p = line; c < GFF3_COLS; ++c, ++p)
+	if ( (p = memchr(p, '\t', end - p)) == NULL )
+	    return EX_DATAERR;
+
+    *id = *name = NULL;
+    for (; (p < end) && ((*id == NULL) || (*name == NULL)); p = val_end + 1)
+    {
+	if ( (val_end = memchr(p, ';', end - p)) == NULL )
+	    val_end = end;
+	if ( (*p == 'I') && (p[1] == 'D') && (p[2] == '=') )
+	{
+	    // GFF ID format is ID=feature-type:feature-id, e.g. gene:ENSG...
+	    *id = p + 3;
+	    if ( (colon = memchr(*id, ':', val_end - *id)) != NULL )
+		*id = colon + 1;
+	    *id_len = val_end - *id;
+	}
+	else if ( (val_end - p > 5) && (memcmp(p, "Name=", 5) == 0) )
+	{
+	    *name = p + 5;
+	    *name_len = val_end - *name;
+	}
+    }
+    return (*id != NULL) && (*name != NULL) ? EX_OK : EX_DATAERR;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return the length of a name without a trailing -### suffix,
+ *      as in transcript names such as TP53-201.  Other hyphens, as in
+ *      HLA-A or NKX2-1, are part of the gene name.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  strip_name_suffix(const char *name, size_t len)
+
+{
+    if ( (len > 4) && (name[len - 4] == '-') &&
+	 isdigit((unsigned char)name[len - 3]) &&
+	 isdigit((unsigned char)name[len - 2]) &&
+	 isdigit((unsigned char)name[len - 1]) )
+	return len - 4;
+    return len;
+}
+
+
 void    usage(char *argv[])
 
 {
-    fprintf(stderr, "Usage: %s file.gff ensembl-id-list.txt\n", argv[0]);
+    fprintf(stderr, "Usage: %s [--table] file.gff ensembl-id-list.txt\n", argv[0]);
+    fprintf(stderr, "       %s --index file.gff [file.gff ...]\n", argv[0]);
     exit(EX_USAGE);
 }
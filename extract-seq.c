@@ -6,6 +6,10 @@
  *      If the feature type is "gene" or "mRNA", a recursive search of the
  *      GFF structure for subfeatures is automatically performed.
  *
+ *      If the reference is a .2bit file from blt fasta-pack, it is mapped
+ *      once and only the bases of each feature are decoded, instead of
+ *      re-reading the FASTA up to the chromosome for every hit.
+ *
  *  History: 
  *  Date        Name        Modification
  *  2021-10-28  Jason Bacon Begin
@@ -21,15 +25,22 @@
 #include <string.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <biolibc/gff3.h>
 #include <biolibc/fasta.h>
-#include <xtend/file.h>
+#include "blt-2bit.h"
+#include "blt-zio.h"
+#include "blt-profile.h"
 
 #define KEY_MAX     1024
 
-int     print_subfeatures(bl_fasta_t *fasta_rec, bl_gff3_t *feature,
-			  FILE *gff3_stream, const char *description);
+int     print_subfeatures(bl_fasta_t *fasta_rec, blt_2bit_seq_t *packed_seq,
+			  bl_gff3_t *feature, FILE *gff3_stream,
+			  const char *description);
 void    print_seq(char *feature_seq, int64_t start, int64_t end);
+void    print_packed_seq(blt_2bit_seq_t *packed_seq, int64_t start,
+			 int64_t end);
 void    usage(char *argv[]);
 
 int     main(int argc,char *argv[])
@@ -44,13 +55,18 @@ int     main(int argc,char *argv[])
 		*description,
 		*gff3_chrom,
 		*fasta_chrom;
-    int         status;
+    int         status, fd;
     size_t      chrom_len;
     int64_t     start, end;
+    long        index;
     bl_gff3_t    feature;
     bl_fasta_t  fasta_rec = BL_FASTA_INIT;
+    blt_2bit_t  *packed_ref = NULL;
+    blt_2bit_seq_t  packed_seq;
     bool        found_chrom;
 
+    PROF_INIT("extract-seq");
+
     switch(argc)
     {
 	case 5:
@@ -65,8 +81,24 @@ int     main(int argc,char *argv[])
 	    return EX_USAGE;    // Useless but to silence compiler warning
     }
     
+    // Map a .2bit reference once for all hits
+    if ( (fd = open(fasta_file, O_RDONLY)) == -1 )
+    {
+	fprintf(stderr, "%s: Cannot open %s: %s\n", argv[0], fasta_file,
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( blt_2bit_sniff(fd) && ((packed_ref = blt_2bit_fdopen(fd)) == NULL) )
+    {
+	fprintf(stderr, "%s: Cannot map %s: %s\n", argv[0], fasta_file,
+		strerror(errno));
+	return EX_DATAERR;
+    }
+    close(fd);
+
     // FIXME: Limit field input
-    if ( (gff3_stream = xt_fopen(gff3_file, "r")) == NULL )
+    gff3_stream = blt_zopen(gff3_file, BLT_ZIO_THREADS_DEFAULT);
+    if ( gff3_stream == NULL )
     {
 	fprintf(stderr, "%s: Cannot open %s: %s\n", argv[0], gff3_file,
 		strerror(errno));
@@ -82,9 +114,13 @@ int     main(int argc,char *argv[])
     // printf("Searching %s for %s %s\n", argv[1], primary_feature_type, feature_name);
     bl_gff3_init(&feature);
     description = search_key;
+    PROF_START(t);
     while ( (status = bl_gff3_read(&feature, gff3_stream, BL_GFF3_FIELD_ALL))
 		== BL_READ_OK )
     {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
+	PROF_RESTART(t);
 	if ( (strcasecmp(BL_GFF3_TYPE(&feature), primary_feature_type) == 0) &&
 	     (strcasestr(BL_GFF3_ATTRIBUTES(&feature), search_key) != NULL) )
 	{
@@ -112,10 +148,36 @@ int     main(int argc,char *argv[])
 		    gff3_chrom, start, end, primary_feature_type, search_key, 
 		    BL_GFF3_ATTRIBUTES(&feature), gff3_file, fasta_file);
 
+	    if ( packed_ref != NULL )
+	    {
+		index = blt_2bit_find(packed_ref, gff3_chrom);
+		if ( index == -1 )
+		{
+		    PROF_STOP(t, "extract");
+		    PROF_RESTART(t);
+		    continue;
+		}
+		if ( blt_2bit_seq(packed_ref, index, &packed_seq) != 0 )
+		{
+		    fprintf(stderr, "%s: Corrupt .2bit record for %s.\n",
+			    argv[0], gff3_chrom);
+		    return EX_DATAERR;
+		}
+		print_packed_seq(&packed_seq, start, end);
+		if ( (strcmp(primary_feature_type, "gene") == 0) ||
+		     (strcmp(primary_feature_type, "transcript") == 0) )
+		    print_subfeatures(NULL, &packed_seq, &feature,
+				      gff3_stream, description);
+		PROF_STOP(t, "extract");
+		PROF_RESTART(t);
+		continue;
+	    }
+
 	    // GFFs are sorted lexically and FASTAs numerically
 	    // so for now we re-read the FASTA from the beginning for
 	    // each hit.
-	    if ( (fasta_stream = xt_fopen(fasta_file, "r")) == NULL )
+	    fasta_stream = blt_zopen(fasta_file, BLT_ZIO_THREADS_DEFAULT);
+	    if ( fasta_stream == NULL )
 	    {
 		fprintf(stderr, "%s: Cannot open %s: %s\n", argv[0], fasta_file,
 			strerror(errno));
@@ -138,14 +200,19 @@ int     main(int argc,char *argv[])
 		    // FIXME: Other feature types with subfeatures?
 		    if ( (strcmp(primary_feature_type, "gene") == 0) ||
 			 (strcmp(primary_feature_type, "transcript") == 0) )
-			print_subfeatures(&fasta_rec, &feature, gff3_stream,
-					  description);
+			print_subfeatures(&fasta_rec, NULL, &feature,
+					  gff3_stream, description);
 		}
 	    }
-	    fclose(fasta_stream);
+	    blt_zclose(fasta_stream);
 	}
+	PROF_STOP(t, "extract");
+	PROF_RESTART(t);
     }
-    fclose(gff3_stream);
+    PROF_STREAM_BYTES(gff3_stream);
+    blt_zclose(gff3_stream);
+    if ( packed_ref != NULL )
+	blt_2bit_close(packed_ref);
     
     return EX_OK;
 }
@@ -153,15 +220,17 @@ int     main(int argc,char *argv[])
 
 /***************************************************************************
  *  Description:
- *      Recursively output subfeatures of the given feature
+ *      Recursively output subfeatures of the given feature, from
+ *      fasta_rec or, if it is NULL, from packed_seq
  *
  *  History: 
  *  Date        Name        Modification
  *  2022-04-12  Jason Bacon Begin
  ***************************************************************************/
 
-int     print_subfeatures(bl_fasta_t *fasta_rec, bl_gff3_t *feature,
-			  FILE *gff3_stream, const char *description)
+int     print_subfeatures(bl_fasta_t *fasta_rec, blt_2bit_seq_t *packed_seq,
+			  bl_gff3_t *feature, FILE *gff3_stream,
+			  const char *description)
 
 {
     int     status, index;
@@ -189,13 +258,18 @@ int     print_subfeatures(bl_fasta_t *fasta_rec, bl_gff3_t *feature,
 		BL_GFF3_TYPE(feature),
 		BL_GFF3_ATTRIBUTES(feature));
 	
-	print_seq(BL_FASTA_SEQ(fasta_rec),
-		  BL_GFF3_START(feature), BL_GFF3_END(feature));
+	if ( fasta_rec != NULL )
+	    print_seq(BL_FASTA_SEQ(fasta_rec),
+		      BL_GFF3_START(feature), BL_GFF3_END(feature));
+	else
+	    print_packed_seq(packed_seq,
+			     BL_GFF3_START(feature), BL_GFF3_END(feature));
 	
 	// Recurse from gene -> transcript -> exon, etc.
 	if ( (strcmp(BL_GFF3_TYPE(feature), "gene") == 0) ||
 	     (strcmp(BL_GFF3_TYPE(feature), "mRNA") == 0) )
-	    status = print_subfeatures(fasta_rec, feature, gff3_stream, description);
+	    status = print_subfeatures(fasta_rec, packed_seq, feature,
+				       gff3_stream, description);
 	else
 	    status = bl_gff3_read(feature, gff3_stream, BL_GFF3_FIELD_ALL);
     }
@@ -229,10 +303,54 @@ void    print_seq(char *feature_seq, int64_t start, int64_t end)
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Decode and print bases start to end (1-based, inclusive) of a
+ *      mapped .2bit sequence
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    print_packed_seq(blt_2bit_seq_t *packed_seq, int64_t start,
+			 int64_t end)
+
+{
+    static char     *buff = NULL;
+    static size_t   buff_size = 0;
+    char            *new_buff;
+    size_t          feature_len;
+
+    if ( (start < 1) || (end > packed_seq->len) || (start > end) )
+    {
+	fprintf(stderr, "extract-seq: %" PRId64 "-%" PRId64
+		" is outside %s (length %" PRIu32 ").\n",
+		start, end, packed_seq->name, packed_seq->len);
+	putchar('\n');
+	return;
+    }
+    feature_len = end - start + 1;
+    if ( feature_len + 1 > buff_size )
+    {
+	if ( (new_buff = realloc(buff, feature_len + 1)) == NULL )
+	{
+	    fputs("extract-seq: Could not allocate sequence buffer.\n", stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+	buff = new_buff;
+	buff_size = feature_len + 1;
+    }
+    blt_2bit_decode(packed_seq, start - 1, end, buff);
+    buff[feature_len] = '\0';
+    puts(buff);
+}
+
+
 void    usage(char *argv[])
 
 {
-    fprintf(stderr, "\nUsage: %s file.gff3 file.fasta[.gz|.bz2|.xz] feature-type 'search-key'\n\n", argv[0]);
+    fprintf(stderr, "\nUsage: %s file.gff3 file.fasta[.gz|.bz2|.xz]|file.2bit feature-type 'search-key'\n\n", argv[0]);
     fprintf(stderr, "Search-key is any exact substring of the attributes column in the GFF.\n");
     fprintf(stderr, "To match a gene name exactly, include ';' in the search key. e.g. 'Name=jun;'\n");
     fprintf(stderr, "View your GFF file with \"more file.gff3\" to get ideas for search-key.\n");
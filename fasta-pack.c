@@ -0,0 +1,509 @@
+/***************************************************************************
+ *  Description:
+ *      Convert a FASTA reference to UCSC .2bit format, which chrom-lens,
+ *      extract-seq, and fasta2seq map into memory instead of parsing
+ *      the FASTA on every run.
+ *
+ *      Bases are packed 4 per byte, runs of N (or any base other than
+ *      ACGT) and runs of lower-case (soft-masked) bases are stored as
+ *      lists, so the original sequence is restored exactly apart from
+ *      ambiguity codes, which become N, and U, which becomes T.
+ *      Sequence names are the first word of each description.
+ *
+ *      Input is streamed through a fixed buffer, and only one sequence
+ *      is held in memory at a time, packed.  The index at the start of
+ *      the file depends on every name, so packed records are spooled to
+ *      a temporary file and copied after the index.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "blt-2bit.h"
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+#define BUFF_SIZE   (1024 * 1024)
+
+typedef struct
+{
+    uint32_t    *starts;
+    uint32_t    *sizes;
+    uint32_t    count;
+    uint32_t    array_size;
+}   block_list_t;
+
+typedef struct
+{
+    char            name[BLT_2BIT_NAME_MAX + 1];
+    size_t          name_len;
+    unsigned char   *dna;
+    size_t          dna_array_size;
+    uint64_t        len;
+    unsigned        packed;
+    bool            in_n, in_mask;
+    uint32_t        n_start, mask_start;
+    block_list_t    n_blocks, mask_blocks;
+}   seq_t;
+
+typedef struct
+{
+    char        **names;
+    uint64_t    *offsets;
+    uint32_t    count;
+    uint32_t    array_size;
+}   index_t;
+
+int     fasta_pack(FILE *instream, FILE *outstream);
+int     seq_add_base(seq_t *seq, int code, bool lower);
+int     seq_finish(seq_t *seq, FILE *spool, uint64_t *spool_len,
+		   index_t *index);
+int     block_add(block_list_t *list, uint32_t start, uint32_t end);
+int     write_index(index_t *index, FILE *spool, uint64_t spool_len,
+		    FILE *outstream);
+void    put32(FILE *stream, uint32_t val);
+void    usage(char *argv[]);
+
+int     main(int argc,char *argv[])
+
+{
+    FILE    *instream;
+    int     status;
+
+    PROF_INIT("fasta-pack");
+
+    if ( argc != 1 )
+	usage(argv);
+
+    if ( (instream = blt_zopen("-", BLT_ZIO_THREADS_DEFAULT)) == NULL )
+    {
+	fprintf(stderr, "fasta-pack: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    status = fasta_pack(instream, stdout);
+    blt_zclose(instream);
+    if ( (fflush(stdout) != 0) && (status == EX_OK) )
+    {
+	fprintf(stderr, "fasta-pack: Error writing output: %s\n",
+		strerror(errno));
+	status = EX_IOERR;
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Pack every sequence from instream and write the .2bit file to
+ *      outstream.  State is carried across buffer boundaries as in
+ *      fasta2seq, so lines may be of any length.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fasta_pack(FILE *instream, FILE *outstream)
+
+{
+    static char     buff[BUFF_SIZE];
+    static int8_t   codes[256];
+    static seq_t    seq;
+    index_t         index = { NULL, NULL, 0, 0 };
+    FILE            *spool;
+    char            *p, *end;
+    size_t          bytes;
+    uint64_t        spool_len = 0;
+    bool            line_start = true, in_desc = false, in_name = false,
+		    have_seq = false;
+    int             code, status = EX_OK, ch;
+
+    // Base -> .2bit code, 4 for N and other letters, -1 to skip
+    memset(codes, -1, sizeof(codes));
+    for (ch = 'A'; ch <= 'Z'; ++ch)
+	codes[ch] = codes[ch | 0x20] = 4;
+    codes['T'] = codes['t'] = codes['U'] = codes['u'] = 0;
+    codes['C'] = codes['c'] = 1;
+    codes['A'] = codes['a'] = 2;
+    codes['G'] = codes['g'] = 3;
+
+    if ( (spool = tmpfile()) == NULL )
+    {
+	fprintf(stderr, "fasta-pack: Cannot create temporary file: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+
+    PROF_START(t);
+    while ( (status == EX_OK) &&
+	    ((bytes = fread(buff, 1, BUFF_SIZE, instream)) > 0) )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(bytes);
+	end = buff + bytes;
+	for (p = buff; (p < end) && (status == EX_OK); ++p)
+	{
+	    if ( *p == '\n' )
+	    {
+		line_start = true;
+		in_desc = in_name = false;
+		continue;
+	    }
+	    if ( line_start && (*p == '>') )
+	    {
+		if ( have_seq )
+		    status = seq_finish(&seq, spool, &spool_len, &index);
+		have_seq = in_desc = in_name = true;
+		seq.name_len = 0;
+		*seq.name = '\0';
+		line_start = false;
+		continue;
+	    }
+	    line_start = false;
+	    if ( in_desc )
+	    {
+		if ( in_name && ((*p == ' ') || (*p == '\t') || (*p == '\r')) )
+		    in_name = false;
+		else if ( in_name )
+		{
+		    if ( seq.name_len == BLT_2BIT_NAME_MAX )
+		    {
+			fprintf(stderr, "fasta-pack: Sequence name longer "
+				"than %d characters.\n", BLT_2BIT_NAME_MAX);
+			status = EX_DATAERR;
+		    }
+		    else
+		    {
+			seq.name[seq.name_len++] = *p;
+			seq.name[seq.name_len] = '\0';
+		    }
+		}
+	    }
+	    else if ( (code = codes[(unsigned char)*p]) >= 0 )
+	    {
+		if ( !have_seq )
+		{
+		    fputs("fasta-pack: Input is not FASTA.\n", stderr);
+		    status = EX_DATAERR;
+		}
+		else
+		    status = seq_add_base(&seq, code, *p & 0x20);
+	    }
+	}
+	PROF_RESTART(t);
+    }
+    if ( ferror(instream) )
+    {
+	fprintf(stderr, "fasta-pack: Error reading input: %s\n",
+		strerror(errno));
+	status = EX_IOERR;
+    }
+    if ( (status == EX_OK) && have_seq )
+	status = seq_finish(&seq, spool, &spool_len, &index);
+    if ( status == EX_OK )
+	status = write_index(&index, spool, spool_len, outstream);
+
+    fclose(spool);
+    free(seq.dna);
+    free(seq.n_blocks.starts);
+    free(seq.n_blocks.sizes);
+    free(seq.mask_blocks.starts);
+    free(seq.mask_blocks.sizes);
+    while ( index.count > 0 )
+	free(index.names[--index.count]);
+    free(index.names);
+    free(index.offsets);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append one base, packing it and extending the N and mask runs
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     seq_add_base(seq_t *seq, int code, bool lower)
+
+{
+    unsigned char   *new_dna;
+    bool            is_n = code == 4;
+
+    if ( seq->len == UINT32_MAX )
+    {
+	fprintf(stderr, "fasta-pack: %s is longer than %u bases.\n",
+		seq->name, UINT32_MAX);
+	return EX_DATAERR;
+    }
+    if ( is_n != seq->in_n )
+    {
+	if ( is_n )
+	    seq->n_start = seq->len;
+	else if ( block_add(&seq->n_blocks, seq->n_start, seq->len) != 0 )
+	    return EX_UNAVAILABLE;
+	seq->in_n = is_n;
+    }
+    if ( lower != seq->in_mask )
+    {
+	if ( lower )
+	    seq->mask_start = seq->len;
+	else if ( block_add(&seq->mask_blocks, seq->mask_start,
+			    seq->len) != 0 )
+	    return EX_UNAVAILABLE;
+	seq->in_mask = lower;
+    }
+
+    // N is stored as T (0) under its N block
+    seq->packed = (seq->packed << 2) | (is_n ? 0 : code);
+    if ( (++seq->len & 3) == 0 )
+    {
+	if ( seq->len / 4 > seq->dna_array_size )
+	{
+	    seq->dna_array_size = seq->dna_array_size == 0 ? BUFF_SIZE :
+				  seq->dna_array_size * 2;
+	    new_dna = realloc(seq->dna, seq->dna_array_size);
+	    if ( new_dna == NULL )
+	    {
+		fputs("fasta-pack: Could not allocate sequence.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    seq->dna = new_dna;
+	}
+	seq->dna[seq->len / 4 - 1] = seq->packed;
+	seq->packed = 0;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Close open runs, write the record for seq to the spool file, add
+ *      it to the index, and reset seq for the next sequence.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     seq_finish(seq_t *seq, FILE *spool, uint64_t *spool_len,
+		   index_t *index)
+
+{
+    size_t          dna_bytes = (seq->len + 3) / 4;
+    uint32_t        c;
+    unsigned char   *new_dna;
+    void            *new_names, *new_offsets;
+
+    if ( (seq->in_n &&
+	  (block_add(&seq->n_blocks, seq->n_start, seq->len) != 0)) ||
+	 (seq->in_mask &&
+	  (block_add(&seq->mask_blocks, seq->mask_start, seq->len) != 0)) )
+	return EX_UNAVAILABLE;
+
+    // Final partial byte, first base in the high-order bits
+    if ( (seq->len & 3) != 0 )
+    {
+	if ( dna_bytes > seq->dna_array_size )
+	{
+	    if ( (new_dna = realloc(seq->dna, dna_bytes)) == NULL )
+	    {
+		fputs("fasta-pack: Could not allocate sequence.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    seq->dna = new_dna;
+	    seq->dna_array_size = dna_bytes;
+	}
+	seq->dna[dna_bytes - 1] = seq->packed << (2 * (4 - (seq->len & 3)));
+    }
+
+    if ( index->count == index->array_size )
+    {
+	index->array_size = index->array_size == 0 ? 1024 :
+			    index->array_size * 2;
+	new_names = realloc(index->names,
+			    index->array_size * sizeof(*index->names));
+	if ( new_names != NULL )
+	    index->names = new_names;
+	new_offsets = realloc(index->offsets,
+			      index->array_size * sizeof(*index->offsets));
+	if ( new_offsets != NULL )
+	    index->offsets = new_offsets;
+	if ( (new_names == NULL) || (new_offsets == NULL) )
+	{
+	    fputs("fasta-pack: Could not allocate index.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+    }
+    if ( (index->names[index->count] = strdup(seq->name)) == NULL )
+    {
+	fputs("fasta-pack: Could not allocate index.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    index->offsets[index->count++] = *spool_len;
+
+    PROF_START(t);
+    put32(spool, seq->len);
+    put32(spool, seq->n_blocks.count);
+    for (c = 0; c < seq->n_blocks.count; ++c)
+	put32(spool, seq->n_blocks.starts[c]);
+    for (c = 0; c < seq->n_blocks.count; ++c)
+	put32(spool, seq->n_blocks.sizes[c]);
+    put32(spool, seq->mask_blocks.count);
+    for (c = 0; c < seq->mask_blocks.count; ++c)
+	put32(spool, seq->mask_blocks.starts[c]);
+    for (c = 0; c < seq->mask_blocks.count; ++c)
+	put32(spool, seq->mask_blocks.sizes[c]);
+    put32(spool, 0);    // Reserved
+    fwrite(seq->dna, 1, dna_bytes, spool);
+    PROF_STOP_IO(t, "spool");
+    PROF_RECORDS(1);
+    *spool_len += 16 + 8 * (uint64_t)(seq->n_blocks.count +
+				      seq->mask_blocks.count) + dna_bytes;
+
+    seq->len = 0;
+    seq->packed = 0;
+    seq->in_n = seq->in_mask = false;
+    seq->n_blocks.count = seq->mask_blocks.count = 0;
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append the run [start, end) to a block list
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     block_add(block_list_t *list, uint32_t start, uint32_t end)
+
+{
+    uint32_t    *new_starts, *new_sizes;
+
+    if ( list->count == list->array_size )
+    {
+	list->array_size = list->array_size == 0 ? 1024 :
+			   list->array_size * 2;
+	new_starts = realloc(list->starts,
+			     list->array_size * sizeof(*list->starts));
+	if ( new_starts != NULL )
+	    list->starts = new_starts;
+	new_sizes = realloc(list->sizes,
+			    list->array_size * sizeof(*list->sizes));
+	if ( new_sizes != NULL )
+	    list->sizes = new_sizes;
+	if ( (new_starts == NULL) || (new_sizes == NULL) )
+	{
+	    fputs("fasta-pack: Could not allocate block list.\n", stderr);
+	    return -1;
+	}
+    }
+    list->starts[list->count] = start;
+    list->sizes[list->count++] = end - start;
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write the header and index, then copy the spooled records.
+ *      Version 1 (64-bit offsets) is used only if the file would
+ *      exceed 4 GiB, since older readers support only version 0.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     write_index(index_t *index, FILE *spool, uint64_t spool_len,
+		    FILE *outstream)
+
+{
+    static char buff[BUFF_SIZE];
+    uint64_t    index_len, offset;
+    uint32_t    c, version;
+    size_t      bytes;
+
+    if ( (fflush(spool) != 0) || ferror(spool) )
+    {
+	fprintf(stderr, "fasta-pack: Error writing temporary file: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+
+    index_len = 16;
+    for (c = 0; c < index->count; ++c)
+	index_len += 1 + strlen(index->names[c]) + 4;
+    version = index_len + spool_len > UINT32_MAX ? 1 : 0;
+    if ( version == 1 )
+	index_len += 4 * (uint64_t)index->count;
+
+    PROF_START(t);
+    put32(outstream, BLT_2BIT_SIGNATURE);
+    put32(outstream, version);
+    put32(outstream, index->count);
+    put32(outstream, 0);    // Reserved
+    for (c = 0; c < index->count; ++c)
+    {
+	putc(strlen(index->names[c]), outstream);
+	fputs(index->names[c], outstream);
+	offset = index_len + index->offsets[c];
+	if ( version == 0 )
+	    put32(outstream, offset);
+	else
+	    fwrite(&offset, sizeof(offset), 1, outstream);
+    }
+
+    rewind(spool);
+    while ( (bytes = fread(buff, 1, BUFF_SIZE, spool)) > 0 )
+	fwrite(buff, 1, bytes, outstream);
+    PROF_STOP_IO(t, "write");
+    if ( ferror(spool) || ferror(outstream) )
+    {
+	fprintf(stderr, "fasta-pack: Error writing output: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+    fprintf(stderr, "fasta-pack: %u sequences packed.\n", index->count);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write a 32-bit value in host byte order, as the .2bit format
+ *      specifies.  Readers detect the byte order from the signature.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    put32(FILE *stream, uint32_t val)
+
+{
+    fwrite(&val, sizeof(val), 1, stream);
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s < file.fasta[.gz] > file.2bit\n", argv[0]);
+    exit(EX_USAGE);
+}
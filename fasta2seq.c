@@ -4,24 +4,352 @@
  *      description lines, which can be easily examined using plain text
  *      tools.
  *
- *  History: 
+ *      Input is streamed through a large buffer using read(2) and
+ *      sequence lines are copied directly to the output buffer, so
+ *      memory use is constant regardless of chromosome length.
+ *      Whole records are never held in memory, as they would be with
+ *      bl_fasta_read().
+ *
+ *      With --2bit, bases are packed 4 per byte (A=0, C=1, G=2, T/U=3,
+ *      first base in the high-order bits), for use by k-mer tools that
+ *      work on 2-bit sequences.  Bases other than ACGTU are stored as
+ *      A and counted in the report on stderr.
+ *
+ *      A .2bit file from blt fasta-pack on stdin is mapped and decoded
+ *      directly, 4 bases per table lookup, without parsing text.
+ *
+ *  History:
  *  Date        Name        Modification
  *  2021-10-25  Jason Bacon Begin
  ***************************************************************************/
 
 #include <stdio.h>
 #include <sysexits.h>
-#include <biolibc/fasta.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "blt-2bit.h"
+#include "blt-profile.h"
+
+#define BUFF_SIZE   (1024 * 1024)
+
+int     fasta2seq(int infd, int outfd, bool two_bit);
+int     fasta2seq_2bit(int infd, int outfd, bool two_bit);
+void    init_codes(void);
+int     write_all(int fd, const void *buff, size_t len);
+void    usage(char *argv[]);
+
+// Base -> 2-bit code, -1 for bytes that are not part of the sequence
+static int8_t   Codes[256];
 
 int     main(int argc,char *argv[])
 
 {
-    bl_fasta_t  fasta_rec;
-    
-    bl_fasta_init(&fasta_rec);
-    while ( bl_fasta_read(&fasta_rec, stdin) != EOF )
-	printf("%s", BL_FASTA_SEQ(&fasta_rec));
-    putchar('\n');
+    bool    two_bit = false;
+
+    PROF_INIT("fasta2seq");
+
+    switch(argc)
+    {
+	case 1:
+	    break;
+
+	case 2:
+	    if ( strcmp(argv[1], "--2bit") == 0 )
+		two_bit = true;
+	    else
+		usage(argv);
+	    break;
+
+	default:
+	    usage(argv);
+    }
+
+    init_codes();
+    if ( blt_2bit_sniff(STDIN_FILENO) )
+	return fasta2seq_2bit(STDIN_FILENO, STDOUT_FILENO, two_bit);
+    return fasta2seq(STDIN_FILENO, STDOUT_FILENO, two_bit);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Copy sequence lines from a FASTA stream to output, discarding
+ *      description lines and newlines.  State (at start of line, inside
+ *      a description) is carried across buffer boundaries, so lines
+ *      may be of any length.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fasta2seq(int infd, int outfd, bool two_bit)
+
+{
+    static unsigned char    in_buff[BUFF_SIZE],
+			    out_buff[BUFF_SIZE + 1];
+    unsigned char   *p, *end, *eol, packed = 0;
+    ssize_t         bytes;
+    size_t          out_len = 0, chunk, bases = 0, ambiguous = 0;
+    uint32_t        signature;
+    bool            line_start = true, in_desc = false, first_read = true;
+    int             c, code;
+
+    PROF_START(t);
+    while ( (bytes = read(infd, in_buff, BUFF_SIZE)) > 0 )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(bytes);
+	if ( first_read && (bytes >= 4) )
+	{
+	    memcpy(&signature, in_buff, sizeof(signature));
+	    if ( signature == BLT_2BIT_SIGNATURE )
+	    {
+		fputs("fasta2seq: .2bit input must be a file, not a pipe.\n",
+		      stderr);
+		return EX_DATAERR;
+	    }
+	}
+	first_read = false;
+	p = in_buff;
+	end = in_buff + bytes;
+	while ( p < end )
+	{
+	    if ( line_start && (*p == '>') )
+		in_desc = true;
+	    line_start = false;
+
+	    if ( (eol = memchr(p, '\n', end - p)) == NULL )
+		eol = end;
+	    else
+		line_start = true;
+
+	    if ( in_desc )
+	    {
+		if ( line_start )
+		    in_desc = false;
+	    }
+	    else if ( two_bit )
+	    {
+		for (; p < eol; ++p)
+		{
+		    if ( (code = Codes[*p]) < 0 )
+			continue;
+		    c = *p | 0x20;
+		    if ( (c != 'a') && (c != 'c') && (c != 'g') &&
+			 (c != 't') && (c != 'u') )
+			++ambiguous;
+		    packed = (packed << 2) | code;
+		    if ( (++bases & 3) == 0 )
+		    {
+			out_buff[out_len++] = packed;
+			if ( out_len == BUFF_SIZE )
+			{
+			    if ( write_all(outfd, out_buff, out_len) != 0 )
+				return EX_IOERR;
+			    out_len = 0;
+			}
+		    }
+		}
+	    }
+	    else
+	    {
+		// Strip CR from DOS line endings
+		chunk = eol - p;
+		if ( (chunk > 0) && (eol[-1] == '\r') )
+		    --chunk;
+		if ( out_len + chunk > BUFF_SIZE )
+		{
+		    if ( write_all(outfd, out_buff, out_len) != 0 )
+			return EX_IOERR;
+		    out_len = 0;
+		}
+		if ( chunk >= BUFF_SIZE )
+		{
+		    // Very long line in a full input buffer: write directly
+		    if ( write_all(outfd, p, chunk) != 0 )
+			return EX_IOERR;
+		}
+		else
+		{
+		    memcpy(out_buff + out_len, p, chunk);
+		    out_len += chunk;
+		}
+	    }
+	    p = eol + line_start;
+	}
+	PROF_RESTART(t);
+    }
+
+    if ( bytes < 0 )
+    {
+	fprintf(stderr, "fasta2seq: Error reading input: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+
+    if ( two_bit )
+    {
+	// Pad the last byte with A's
+	if ( (bases & 3) != 0 )
+	    out_buff[out_len++] = packed << (2 * (4 - (bases & 3)));
+	fprintf(stderr, "fasta2seq: %zu bases packed, %zu ambiguous stored as A.\n",
+		bases, ambiguous);
+    }
+    else
+	out_buff[out_len++] = '\n';
+    if ( write_all(outfd, out_buff, out_len) != 0 )
+	return EX_IOERR;
     return EX_OK;
 }
 
+
+/***************************************************************************
+ *  Description:
+ *      Same as fasta2seq(), for a .2bit file on infd.  Sequences are
+ *      decoded a buffer at a time into the output buffer, and re-packed
+ *      in place for --2bit.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fasta2seq_2bit(int infd, int outfd, bool two_bit)
+
+{
+    static char     buff[BUFF_SIZE + 1];
+    blt_2bit_t      *tb;
+    blt_2bit_seq_t  seq;
+    uint32_t        c, start, end;
+    size_t          out_len, p, bases = 0, ambiguous = 0;
+    unsigned char   packed = 0;
+    int             status = EX_OK;
+
+    if ( (tb = blt_2bit_fdopen(infd)) == NULL )
+    {
+	fprintf(stderr, "fasta2seq: Cannot map .2bit input: %s\n",
+		strerror(errno));
+	return EX_DATAERR;
+    }
+
+    for (c = 0; (c < tb->count) && (status == EX_OK); ++c)
+    {
+	if ( blt_2bit_seq(tb, c, &seq) != 0 )
+	{
+	    fprintf(stderr, "fasta2seq: Corrupt .2bit record for %s.\n",
+		    tb->names[c]);
+	    status = EX_DATAERR;
+	    break;
+	}
+	PROF_RECORDS(1);
+	for (start = 0; (start < seq.len) && (status == EX_OK); start = end)
+	{
+	    end = seq.len - start > BUFF_SIZE ? start + BUFF_SIZE : seq.len;
+	    PROF_START(t);
+	    blt_2bit_decode(&seq, start, end, buff);
+	    PROF_STOP(t, "decode");
+	    PROF_BYTES((end - start + 3) / 4);
+	    out_len = end - start;
+	    if ( two_bit )
+	    {
+		// Packed output never overtakes the decoded input
+		for (p = 0, out_len = 0; p < end - start; ++p)
+		{
+		    if ( (buff[p] | 0x20) == 'n' )
+			++ambiguous;
+		    packed = (packed << 2) | Codes[(unsigned char)buff[p]];
+		    if ( (++bases & 3) == 0 )
+			buff[out_len++] = packed;
+		}
+	    }
+	    if ( write_all(outfd, buff, out_len) != 0 )
+		status = EX_IOERR;
+	}
+    }
+    blt_2bit_close(tb);
+    if ( status != EX_OK )
+	return status;
+
+    out_len = 0;
+    if ( two_bit )
+    {
+	// Pad the last byte with A's
+	if ( (bases & 3) != 0 )
+	    buff[out_len++] = packed << (2 * (4 - (bases & 3)));
+	fprintf(stderr, "fasta2seq: %zu bases packed, %zu ambiguous stored as A.\n",
+		bases, ambiguous);
+    }
+    else
+	buff[out_len++] = '\n';
+    if ( write_all(outfd, buff, out_len) != 0 )
+	return EX_IOERR;
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Fill the base -> 2-bit code table used by --2bit
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    init_codes(void)
+
+{
+    memset(Codes, 0, sizeof(Codes));
+    Codes['\n'] = Codes['\r'] = -1;
+    Codes['C'] = Codes['c'] = 1;
+    Codes['G'] = Codes['g'] = 2;
+    Codes['T'] = Codes['t'] = Codes['U'] = Codes['u'] = 3;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write an entire buffer, retrying after short writes
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     write_all(int fd, const void *buff, size_t len)
+
+{
+    const char  *p = buff;
+    ssize_t     bytes;
+
+    while ( len > 0 )
+    {
+	PROF_START(t);
+	bytes = write(fd, p, len);
+	PROF_STOP_IO(t, "write");
+	if ( bytes < 0 )
+	{
+	    if ( errno == EINTR )
+		continue;
+	    fprintf(stderr, "fasta2seq: Error writing output: %s\n",
+		    strerror(errno));
+	    return -1;
+	}
+	p += bytes;
+	len -= bytes;
+    }
+    return 0;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--2bit] < file.fasta > file.seq\n", argv[0]);
+    exit(EX_USAGE);
+}
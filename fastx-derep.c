@@ -14,6 +14,9 @@
  *      In this case, biolibc handles all the FASTQ I/O, xxhash the sequence
  *      hasing, and uthash the hash table management.
  *
+ *      With --bgzf, output is BGZF-compressed on all cores, so a
+ *      downstream gzip is not needed.
+ *
  *      FIXME: Add paired-end mode to keep paired files in sync
  *  
  *  History: 
@@ -22,14 +25,19 @@
  ***************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include <sysexits.h>
 #include <uthash.h>
 #include <xxhash.h>
 #include <biolibc/fastx.h>
 #include <xtend/mem.h>      // xt_malloc
-#include <xtend/time.h>     // xt_tic, xt_toc
-#include <sys/types.h>
-#include <sys/time.h>
+#include "blt-zio.h"
+#include "blt-stage.h"
+#include "blt-profile.h"
 
 typedef struct
 {
@@ -37,6 +45,27 @@ typedef struct
     UT_hash_handle  hh;
 }   entry_t;
 
+// State of the "blt pipe" stage
+typedef struct
+{
+    entry_t     *table;
+    size_t      records_read,
+		records_written;
+}   derep_stage_t;
+
+void    derep_args(int argc, char *argv[], blt_stage_io_t *io);
+void    derep_warning(void);
+bool    derep_new_seq(entry_t **table, bl_fastx_t *rec);
+void    *derep_stage_open(int argc, char *argv[], blt_stage_io_t *io);
+int     derep_stage_batch(void *state, blt_batch_t *batch);
+int     derep_stage_close(void *state, int status);
+void    usage(char *argv[]);
+
+const blt_stage_t   blt_fastx_derep_stage =
+{
+    "fastx-derep", derep_stage_open, NULL, derep_stage_batch,
+    derep_stage_close
+};
 
 int     main(int argc, char *argv[])
 
@@ -44,25 +73,125 @@ int     main(int argc, char *argv[])
     bl_fastx_t      rec = BL_FASTX_INIT;
     size_t          records_read,
 		    records_written;
-    int             seed = 0;
-    entry_t         *table = NULL,
-		    *entry,
-		    *found = NULL;
-    XXH64_hash_t    hash;
-    struct rusage   start_usage,
-		    end_usage;
-    struct timeval  start_prog,
-		    start_hash,
-		    end_hash,
-		    start_table_find,
-		    end_table_find,
-		    start_table_add,
-		    end_table_add;
-    unsigned long   hash_time,
-		    table_find_time,
-		    table_add_time;
+    entry_t         *table = NULL;
     int             status;
+    bool            new_seq;
+    blt_stage_io_t  io;
+    FILE            *instream, *outstream = stdout;
+    
+    PROF_INIT("fastx-derep");
+
+    derep_args(argc, argv, &io);
+    derep_warning();
+    
+    // Decompress gzip or BGZF input on other cores
+    if ( io.range_end == -1 )
+	instream = blt_zopen("-", io.threads);
+    else
+	instream = blt_zopen_range("-", io.range_start, io.range_end);
+    if ( instream == NULL )
+    {
+	fprintf(stderr, "fastx-derep: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( io.bgzf &&
+	 ((outstream = blt_bgzf_fdopen(STDOUT_FILENO, io.threads)) == NULL) )
+    {
+	fprintf(stderr, "fastx-derep: Cannot open BGZF output: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    bl_fastx_init(&rec, instream);
+    records_read = records_written = 0;
+    PROF_START(t);
+    while ( (status = bl_fastx_read(&rec, instream)) == BL_READ_OK )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
+	// Excluding line breaks and the FASTQ '+' line
+	PROF_BYTES(bl_fastx_desc_len(&rec) + bl_fastx_seq_len(&rec) +
+		   bl_fastx_qual_len(&rec));
+	//fputs(bl_fastx_desc(&rec), stderr);
+	++records_read;
+	PROF_RESTART(t);
+	new_seq = derep_new_seq(&table, &rec);
+	PROF_STOP(t, "hash table");
+	if ( new_seq )
+	{
+	    // Output record
+	    PROF_RESTART(t);
+	    bl_fastx_write(&rec, outstream, BL_FASTX_LINE_UNLIMITED);
+	    PROF_STOP_IO(t, "write");
+	    ++records_written;
+	}
+	PROF_RESTART(t);
+    }
+    blt_zclose(instream);
     
+    if ( status != BL_READ_EOF )
+    {
+	fprintf(stderr, "fastx-derep: Error reading input.\n");
+	return EX_DATAERR;
+    }
+    if ( blt_zclose(outstream) != 0 )
+    {
+	fprintf(stderr, "fastx-derep: Error writing output.\n");
+	return EX_IOERR;
+    }
+    fprintf(stderr, "%zu records read, %zu written, %zu removed\n",
+	   records_read, records_written, records_read - records_written);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse command line arguments for main() and the "blt pipe"
+ *      stage.  Exits through usage() on errors.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    derep_args(int argc, char *argv[], blt_stage_io_t *io)
+
+{
+    int     arg;
+
+    io->threads = BLT_ZIO_THREADS_DEFAULT;
+    io->bgzf = false;
+    io->range_start = 0;
+    io->range_end = -1;     // Whole input
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    io->bgzf = true;
+	else if ( (strcmp(argv[arg], "--range") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_range(argv[++arg], &io->range_start,
+				 &io->range_end) != 0 )
+	    {
+		fprintf(stderr, "Invalid range: %s\n", argv[arg]);
+		usage(argv);
+	    }
+	}
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &io->threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+}
+
+
+void    derep_warning(void)
+
+{
     fputs("\nRemoving replicate sequences from a FASTQ file may not be a\n"
 	"good idea for the following reasons:\n\n"
 	"1) It preferentially removes data with no read errors, since\n"
@@ -76,59 +205,115 @@ int     main(int argc, char *argv[])
 	"   replicates outweighs the cost of losing natural ones.  This will\n"
 	"   depend on the type of downstream analysis to be done and the\n"
 	"   behavior of the sequencer used.\n\n", stderr);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return true if the sequence of rec has not been seen before,
+ *      adding its hash to the table.  Stage threads call this too, so
+ *      the caller does any profiling.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    derep_new_seq(entry_t **table, bl_fastx_t *rec)
+
+{
+    entry_t         *entry,
+		    *found = NULL;
+    XXH64_hash_t    hash;
+    int             seed = 0;
+
+    hash = XXH64(bl_fastx_seq(rec), bl_fastx_seq_len(rec), seed);
     
-    bl_fastx_init(&rec, stdin);
-    xt_tic(&start_prog, &start_usage);
-    records_read = records_written = hash_time = 
-	table_find_time = table_add_time = 0;
-    while ( (status = bl_fastx_read(&rec, stdin)) == BL_READ_OK )
-    {
-	//fputs(bl_fastx_desc(&rec), stderr);
-	++records_read;
-	// Profiling with gettimeofday() adds about 1% to run time
-	gettimeofday(&start_hash, NULL);
-	hash = XXH64(bl_fastx_seq(&rec), bl_fastx_seq_len(&rec), seed);
-	gettimeofday(&end_hash, NULL);
-	hash_time += xt_difftimeofday(&end_hash, &start_hash);
-	
-	/*
-	 *  Note: We assume XXH64 produces no collisions, i.e. only
-	 *  identical sequences will produce the same hash.  If it does,
-	 *  we may end up removing some uniq sequences.  This should be
-	 *  extremely rare, though.  We could use the sequence itself
-	 *  in the hash table, but this would significantly increase
-	 *  memory use (e.g. 100-byte sequences vs 8-byte hashes).
-	 */
-	
-	gettimeofday(&start_table_find, NULL);
-	HASH_FIND(hh, table, &hash, sizeof(hash), found);
-	gettimeofday(&end_table_find, NULL);
-	table_find_time += xt_difftimeofday(&end_table_find, &start_table_find);
-	if ( found == NULL )
-	{
-	    // Record key for comparison to future records
-	    gettimeofday(&start_table_add, NULL);
-	    entry = xt_malloc(1, sizeof(entry_t));
-	    entry->hash = hash;
-	    HASH_ADD(hh, table, hash, sizeof(entry->hash), entry);
-	    gettimeofday(&end_table_add, NULL);
-	    table_add_time += xt_difftimeofday(&end_table_add, &start_table_add);
-	    
-	    // Output record
-	    bl_fastx_write(&rec, stdout, BL_FASTX_LINE_UNLIMITED);
-	    ++records_written;
-	}
-    }
+    /*
+     *  Note: We assume XXH64 produces no collisions, i.e. only
+     *  identical sequences will produce the same hash.  If it does,
+     *  we may end up removing some uniq sequences.  This should be
+     *  extremely rare, though.  We could use the sequence itself
+     *  in the hash table, but this would significantly increase
+     *  memory use (e.g. 100-byte sequences vs 8-byte hashes).
+     */
     
-    fprintf(stderr, "bl_fastx_read() status = %d\n", status);
-    fprintf(stderr, "%zu records read, %zu written, %zu removed\n",
-	   records_read, records_written, records_read - records_written);
-    xt_toc(stderr, NULL, &start_prog, &start_usage);
-    fprintf(stderr, "xxHash encode    = %10lu microseconds\n", hash_time);
-    fprintf(stderr, "uthash find      = %10lu microseconds\n", table_find_time);
-    fprintf(stderr, "uthash add       = %10lu microseconds\n", table_add_time);
-    getrusage(RUSAGE_SELF, &end_usage);
-    fprintf(stderr, "Maximum RAM used = %10lu MiB\n",
-	    end_usage.ru_maxrss / 1024);
+    HASH_FIND(hh, *table, &hash, sizeof(hash), found);
+    if ( found != NULL )
+	return false;
+
+    // Record key for comparison to future records
+    entry = xt_malloc(1, sizeof(entry_t));
+    entry->hash = hash;
+    HASH_ADD(hh, *table, hash, sizeof(entry->hash), entry);
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stage functions for "blt pipe", which passes batches of parsed
+ *      records between subcommands in one process.  Records with a
+ *      sequence seen before are dropped from the batch.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *derep_stage_open(int argc, char *argv[], blt_stage_io_t *io)
+
+{
+    derep_stage_t   *stage;
+
+    if ( (stage = calloc(1, sizeof(*stage))) == NULL )
+	return NULL;
+    derep_args(argc, argv, io);
+    derep_warning();
+    return stage;
+}
+
+
+int     derep_stage_batch(void *state, blt_batch_t *batch)
+
+{
+    derep_stage_t   *stage = state;
+    unsigned    c, kept;
+
+    for (c = kept = 0; c < batch->count; ++c)
+	if ( derep_new_seq(&stage->table, &batch->records[c]) )
+	    blt_batch_keep(batch, c, kept++);
+    stage->records_read += batch->count;
+    stage->records_written += kept;
+    batch->count = kept;
     return EX_OK;
 }
+
+
+int     derep_stage_close(void *state, int status)
+
+{
+    derep_stage_t   *stage = state;
+    entry_t     *entry, *temp;
+
+    if ( status == EX_OK )
+	fprintf(stderr, "%zu records read, %zu written, %zu removed\n",
+		stage->records_read, stage->records_written,
+		stage->records_read - stage->records_written);
+    HASH_ITER(hh, stage->table, entry, temp)
+    {
+	HASH_DEL(stage->table, entry);
+	free(entry);
+    }
+    free(stage);
+    return status;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--range start-end] [--bgzf [--threads N]] "
+	    "< file.fastq > uniq.fastq\n", argv[0]);
+    exit(EX_USAGE);
+}
@@ -3,47 +3,253 @@
  *      Show differences between two FAST[AQ] files, like the standard
  *      Unix diff commmand for plain text files.
  *
- *      Currently very simple and only useful to compare files with the
- *      same set of reads that have been modified in some way, such as
- *      a trimmed and untrimmed version of a FASTQ.
- *  
- *  History: 
+ *      By default, files are expected to contain the same records in
+ *      the same order, e.g. reference and test outputs of a pipeline.
+ *      Both files are read in large blocks on separate threads and
+ *      compared with memcmp(), so identical files are verified at close
+ *      to I/O speed.  Only if a block differs are the files compared
+ *      record by record to report the differences.  Files whose bytes
+ *      differ only in formatting, such as FASTA line wrapping, compare
+ *      equal.
+ *
+ *      With --unordered, records are read and hashed on separate
+ *      threads and each hash is counted up for file1 and down for
+ *      file2, so files with the same records in any order compare
+ *      equal.  Records with nonzero counts are reported in a second
+ *      pass only if the files differ.
+ *
+ *      Exit status is 0 if the files are the same, 1 if they differ,
+ *      as with diff(1), or a sysexits code on errors.
+ *
+ *  History:
  *  Date        Name        Modification
  *  2022-01-04  Jason Bacon Begin
  ***************************************************************************/
 
 #include <stdio.h>
 #include <sysexits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
-#include <limits.h>
-#include <ctype.h>
-#include <xtend/string.h>
-#include <xtend/file.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <xxhash.h>
 #include <biolibc/fastx.h>
-#include <biolibc/biolibc.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+#define BLOCK_SIZE      (4 * 1024 * 1024)
+#define CHANNEL_BLOCKS  4
+#define HASH_BATCH      (BLOCK_SIZE / sizeof(XXH64_hash_t))
+#define FILES_DIFFER    1
+
+/*
+ *  Bounded queue of blocks from a reader thread to the main thread.
+ *  Blocks are raw file contents in ordered mode, arrays of record
+ *  hashes in unordered mode.  A block of length 0 marks EOF.
+ */
+typedef struct
+{
+    const char      *filename;
+    FILE            *stream;
+    char            *blocks[CHANNEL_BLOCKS];
+    size_t          len[CHANNEL_BLOCKS];
+    unsigned        head,
+		    tail,
+		    count;
+    int             status;     // EX_OK or reader error
+    bool            stop;       // Set by consumer to end reading early
+    pthread_t       tid;
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+}   channel_t;
+
+typedef struct
+{
+    XXH64_hash_t    *hashes;    // 0 = empty slot
+    int64_t         *counts;
+    size_t          size,
+		    used;
+}   count_table_t;
 
-int     fastx_diff(char *filename1, char *filename2);
+int     fastx_diff_ordered(const char *filename1, const char *filename2);
+int     fastx_diff_unordered(const char *filename1, const char *filename2);
+int     record_diff(const char *filename1, const char *filename2);
+int     report_unmatched(const char *filename, count_table_t *table,
+			 int sign, const char *prefix);
+int     channel_open(channel_t *ch, const char *filename,
+		     void *(*reader)(void *));
+char    *channel_get(channel_t *ch, size_t *len);
+void    channel_release(channel_t *ch);
+bool    channel_put_wait(channel_t *ch);
+void    channel_put(channel_t *ch, size_t len);
+int     channel_close(channel_t *ch);
+void    channel_free(channel_t *ch);
+void    *block_reader(void *arg);
+void    *hash_reader(void *arg);
+XXH64_hash_t record_hash(bl_fastx_t *rec);
+int64_t *count_find(count_table_t *table, XXH64_hash_t hash);
+int     count_add(count_table_t *table, XXH64_hash_t hash, int64_t n);
+void    print_record(bl_fastx_t *rec, const char *prefix);
+void    usage(char *argv[]);
 
 int     main(int argc, char *argv[])
 
 {
-    switch(argc)
+    PROF_INIT("fastx-diff");
+
+    if ( (argc == 4) && (strcmp(argv[1], "--unordered") == 0) )
+	return fastx_diff_unordered(argv[2], argv[3]);
+    else if ( argc == 3 )
+	return fastx_diff_ordered(argv[1], argv[2]);
+    else
+	usage(argv);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compare two files block by block, each read on its own thread.
+ *      Fall back to record_diff() on the first difference.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fastx_diff_ordered(const char *filename1, const char *filename2)
+
+{
+    channel_t   ch1, ch2;
+    char        *block1, *block2;
+    size_t      len1, len2;
+    bool        same = true;
+    int         status1, status2;
+
+    if ( (status1 = channel_open(&ch1, filename1, block_reader)) != EX_OK )
+	return status1;
+    if ( (status2 = channel_open(&ch2, filename2, block_reader)) != EX_OK )
     {
-	case 3:
-	    return fastx_diff(argv[1], argv[2]);
-	    break;
-	
-	default:
-	    fprintf(stderr, "Usage: %s file1 file2\n", argv[0]);
-	    return EX_USAGE;
+	channel_close(&ch1);
+	return status2;
     }
-	
-    return EX_OK;
+
+    PROF_START(t);
+    do
+    {
+	block1 = channel_get(&ch1, &len1);
+	block2 = channel_get(&ch2, &len2);
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(len1 + len2);
+	PROF_RESTART(t);
+	same = (len1 == len2) && (memcmp(block1, block2, len1) == 0);
+	channel_release(&ch1);
+	channel_release(&ch2);
+	PROF_STOP(t, "compare");
+	PROF_RESTART(t);
+    }   while ( same && (len1 > 0) );
+
+    status1 = channel_close(&ch1);
+    status2 = channel_close(&ch2);
+    if ( status1 != EX_OK )
+	return status1;
+    if ( status2 != EX_OK )
+	return status2;
+    return same ? EX_OK : record_diff(filename1, filename2);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count record hashes from both files, reading and hashing each
+ *      file on its own thread.  Report unmatched records if any count
+ *      is nonzero.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fastx_diff_unordered(const char *filename1, const char *filename2)
+
+{
+    channel_t       ch[2];
+    count_table_t   table = { NULL, NULL, 0, 0 };
+    XXH64_hash_t    *hashes;
+    size_t          len, c, slot;
+    bool            eof[2] = { false, false };
+    int             f, status[2], sign[2] = { 1, -1 };
+
+    if ( (status[0] = channel_open(&ch[0], filename1, hash_reader)) != EX_OK )
+	return status[0];
+    if ( (status[1] = channel_open(&ch[1], filename2, hash_reader)) != EX_OK )
+    {
+	channel_close(&ch[0]);
+	return status[1];
+    }
+
+    // Alternate between files so that both reader threads keep working
+    PROF_START(t);
+    while ( !eof[0] || !eof[1] )
+    {
+	for (f = 0; f < 2; ++f)
+	{
+	    if ( eof[f] )
+		continue;
+	    hashes = (XXH64_hash_t *)channel_get(&ch[f], &len);
+	    PROF_STOP_IO(t, "read");
+	    PROF_RECORDS(len / sizeof(*hashes));
+	    PROF_RESTART(t);
+	    if ( len == 0 )
+		eof[f] = true;
+	    for (c = 0; c < len / sizeof(*hashes); ++c)
+		if ( count_add(&table, hashes[c], sign[f]) != EX_OK )
+		    return EX_UNAVAILABLE;
+	    channel_release(&ch[f]);
+	    PROF_STOP(t, "count");
+	    PROF_RESTART(t);
+	}
+    }
+    status[0] = channel_close(&ch[0]);
+    status[1] = channel_close(&ch[1]);
+    if ( status[0] != EX_OK )
+	return status[0];
+    if ( status[1] != EX_OK )
+	return status[1];
+
+    for (slot = 0; (slot < table.size) &&
+		   ((table.hashes[slot] == 0) || (table.counts[slot] == 0)); ++slot)
+	;
+    if ( slot < table.size )
+    {
+	// Second pass only when files differ
+	if ( ((status[0] = report_unmatched(filename1, &table, 1, "- "))
+		!= EX_OK) ||
+	     ((status[1] = report_unmatched(filename2, &table, -1, "+ "))
+		!= EX_OK) )
+	    return EX_NOINPUT;
+	status[0] = FILES_DIFFER;
+    }
+    free(table.hashes);
+    free(table.counts);
+    return status[0];
 }
 
 
-int     fastx_diff(char *filename1, char *filename2)
+/***************************************************************************
+ *  Description:
+ *      Compare two files record by record and report differing records,
+ *      prefixing lines from filename1 with "- " and lines from filename2
+ *      with "+ ".
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2022-01-04  Jason Bacon Begin
+ ***************************************************************************/
+
+int     record_diff(const char *filename1, const char *filename2)
 
 {
     FILE        *stream1,
@@ -51,52 +257,470 @@ int     fastx_diff(char *filename1, char *filename2)
     bl_fastx_t  rec1 = BL_FASTX_INIT,
 		rec2 = BL_FASTX_INIT;
     int         s1, s2, e1, e2;
-    char        *seq1, *seq2;
-    
-    if ( (stream1 = xt_fopen(filename1, "r")) == NULL )
+    size_t      record;
+    bool        same, differ = false;
+
+    stream1 = blt_zopen(filename1, BLT_ZIO_THREADS_DEFAULT);
+    if ( stream1 == NULL )
     {
 	fprintf(stderr, "fastx-diff: Cannot open %s: %s\n",
 		filename1, strerror(errno));
 	return EX_NOINPUT;
     }
-    if ( (stream2 = xt_fopen(filename2, "r")) == NULL )
+    stream2 = blt_zopen(filename2, BLT_ZIO_THREADS_DEFAULT);
+    if ( stream2 == NULL )
     {
 	fprintf(stderr, "fastx-diff: Cannot open %s: %s\n",
 		filename2, strerror(errno));
 	return EX_NOINPUT;
     }
-    
-    bl_fastx_init(stream1, &rec1);
-    bl_fastx_init(stream2, &rec2);
 
-    while ( true )
+    bl_fastx_init(&rec1, stream1);
+    bl_fastx_init(&rec2, stream2);
+
+    PROF_START(t);
+    for (record = 1; ; ++record)
     {
-	s1 = bl_fastx_read(stream1, &rec1);
+	s1 = bl_fastx_read(&rec1, stream1);
 	e1 = errno;
-	s2 = bl_fastx_read(stream2, &rec2);
+	s2 = bl_fastx_read(&rec2, stream2);
 	e2 = errno;
-	
-	if ( (s1 != BL_READ_OK) || (s1 != BL_READ_OK) )
+	PROF_STOP_IO(t, "read");
+
+	if ( (s1 != BL_READ_OK) && (s2 != BL_READ_OK) )
 	    break;
-	
-	seq1 = bl_fastx_seq(&rec1);
-	seq2 = bl_fastx_seq(&rec2);
-	if ( strcmp(seq1, seq2) != 0 )
+
+	PROF_RECORDS(1);
+	PROF_RESTART(t);
+	if ( (s1 == BL_READ_OK) && (s2 == BL_READ_OK) )
+	    same = (strcmp(bl_fastx_desc(&rec1), bl_fastx_desc(&rec2)) == 0) &&
+		   (strcmp(bl_fastx_seq(&rec1), bl_fastx_seq(&rec2)) == 0) &&
+		   ((BL_FASTX_FORMAT(&rec1) != BL_FASTX_FORMAT_FASTQ) ||
+		    (strcmp(bl_fastx_qual(&rec1), bl_fastx_qual(&rec2)) == 0));
+	else
+	    same = false;
+	PROF_STOP(t, "compare");
+	if ( !same )
 	{
-	    printf("- %s\n", seq1);
-	    printf("+ %s\n", seq2);
+	    PROF_RESTART(t);
+	    differ = true;
+	    printf("@@ record %zu\n", record);
+	    if ( s1 == BL_READ_OK )
+		print_record(&rec1, "- ");
+	    if ( s2 == BL_READ_OK )
+		print_record(&rec2, "+ ");
+	    PROF_STOP_IO(t, "write");
 	}
+	PROF_RESTART(t);
     }
-    
+    PROF_STREAM_BYTES(stream1);
+    PROF_STREAM_BYTES(stream2);
+
     if ( s1 != BL_READ_EOF )
 	fprintf(stderr, "Error reading %s: %s\n", filename1, strerror(e1));
-    if ( s1 != BL_READ_EOF )
-	fprintf(stderr, "Error reading %s: %s\n", filename1, strerror(e2));
-    
-    xt_fclose(stream1);
-    xt_fclose(stream1);
+    if ( s2 != BL_READ_EOF )
+	fprintf(stderr, "Error reading %s: %s\n", filename2, strerror(e2));
+
+    blt_zclose(stream1);
+    blt_zclose(stream2);
     bl_fastx_free(&rec1);
     bl_fastx_free(&rec2);
-    
+
+    if ( (s1 != BL_READ_EOF) || (s2 != BL_READ_EOF) )
+	return EX_DATAERR;
+    return differ ? FILES_DIFFER : EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print records from filename whose hash count, as seen from this
+ *      file (sign 1 for file1, -1 for file2), is positive, consuming
+ *      one count per record printed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     report_unmatched(const char *filename, count_table_t *table,
+			 int sign, const char *prefix)
+
+{
+    FILE        *stream;
+    bl_fastx_t  rec = BL_FASTX_INIT;
+    int64_t     *count;
+    int         status;
+
+    stream = blt_zopen(filename, BLT_ZIO_THREADS_DEFAULT);
+    if ( stream == NULL )
+    {
+	fprintf(stderr, "fastx-diff: Cannot open %s: %s\n",
+		filename, strerror(errno));
+	return EX_NOINPUT;
+    }
+    bl_fastx_init(&rec, stream);
+    while ( (status = bl_fastx_read(&rec, stream)) == BL_READ_OK )
+    {
+	if ( ((count = count_find(table, record_hash(&rec))) != NULL) &&
+	     (*count * sign > 0) )
+	{
+	    print_record(&rec, prefix);
+	    *count -= sign;
+	}
+    }
+    blt_zclose(stream);
+    bl_fastx_free(&rec);
+    return status == BL_READ_EOF ? EX_OK : EX_DATAERR;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Open a file and start a reader thread feeding the channel.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     channel_open(channel_t *ch, const char *filename,
+		     void *(*reader)(void *))
+
+{
+    unsigned    c;
+    int         error;
+
+    memset(ch, 0, sizeof(*ch));
+    ch->filename = filename;
+    ch->stream = blt_zopen(filename, BLT_ZIO_THREADS_DEFAULT);
+    if ( ch->stream == NULL )
+    {
+	fprintf(stderr, "fastx-diff: Cannot open %s: %s\n",
+		filename, strerror(errno));
+	return EX_NOINPUT;
+    }
+    for (c = 0; c < CHANNEL_BLOCKS; ++c)
+	if ( (ch->blocks[c] = malloc(BLOCK_SIZE)) == NULL )
+	{
+	    fputs("fastx-diff: Could not allocate blocks.\n", stderr);
+	    channel_free(ch);
+	    return EX_UNAVAILABLE;
+	}
+    pthread_mutex_init(&ch->lock, NULL);
+    pthread_cond_init(&ch->changed, NULL);
+    if ( (error = pthread_create(&ch->tid, NULL, reader, ch)) != 0 )
+    {
+	fprintf(stderr, "fastx-diff: Cannot start reader for %s: %s\n",
+		filename, strerror(error));
+	pthread_mutex_destroy(&ch->lock);
+	pthread_cond_destroy(&ch->changed);
+	channel_free(ch);
+	return EX_OSERR;
+    }
     return EX_OK;
 }
+
+
+/***************************************************************************
+ *  Description:
+ *      Consumer: wait for the next block.  The block belongs to the
+ *      consumer until channel_release().
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *channel_get(channel_t *ch, size_t *len)
+
+{
+    pthread_mutex_lock(&ch->lock);
+    while ( ch->count == 0 )
+	pthread_cond_wait(&ch->changed, &ch->lock);
+    pthread_mutex_unlock(&ch->lock);
+    *len = ch->len[ch->tail];
+    return ch->blocks[ch->tail];
+}
+
+
+void    channel_release(channel_t *ch)
+
+{
+    pthread_mutex_lock(&ch->lock);
+    ch->tail = (ch->tail + 1) % CHANNEL_BLOCKS;
+    --ch->count;
+    pthread_cond_signal(&ch->changed);
+    pthread_mutex_unlock(&ch->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Producer: wait until blocks[head] is free.  Returns false if the
+ *      consumer has stopped reading.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    channel_put_wait(channel_t *ch)
+
+{
+    bool    stop;
+
+    pthread_mutex_lock(&ch->lock);
+    while ( (ch->count == CHANNEL_BLOCKS) && !ch->stop )
+	pthread_cond_wait(&ch->changed, &ch->lock);
+    stop = ch->stop;
+    pthread_mutex_unlock(&ch->lock);
+    return !stop;
+}
+
+
+void    channel_put(channel_t *ch, size_t len)
+
+{
+    pthread_mutex_lock(&ch->lock);
+    ch->len[ch->head] = len;
+    ch->head = (ch->head + 1) % CHANNEL_BLOCKS;
+    ++ch->count;
+    pthread_cond_signal(&ch->changed);
+    pthread_mutex_unlock(&ch->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stop the reader if still running, join it, and free the channel.
+ *      Returns the reader status.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     channel_close(channel_t *ch)
+
+{
+    pthread_mutex_lock(&ch->lock);
+    ch->stop = true;
+    pthread_cond_signal(&ch->changed);
+    pthread_mutex_unlock(&ch->lock);
+    pthread_join(ch->tid, NULL);
+
+    pthread_mutex_destroy(&ch->lock);
+    pthread_cond_destroy(&ch->changed);
+    channel_free(ch);
+    return ch->status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Close the stream and free the blocks of a channel, including one
+ *      only partly set up by channel_open().
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    channel_free(channel_t *ch)
+
+{
+    unsigned    c;
+
+    blt_zclose(ch->stream);
+    for (c = 0; c < CHANNEL_BLOCKS; ++c)
+	free(ch->blocks[c]);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: read the file in full blocks until EOF.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *block_reader(void *arg)
+
+{
+    channel_t   *ch = arg;
+    size_t      len;
+
+    do
+    {
+	if ( !channel_put_wait(ch) )
+	    break;
+	len = fread(ch->blocks[ch->head], 1, BLOCK_SIZE, ch->stream);
+	if ( ferror(ch->stream) )
+	{
+	    fprintf(stderr, "fastx-diff: Error reading %s: %s\n",
+		    ch->filename, strerror(errno));
+	    ch->status = EX_IOERR;
+	    len = 0;
+	}
+	channel_put(ch, len);
+    }   while ( len > 0 );
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: read records and send their hashes in batches.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *hash_reader(void *arg)
+
+{
+    channel_t       *ch = arg;
+    bl_fastx_t      rec = BL_FASTX_INIT;
+    XXH64_hash_t    *hashes;
+    size_t          count;
+    int             status = BL_READ_OK;
+
+    bl_fastx_init(&rec, ch->stream);
+    do
+    {
+	if ( !channel_put_wait(ch) )
+	    break;
+	hashes = (XXH64_hash_t *)ch->blocks[ch->head];
+	for (count = 0; (count < HASH_BATCH) &&
+	     ((status = bl_fastx_read(&rec, ch->stream)) == BL_READ_OK); ++count)
+	    hashes[count] = record_hash(&rec);
+	if ( (count < HASH_BATCH) && (status != BL_READ_EOF) )
+	{
+	    fprintf(stderr, "fastx-diff: Error reading %s: %s\n",
+		    ch->filename, strerror(errno));
+	    ch->status = EX_DATAERR;
+	}
+	channel_put(ch, count * sizeof(*hashes));
+    }   while ( count > 0 );
+    bl_fastx_free(&rec);
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Hash a whole record: description, sequence, and quality if
+ *      FASTQ.  0 is reserved for empty count table slots.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+XXH64_hash_t record_hash(bl_fastx_t *rec)
+
+{
+    XXH64_hash_t    hash;
+
+    hash = XXH64(bl_fastx_desc(rec), bl_fastx_desc_len(rec), 0);
+    hash = XXH64(bl_fastx_seq(rec), bl_fastx_seq_len(rec), hash);
+    if ( BL_FASTX_FORMAT(rec) == BL_FASTX_FORMAT_FASTQ )
+	hash = XXH64(bl_fastx_qual(rec), bl_fastx_qual_len(rec), hash);
+    return hash == 0 ? 1 : hash;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return a pointer to the count for hash, or NULL if not present.
+ *      The table uses open addressing with linear probing.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int64_t *count_find(count_table_t *table, XXH64_hash_t hash)
+
+{
+    size_t  slot;
+
+    if ( table->size == 0 )
+	return NULL;
+    for (slot = hash & (table->size - 1); table->hashes[slot] != 0;
+	 slot = (slot + 1) & (table->size - 1))
+	if ( table->hashes[slot] == hash )
+	    return &table->counts[slot];
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add n to the count for hash, inserting it if necessary.  The
+ *      table is doubled when half full.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     count_add(count_table_t *table, XXH64_hash_t hash, int64_t n)
+
+{
+    count_table_t   new_table;
+    size_t          slot, c;
+
+    if ( table->used * 2 >= table->size )
+    {
+	new_table.size = table->size == 0 ? 1024 * 1024 : table->size * 2;
+	new_table.used = 0;
+	new_table.hashes = calloc(new_table.size, sizeof(*new_table.hashes));
+	new_table.counts = malloc(new_table.size * sizeof(*new_table.counts));
+	if ( (new_table.hashes == NULL) || (new_table.counts == NULL) )
+	{
+	    fputs("fastx-diff: Could not allocate hash table.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+	for (c = 0; c < table->size; ++c)
+	    if ( table->hashes[c] != 0 )
+		count_add(&new_table, table->hashes[c], table->counts[c]);
+	free(table->hashes);
+	free(table->counts);
+	*table = new_table;
+    }
+
+    for (slot = hash & (table->size - 1); table->hashes[slot] != 0;
+	 slot = (slot + 1) & (table->size - 1))
+	if ( table->hashes[slot] == hash )
+	{
+	    table->counts[slot] += n;
+	    return EX_OK;
+	}
+    table->hashes[slot] = hash;
+    table->counts[slot] = n;
+    ++table->used;
+    return EX_OK;
+}
+
+
+void    print_record(bl_fastx_t *rec, const char *prefix)
+
+{
+    printf("%s%s\n%s%s\n", prefix, bl_fastx_desc(rec),
+	   prefix, bl_fastx_seq(rec));
+    if ( BL_FASTX_FORMAT(rec) == BL_FASTX_FORMAT_FASTQ )
+	printf("%s+\n%s%s\n", prefix, prefix, bl_fastx_qual(rec));
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--unordered] file1 file2\n", argv[0]);
+    exit(EX_USAGE);
+}
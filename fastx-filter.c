@@ -0,0 +1,613 @@
+/***************************************************************************
+ *  Description:
+ *      Filter FASTA or FASTQ records by length, number of N bases, and
+ *      mean or sliding-window quality in a single streaming pass.
+ *
+ *      Each test is cheaper than the one after it and a record stops
+ *      at the first it fails.  Quality strings are summed 8 characters
+ *      at a time by phred_sum() and N bases are counted by a branch-free
+ *      loop the compiler can vectorize, so filtering adds little to the
+ *      cost of reading.  Records are read in batches, optionally
+ *      filtered by a pool of threads, and records kept are copied to a
+ *      large output buffer in input order, which is written with one
+ *      call when full.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <biolibc/fastx.h>
+#include "blt-phred.h"
+#include "blt-writer.h"
+#include "blt-zio.h"
+#include "blt-stage.h"
+#include "blt-profile.h"
+
+// Limits on records and bases buffered for one batch of threads
+#define BATCH_RECORDS   4096
+#define BATCH_BASES     (64 * 1024 * 1024)
+
+// Records claimed by a thread at a time, to keep locking negligible
+#define FILTER_CHUNK    256
+
+#define WRITER_SIZE     (1024 * 1024)
+
+// Verdicts: the first test a record fails
+enum
+{
+    FILTER_KEEP,
+    FILTER_LENGTH,
+    FILTER_N,
+    FILTER_MEAN_QUALITY,
+    FILTER_WINDOW_QUALITY,
+    FILTER_VERDICTS
+};
+
+typedef struct
+{
+    size_t      min_length,
+		max_length,
+		max_n,          // SIZE_MAX = unchecked
+		window;         // 0 = no window test
+    double      min_mean_quality,   // 0 = unchecked
+		min_window_quality;
+    int         offset;
+}   filter_t;
+
+typedef struct
+{
+    bl_fastx_t  *records;
+    uint8_t     *verdicts;
+    filter_t    *filter;
+    unsigned    count,
+		next;           // Next record to filter
+    pthread_mutex_t lock;
+}   filter_batch_t;
+
+// State of the "blt pipe" stage
+typedef struct
+{
+    filter_t    filter;
+    unsigned long   records,
+		    counts[FILTER_VERDICTS];
+    size_t      sampled;
+    unsigned char   min_qual;
+    bool        quality;
+}   filter_stage_t;
+
+void    filter_args(int argc, char *argv[], filter_t *filter,
+		    unsigned *threads, blt_stage_io_t *io);
+int     fastx_filter(FILE *instream, FILE *outstream, filter_t *filter,
+		     unsigned threads);
+void    filter_report(const unsigned long counts[], unsigned long records);
+void    *filter_worker(void *arg);
+int     filter_record(bl_fastx_t *rec, const filter_t *filter);
+size_t  count_n(const char *seq, size_t len);
+bool    window_quality_ok(const char *qual, size_t len, size_t window,
+			  double min_per_base);
+void    *filter_stage_open(int argc, char *argv[], blt_stage_io_t *io);
+bool    filter_stage_sample(void *state, blt_batch_t *batch, bool last);
+int     filter_stage_batch(void *state, blt_batch_t *batch);
+int     filter_stage_close(void *state, int status);
+void    usage(char *argv[]);
+
+const blt_stage_t   blt_fastx_filter_stage =
+{
+    "fastx-filter", filter_stage_open, filter_stage_sample,
+    filter_stage_batch, filter_stage_close
+};
+
+int     main(int argc,char *argv[])
+
+{
+    filter_t    filter;
+    blt_stage_io_t  io;
+    unsigned    threads;
+    int         status;
+    FILE        *instream, *outstream = stdout;
+
+    PROF_INIT("fastx-filter");
+
+    filter_args(argc, argv, &filter, &threads, &io);
+
+    if ( (instream = blt_zopen("-", io.threads)) == NULL )
+    {
+	fprintf(stderr, "fastx-filter: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( io.bgzf &&
+	 ((outstream = blt_bgzf_fdopen(STDOUT_FILENO, io.threads)) == NULL) )
+    {
+	fprintf(stderr, "fastx-filter: Cannot open BGZF output: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    status = fastx_filter(instream, outstream, &filter, threads);
+    blt_zclose(instream);
+    if ( (blt_zclose(outstream) != 0) && (status == EX_OK) )
+    {
+	fputs("fastx-filter: Error writing output.\n", stderr);
+	status = EX_IOERR;
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse command line arguments for main() and the "blt pipe"
+ *      stage.  Exits through usage() on errors.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    filter_args(int argc, char *argv[], filter_t *filter,
+		    unsigned *threads, blt_stage_io_t *io)
+
+{
+    int     arg;
+    char    *end;
+
+    filter->min_length = 0;
+    filter->max_length = filter->max_n = SIZE_MAX;
+    filter->window = 0;
+    filter->min_mean_quality = filter->min_window_quality = 0;
+    filter->offset = PHRED_OFFSET_AUTO;
+    *threads = 1;
+    io->threads = BLT_ZIO_THREADS_DEFAULT;
+    io->bgzf = false;
+    io->range_start = 0;
+    io->range_end = -1;
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	end = "";
+	if ( (strcmp(argv[arg], "--min-length") == 0) && (arg + 1 < argc) )
+	    filter->min_length = strtoull(argv[++arg], &end, 10);
+	else if ( (strcmp(argv[arg], "--max-length") == 0) && (arg + 1 < argc) )
+	    filter->max_length = strtoull(argv[++arg], &end, 10);
+	else if ( (strcmp(argv[arg], "--max-n") == 0) && (arg + 1 < argc) )
+	    filter->max_n = strtoull(argv[++arg], &end, 10);
+	else if ( (strcmp(argv[arg], "--min-mean-quality") == 0) &&
+		  (arg + 1 < argc) )
+	    filter->min_mean_quality = strtod(argv[++arg], &end);
+	else if ( (strcmp(argv[arg], "--window") == 0) && (arg + 1 < argc) )
+	    filter->window = strtoull(argv[++arg], &end, 10);
+	else if ( (strcmp(argv[arg], "--min-window-quality") == 0) &&
+		  (arg + 1 < argc) )
+	    filter->min_window_quality = strtod(argv[++arg], &end);
+	else if ( (strcmp(argv[arg], "--offset") == 0) && (arg + 1 < argc) )
+	{
+	    if ( (filter->offset = phred_parse_offset(argv[++arg])) == -1 )
+		usage(argv);
+	}
+	else if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    io->bgzf = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], threads) != 0 )
+		usage(argv);
+	    io->threads = *threads;
+	}
+	else
+	    usage(argv);
+	if ( *end != '\0' )
+	{
+	    fprintf(stderr, "Invalid value: %s\n", argv[arg]);
+	    usage(argv);
+	}
+    }
+    if ( (filter->min_length > filter->max_length) ||
+	 (filter->min_mean_quality < 0) || (filter->min_window_quality < 0) )
+    {
+	fputs("Invalid length or quality limits.\n", stderr);
+	usage(argv);
+    }
+    if ( (filter->window == 0) != (filter->min_window_quality == 0) )
+    {
+	fputs("--window and --min-window-quality must be used together.\n",
+	      stderr);
+	usage(argv);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read records in batches, filter each batch, and write the records
+ *      kept in input order.  If a quality test is enabled and the offset
+ *      is PHRED_OFFSET_AUTO, it is detected from the first records,
+ *      which become the start of the first batch.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fastx_filter(FILE *instream, FILE *outstream, filter_t *filter,
+		     unsigned threads)
+
+{
+    filter_batch_t  batch;
+    blt_writer_t    writer;
+    pthread_t   *tids;
+    unsigned long   records = 0, counts[FILTER_VERDICTS] = { 0 };
+    size_t      bases, sampled = 0;
+    unsigned    c, t, v;
+    int         status = BL_READ_OK, ex_status = EX_OK, error;
+    bool        quality = (filter->min_mean_quality > 0) ||
+			  (filter->window > 0);
+
+    batch.records = calloc(BATCH_RECORDS, sizeof(*batch.records));
+    batch.verdicts = calloc(BATCH_RECORDS, sizeof(*batch.verdicts));
+    tids = calloc(threads, sizeof(*tids));
+    if ( (batch.records == NULL) || (batch.verdicts == NULL) ||
+	 (tids == NULL) ||
+	 (blt_writer_init(&writer, outstream, WRITER_SIZE) != 0) )
+    {
+	fputs("fastx-filter: Could not allocate batch.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    for (c = 0; c < BATCH_RECORDS; ++c)
+	bl_fastx_init(&batch.records[c], instream);
+    if ( quality &&
+	 (BL_FASTX_FORMAT(&batch.records[0]) == BL_FASTX_FORMAT_FASTA) )
+    {
+	fputs("fastx-filter: Quality tests require FASTQ input.\n", stderr);
+	ex_status = EX_DATAERR;
+	status = BL_READ_EOF;
+    }
+    else if ( quality && (filter->offset == PHRED_OFFSET_AUTO) )
+    {
+	sampled = phred_sample(instream, batch.records, &filter->offset,
+			       &status);
+	// phred_sample() frees the record that hit EOF or an error
+	if ( status != BL_READ_OK )
+	    bl_fastx_init(&batch.records[sampled], instream);
+	fprintf(stderr, "fastx-filter: Detected Phred+%d input.\n",
+		filter->offset);
+    }
+    batch.filter = filter;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    while ( (sampled > 0) || (status == BL_READ_OK) )
+    {
+	PROF_START(ticks);
+	for (batch.count = sampled, bases = 0;
+	     (status == BL_READ_OK) && (batch.count < BATCH_RECORDS) &&
+	     (bases < BATCH_BASES) &&
+	     ((status = bl_fastx_read(&batch.records[batch.count], instream))
+		== BL_READ_OK);
+	     ++batch.count)
+	    bases += bl_fastx_seq_len(&batch.records[batch.count]);
+	sampled = 0;
+	PROF_STOP_IO(ticks, "read");
+	if ( batch.count == 0 )
+	    break;
+
+	PROF_RESTART(ticks);
+	batch.next = 0;
+	if ( threads == 1 )
+	    filter_worker(&batch);
+	else
+	{
+	    for (t = 0, error = 0; (t < threads) &&
+		 (t * FILTER_CHUNK < batch.count) &&
+		 ((error = pthread_create(&tids[t], NULL, filter_worker,
+					  &batch)) == 0); ++t)
+		;
+	    // Filter what the threads started, if any, have not claimed
+	    if ( error != 0 )
+		filter_worker(&batch);
+	    while ( t > 0 )
+		pthread_join(tids[--t], NULL);
+	}
+	PROF_STOP(ticks, "filter");
+
+	PROF_RESTART(ticks);
+	for (c = 0; c < batch.count; ++c)
+	{
+	    v = batch.verdicts[c];
+	    ++counts[v];
+	    if ( v == FILTER_KEEP )
+		blt_writer_record(&writer, &batch.records[c]);
+	    PROF_BYTES(bl_fastx_desc_len(&batch.records[c]) +
+		       bl_fastx_seq_len(&batch.records[c]) +
+		       bl_fastx_qual_len(&batch.records[c]));
+	}
+	records += batch.count;
+	PROF_RECORDS(batch.count);
+	PROF_STOP_IO(ticks, "write");
+    }
+    blt_writer_free(&writer);
+
+    for (c = 0; c < BATCH_RECORDS; ++c)
+	bl_fastx_free(&batch.records[c]);
+    free(batch.records);
+    free(batch.verdicts);
+    free(tids);
+    pthread_mutex_destroy(&batch.lock);
+
+    if ( ex_status != EX_OK )
+	return ex_status;
+    if ( status != BL_READ_EOF )
+    {
+	fprintf(stderr, "fastx-filter: Error reading record %lu.\n",
+		records + 1);
+	return EX_DATAERR;
+    }
+
+    filter_report(counts, records);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print the number of records kept and removed by each test.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    filter_report(const unsigned long counts[], unsigned long records)
+
+{
+    static const char   *reasons[FILTER_VERDICTS] =
+	{ "kept", "length", "N", "mean quality", "window quality" };
+    unsigned    v;
+
+    fprintf(stderr, "fastx-filter: %lu of %lu records kept", counts[0],
+	    records);
+    for (v = FILTER_KEEP + 1; v < FILTER_VERDICTS; ++v)
+	if ( counts[v] > 0 )
+	    fprintf(stderr, ", %lu failed %s", counts[v], reasons[v]);
+    fputs(".\n", stderr);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: claim FILTER_CHUNK records at a time from the
+ *      batch and record a verdict for each, until none are left.  Also
+ *      called directly when filtering on one thread, or when a thread
+ *      cannot be created.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *filter_worker(void *arg)
+
+{
+    filter_batch_t  *batch = arg;
+    unsigned    c, end;
+
+    while ( true )
+    {
+	pthread_mutex_lock(&batch->lock);
+	c = batch->next;
+	batch->next += FILTER_CHUNK;
+	pthread_mutex_unlock(&batch->lock);
+	if ( c >= batch->count )
+	    break;
+
+	end = c + FILTER_CHUNK < batch->count ? c + FILTER_CHUNK : batch->count;
+	for (; c < end; ++c)
+	    batch->verdicts[c] = filter_record(&batch->records[c],
+					       batch->filter);
+    }
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Apply the tests in order of cost and return the verdict for one
+ *      record.  Quality limits are converted to limits on the sum of
+ *      the quality characters, so scores are never computed.
+ *
+ *  Returns:
+ *      FILTER_KEEP or the first test failed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     filter_record(bl_fastx_t *rec, const filter_t *filter)
+
+{
+    size_t  len = bl_fastx_seq_len(rec), qual_len;
+    char    *qual;
+
+    if ( (len < filter->min_length) || (len > filter->max_length) )
+	return FILTER_LENGTH;
+    if ( (filter->max_n != SIZE_MAX) &&
+	 (count_n(bl_fastx_seq(rec), len) > filter->max_n) )
+	return FILTER_N;
+    if ( (filter->min_mean_quality > 0) || (filter->window > 0) )
+    {
+	qual = bl_fastx_qual(rec);
+	qual_len = bl_fastx_qual_len(rec);
+	if ( (filter->min_mean_quality > 0) &&
+	     (phred_sum(qual, qual_len) <
+	      (filter->min_mean_quality + filter->offset) * qual_len) )
+	    return FILTER_MEAN_QUALITY;
+	if ( (filter->window > 0) &&
+	     !window_quality_ok(qual, qual_len, filter->window,
+				filter->min_window_quality + filter->offset) )
+	    return FILTER_WINDOW_QUALITY;
+    }
+    return FILTER_KEEP;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count N bases, upper or lower case.  The loop has no branches
+ *      so that it vectorizes.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  count_n(const char *seq, size_t len)
+
+{
+    size_t  c, n = 0;
+
+    for (c = 0; c < len; ++c)
+	n += (seq[c] | 0x20) == 'n';
+    return n;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check that every window of the given width has a mean quality
+ *      character of at least min_per_base, using a running sum.  A
+ *      quality string shorter than the window is checked as a whole.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    window_quality_ok(const char *qual, size_t len, size_t window,
+			  double min_per_base)
+
+{
+    const unsigned char *q = (const unsigned char *)qual;
+    uint64_t    sum;
+    double      min_sum;
+    size_t      c;
+
+    if ( len < window )
+	window = len;
+    if ( window == 0 )
+	return true;
+    min_sum = min_per_base * window;
+    if ( (sum = phred_sum(qual, window)) < min_sum )
+	return false;
+    for (c = window; c < len; ++c)
+    {
+	sum = sum + q[c] - q[c - window];
+	if ( sum < min_sum )
+	    return false;
+    }
+    return true;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stage functions for "blt pipe", which passes batches of parsed
+ *      records between subcommands in one process.  Each batch is
+ *      filtered on the stage's own thread, so --threads sets only the
+ *      BGZF threads here.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *filter_stage_open(int argc, char *argv[], blt_stage_io_t *io)
+
+{
+    filter_stage_t  *stage;
+    unsigned        threads;
+
+    if ( (stage = calloc(1, sizeof(*stage))) == NULL )
+	return NULL;
+    filter_args(argc, argv, &stage->filter, &threads, io);
+    stage->quality = (stage->filter.min_mean_quality > 0) ||
+		     (stage->filter.window > 0);
+    stage->min_qual = 255;
+    return stage;
+}
+
+
+bool    filter_stage_sample(void *state, blt_batch_t *batch, bool last)
+
+{
+    filter_stage_t  *stage = state;
+
+    // FASTA input with quality tests is reported by filter_stage_batch()
+    if ( !stage->quality || (stage->filter.offset != PHRED_OFFSET_AUTO) ||
+	 ((batch->count > 0) && (BL_FASTX_FORMAT(&batch->records[0]) ==
+				 BL_FASTX_FORMAT_FASTA)) )
+	return true;
+    if ( !phred_sample_batch(batch->records, batch->count, &stage->sampled,
+			     &stage->min_qual, last, &stage->filter.offset) )
+	return false;
+    fprintf(stderr, "fastx-filter: Detected Phred+%d input.\n",
+	    stage->filter.offset);
+    return true;
+}
+
+
+int     filter_stage_batch(void *state, blt_batch_t *batch)
+
+{
+    filter_stage_t  *stage = state;
+    unsigned    c, kept, v;
+
+    if ( stage->quality && (batch->count > 0) &&
+	 (BL_FASTX_FORMAT(&batch->records[0]) == BL_FASTX_FORMAT_FASTA) )
+    {
+	fputs("fastx-filter: Quality tests require FASTQ input.\n", stderr);
+	batch->count = 0;
+	return EX_DATAERR;
+    }
+    for (c = kept = 0; c < batch->count; ++c)
+    {
+	v = filter_record(&batch->records[c], &stage->filter);
+	++stage->counts[v];
+	if ( v == FILTER_KEEP )
+	    blt_batch_keep(batch, c, kept++);
+    }
+    stage->records += batch->count;
+    batch->count = kept;
+    return EX_OK;
+}
+
+
+int     filter_stage_close(void *state, int status)
+
+{
+    filter_stage_t  *stage = state;
+
+    if ( status == EX_OK )
+	filter_report(stage->counts, stage->records);
+    free(stage);
+    return status;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--min-length N] [--max-length N] [--max-n N]\n"
+		    "\t[--min-mean-quality Q] [--window W --min-window-quality Q]\n"
+		    "\t[--offset 33|64] [--threads N] [--bgzf]\n"
+		    "\t< in.fastx > out.fastx\n", argv[0]);
+    exit(EX_USAGE);
+}
@@ -0,0 +1,1487 @@
+/***************************************************************************
+ *  Description:
+ *      Count canonical k-mers (k <= 32) in FASTA or FASTQ files, for
+ *      contamination and library complexity checks.
+ *
+ *      Each base is encoded as 2 bits and forward and reverse complement
+ *      k-mers are updated by rolling shifts, so each base costs a few
+ *      instructions.  Bases other than ACGTU restart the k-mer.
+ *
+ *      Records are read in batches with bl_fastx_read(), overlapped with
+ *      counting of the previous batch by a pool of worker threads.  Long
+ *      records are split into overlapping segments so that a genome
+ *      uses every thread too.  Counts are kept in an open-addressing
+ *      hash table split into 256 shards, each with its own lock.  Each
+ *      worker buffers k-mers per shard and inserts them a few hundred at
+ *      a time, so locks are rarely contended and shards grow
+ *      independently.
+ *
+ *      With --partitions N, memory is bounded by the largest of N
+ *      partitions rather than the whole table.  In the first pass,
+ *      runs of consecutive k-mers that map to the same partition
+ *      ("super-k-mers") are written 2 bits per base to N temporary
+ *      files.  The partition of a k-mer is chosen by its minimizer, the
+ *      smallest hash of its canonical m-mers, so a k-mer and its reverse
+ *      complement always land in the same partition, and neighboring
+ *      k-mers usually share a partition, which keeps the files small.
+ *      Each partition is then counted and sorted on its own, and the
+ *      sorted partitions are merged.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <biolibc/fastx.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+#define KMER_MAX        32
+#define MINIMIZER_LEN   13
+
+// Limits on one batch of records, and on the segments a record is split
+// into so that long sequences are shared among threads
+#define BATCH_RECORDS   16384
+#define BATCH_BASES     (32 * 1024 * 1024)
+#define SEGMENT_BASES   (1024 * 1024)
+#define CLAIM_SEGMENTS  64
+
+#define SHARDS          256
+#define SHARD_BITS      8
+#define SHARD_INIT      4096    // Slots, a power of 2
+#define PENDING         256     // k-mers buffered per shard per worker
+
+#define PARTITIONS_MAX  4096
+#define PART_BUFF_SIZE  8192
+#define SUPER_KMERS_MAX 1024    // k-mers per super-k-mer
+#define CHUNK_BYTES     (256 * 1024)
+
+#define HIST_DIRECT     65536   // Counts below this are binned directly
+#define BINARY_MAGIC    "BLTK"
+
+typedef enum
+{
+    OUTPUT_TSV,
+    OUTPUT_BINARY,
+    OUTPUT_HISTOGRAM
+}   output_t;
+
+typedef enum
+{
+    MODE_COUNT,                 // Count k-mers in sequences
+    MODE_SPLIT,                 // Write super-k-mers to partitions
+    MODE_PACKED                 // Count k-mers in packed super-k-mers
+}   kmer_mode_t;
+
+typedef struct
+{
+    uint64_t    kmer;
+    uint64_t    count;          // 0 for an empty slot
+}   kmer_count_t;
+
+typedef struct
+{
+    kmer_count_t    *slots;
+    size_t          capacity,
+		    used;
+    pthread_mutex_t lock;
+}   shard_t;
+
+typedef struct
+{
+    FILE            *stream;
+    pthread_mutex_t lock;
+}   partition_t;
+
+typedef struct
+{
+    unsigned        k,
+		    m,          // Minimizer length
+		    threads,
+		    partition_count;
+    uint64_t        mask,
+		    m_mask,
+		    min_count;
+    output_t        format;
+    const char      *tmpdir;
+    shard_t         shards[SHARDS];
+    partition_t     *partitions;
+    uint64_t        hist[HIST_DIRECT],
+		    *big_counts;
+    size_t          big_used,
+		    big_size;
+}   kmers_t;
+
+typedef struct
+{
+    const char  *data;
+    size_t      len;
+}   segment_t;
+
+typedef struct
+{
+    kmer_mode_t     mode;
+    bl_fastx_t      *records;
+    unsigned        record_count;
+    segment_t       *segments;
+    size_t          segment_count,
+		    segment_size,
+		    next;       // Next segment to claim
+    pthread_mutex_t lock;
+}   batch_t;
+
+typedef struct
+{
+    kmers_t         *kmers;
+    batch_t         *batch;
+    pthread_t       tid;
+    uint64_t        *pending;
+    unsigned        pending_count[SHARDS];
+    unsigned char   *part_buff;
+    size_t          *part_len;
+    uint64_t        *mhash;     // m-mer hashes of one run
+    size_t          *window;    // Sliding minimum deque
+    size_t          run_size;
+    char            *bases;     // One unpacked super-k-mer
+}   worker_t;
+
+int     kmers_init(kmers_t *kmers);
+int     count_file(kmers_t *kmers, worker_t *workers, const char *filename,
+		   kmer_mode_t mode);
+int     count_stream(kmers_t *kmers, worker_t *workers, FILE *stream,
+		     kmer_mode_t mode);
+int     read_batch(batch_t *batch, FILE *stream, unsigned k);
+void    add_segment(batch_t *batch, const char *data, size_t len);
+void    run_batch(kmers_t *kmers, worker_t *workers, batch_t *batch);
+void    join_batch(kmers_t *kmers, worker_t *workers);
+void    *kmer_worker(void *arg);
+void    count_seq(worker_t *worker, const char *seq, size_t len);
+void    count_packed(worker_t *worker, const unsigned char *data,
+		     size_t len);
+void    split_seq(worker_t *worker, const char *seq, size_t len);
+void    split_run(worker_t *worker, const char *seq, size_t len);
+void    emit_super_kmer(worker_t *worker, unsigned part, const char *seq,
+			size_t len);
+void    part_flush(worker_t *worker, unsigned part);
+void    pending_flush(worker_t *worker, unsigned shard);
+void    shard_insert(shard_t *shard, const uint64_t *kmers, unsigned count);
+void    shard_grow(shard_t *shard);
+int     count_partitions(kmers_t *kmers, worker_t *workers, FILE *outstream);
+int     count_partition(kmers_t *kmers, worker_t *workers, FILE *stream);
+int     table_output(kmers_t *kmers, FILE *outstream, bool partition);
+void    table_clear(kmers_t *kmers);
+void    hist_add(kmers_t *kmers, uint64_t count);
+int     hist_write(kmers_t *kmers, FILE *outstream);
+int     merge_sorted(kmers_t *kmers, FILE **streams, unsigned count,
+		     FILE *outstream);
+void    kmer_sort(kmer_count_t *kcs, size_t count, unsigned k);
+void    kmer_write(kmers_t *kmers, FILE *outstream, const kmer_count_t *kc);
+int     kmer_cmp(const void *p1, const void *p2);
+int     uint64_cmp(const void *p1, const void *p2);
+FILE    *temp_open(const char *dir);
+void    usage(char *argv[]);
+
+static inline uint64_t  kmer_hash(uint64_t kmer);
+
+static int8_t   Base_code[256];
+
+int     main(int argc,char *argv[])
+
+{
+    kmers_t     *kmers;
+    worker_t    *workers;
+    kmer_mode_t mode;
+    long        val, cpus;
+    unsigned    threads;
+    int         arg, status = EX_OK;
+    unsigned    c;
+    char        *end;
+
+    PROF_INIT("fastx-kmers");
+
+    if ( (kmers = calloc(1, sizeof(*kmers))) == NULL )
+    {
+	fputs("fastx-kmers: Could not allocate counter.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1 ? 1 : cpus;
+    kmers->k = 21;
+    kmers->min_count = 1;
+    kmers->format = OUTPUT_TSV;
+    if ( (kmers->tmpdir = getenv("TMPDIR")) == NULL )
+	kmers->tmpdir = "/tmp";
+
+    for (arg = 1; (arg < argc) && (argv[arg][0] == '-') &&
+		  (argv[arg][1] != '\0'); ++arg)
+    {
+	if ( (strcmp(argv[arg], "-k") == 0) && (arg + 1 < argc) )
+	{
+	    val = strtol(argv[++arg], &end, 10);
+	    if ( (*end != '\0') || (val < 1) || (val > KMER_MAX) )
+	    {
+		fprintf(stderr, "Invalid k: %s (must be 1 to %d)\n",
+			argv[arg], KMER_MAX);
+		usage(argv);
+	    }
+	    kmers->k = val;
+	}
+	else if ( (strcmp(argv[arg], "--min-count") == 0) && (arg + 1 < argc) )
+	{
+	    kmers->min_count = strtoull(argv[++arg], &end, 10);
+	    if ( (*end != '\0') || (kmers->min_count < 1) )
+	    {
+		fprintf(stderr, "Invalid minimum count: %s\n", argv[arg]);
+		usage(argv);
+	    }
+	}
+	else if ( strcmp(argv[arg], "--binary") == 0 )
+	    kmers->format = OUTPUT_BINARY;
+	else if ( strcmp(argv[arg], "--histogram") == 0 )
+	    kmers->format = OUTPUT_HISTOGRAM;
+	else if ( (strcmp(argv[arg], "--partitions") == 0) && (arg + 1 < argc) )
+	{
+	    val = strtol(argv[++arg], &end, 10);
+	    if ( (*end != '\0') || (val < 1) || (val > PARTITIONS_MAX) )
+	    {
+		fprintf(stderr, "Invalid partition count: %s (must be 1 to "
+			"%d)\n", argv[arg], PARTITIONS_MAX);
+		usage(argv);
+	    }
+	    kmers->partition_count = val;
+	}
+	else if ( (strcmp(argv[arg], "--tmpdir") == 0) && (arg + 1 < argc) )
+	    kmers->tmpdir = argv[++arg];
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+    kmers->threads = threads;
+    if ( kmers_init(kmers) != EX_OK )
+	return EX_UNAVAILABLE;
+
+    if ( (workers = calloc(threads, sizeof(*workers))) == NULL )
+    {
+	fputs("fastx-kmers: Could not allocate workers.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    for (c = 0; c < threads; ++c)
+    {
+	workers[c].kmers = kmers;
+	workers[c].pending = malloc(SHARDS * PENDING *
+				    sizeof(*workers[c].pending));
+	if ( kmers->partition_count > 0 )
+	{
+	    workers[c].part_buff = malloc(kmers->partition_count *
+					  PART_BUFF_SIZE);
+	    workers[c].part_len = calloc(kmers->partition_count,
+					 sizeof(*workers[c].part_len));
+	}
+	workers[c].bases = malloc(SUPER_KMERS_MAX + KMER_MAX);
+	if ( (workers[c].pending == NULL) || (workers[c].bases == NULL) ||
+	     ((kmers->partition_count > 0) &&
+	      ((workers[c].part_buff == NULL) ||
+	       (workers[c].part_len == NULL))) )
+	{
+	    fputs("fastx-kmers: Could not allocate worker buffers.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+    }
+
+    mode = kmers->partition_count > 0 ? MODE_SPLIT : MODE_COUNT;
+    if ( arg == argc )
+	status = count_file(kmers, workers, "-", mode);
+    for (; (arg < argc) && (status == EX_OK); ++arg)
+	status = count_file(kmers, workers, argv[arg], mode);
+
+    if ( status == EX_OK )
+    {
+	if ( kmers->partition_count > 0 )
+	    status = count_partitions(kmers, workers, stdout);
+	else
+	    status = table_output(kmers, stdout, false);
+    }
+    if ( (status == EX_OK) && (kmers->format == OUTPUT_HISTOGRAM) )
+	status = hist_write(kmers, stdout);
+    if ( (fflush(stdout) != 0) && (status == EX_OK) )
+    {
+	fprintf(stderr, "fastx-kmers: Error writing output: %s\n",
+		strerror(errno));
+	status = EX_IOERR;
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Build the base code table, allocate the shards, and create the
+ *      partition files if requested.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     kmers_init(kmers_t *kmers)
+
+{
+    unsigned    c;
+
+    memset(Base_code, -1, sizeof(Base_code));
+    Base_code['A'] = Base_code['a'] = 0;
+    Base_code['C'] = Base_code['c'] = 1;
+    Base_code['G'] = Base_code['g'] = 2;
+    Base_code['T'] = Base_code['t'] = Base_code['U'] = Base_code['u'] = 3;
+
+    kmers->mask = kmers->k == 32 ? UINT64_MAX : (1ULL << (2 * kmers->k)) - 1;
+    kmers->m = kmers->k < MINIMIZER_LEN ? kmers->k : MINIMIZER_LEN;
+    kmers->m_mask = (1ULL << (2 * kmers->m)) - 1;
+
+    for (c = 0; c < SHARDS; ++c)
+    {
+	kmers->shards[c].capacity = SHARD_INIT;
+	kmers->shards[c].slots = calloc(SHARD_INIT,
+					sizeof(*kmers->shards[c].slots));
+	if ( kmers->shards[c].slots == NULL )
+	{
+	    fputs("fastx-kmers: Could not allocate hash table.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+	pthread_mutex_init(&kmers->shards[c].lock, NULL);
+    }
+
+    if ( kmers->partition_count > 0 )
+    {
+	kmers->partitions = calloc(kmers->partition_count,
+				   sizeof(*kmers->partitions));
+	if ( kmers->partitions == NULL )
+	{
+	    fputs("fastx-kmers: Could not allocate partitions.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+	for (c = 0; c < kmers->partition_count; ++c)
+	{
+	    if ( (kmers->partitions[c].stream = temp_open(kmers->tmpdir))
+		    == NULL )
+		return EX_CANTCREAT;
+	    pthread_mutex_init(&kmers->partitions[c].lock, NULL);
+	}
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count or split all records in filename ("-" for stdin).  gzip
+ *      and BGZF input is decompressed on other cores.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     count_file(kmers_t *kmers, worker_t *workers, const char *filename,
+		   kmer_mode_t mode)
+
+{
+    FILE    *instream;
+    int     status;
+
+    if ( (instream = blt_zopen(filename, kmers->threads)) == NULL )
+    {
+	fprintf(stderr, "fastx-kmers: Cannot open %s: %s\n",
+		strcmp(filename, "-") == 0 ? "input" : filename,
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    status = count_stream(kmers, workers, instream, mode);
+    blt_zclose(instream);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count or split all records in stream.  The next batch is read
+ *      while workers process the current one.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     count_stream(kmers_t *kmers, worker_t *workers, FILE *stream,
+		     kmer_mode_t mode)
+
+{
+    batch_t     batches[2];
+    unsigned    b, c;
+    int         status;
+
+    memset(batches, 0, sizeof(batches));
+    for (b = 0; b < 2; ++b)
+    {
+	batches[b].mode = mode;
+	batches[b].records = calloc(BATCH_RECORDS,
+				    sizeof(*batches[b].records));
+	if ( batches[b].records == NULL )
+	{
+	    fputs("fastx-kmers: Could not allocate batch.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+	for (c = 0; c < BATCH_RECORDS; ++c)
+	    bl_fastx_init(&batches[b].records[c], stream);
+	pthread_mutex_init(&batches[b].lock, NULL);
+    }
+
+    PROF_START(t);
+    status = read_batch(&batches[0], stream, kmers->k);
+    PROF_STOP_IO(t, "read");
+    for (b = 0; batches[b].record_count > 0; b = !b)
+    {
+	run_batch(kmers, workers, &batches[b]);
+	batches[!b].record_count = 0;
+	if ( status == BL_READ_OK )
+	{
+	    PROF_RESTART(t);
+	    status = read_batch(&batches[!b], stream, kmers->k);
+	    PROF_STOP_IO(t, "read");
+	}
+	PROF_RESTART(t);
+	join_batch(kmers, workers);
+	PROF_STOP(t, "count");
+    }
+
+    for (b = 0; b < 2; ++b)
+    {
+	for (c = 0; c < BATCH_RECORDS; ++c)
+	    bl_fastx_free(&batches[b].records[c]);
+	free(batches[b].records);
+	free(batches[b].segments);
+	pthread_mutex_destroy(&batches[b].lock);
+    }
+
+    if ( status != BL_READ_EOF )
+    {
+	fprintf(stderr, "fastx-kmers: Error reading input: %s\n",
+		strerror(errno));
+	return EX_DATAERR;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read records into batch until it is full, splitting sequences
+ *      longer than SEGMENT_BASES into segments that overlap by k - 1
+ *      bases, so every k-mer lies in exactly one segment.
+ *
+ *  Returns:
+ *      The status of the last bl_fastx_read(), BL_READ_OK if the batch
+ *      filled up
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     read_batch(batch_t *batch, FILE *stream, unsigned k)
+
+{
+    bl_fastx_t  *rec;
+    const char  *seq;
+    size_t      bases = 0, len, start;
+    int         status = BL_READ_OK;
+
+    batch->segment_count = 0;
+    for (batch->record_count = 0;
+	 (batch->record_count < BATCH_RECORDS) && (bases < BATCH_BASES);
+	 ++batch->record_count)
+    {
+	rec = &batch->records[batch->record_count];
+	if ( (status = bl_fastx_read(rec, stream)) != BL_READ_OK )
+	    break;
+	PROF_RECORDS(1);
+	// Excluding line breaks and the FASTQ '+' line
+	PROF_BYTES(bl_fastx_desc_len(rec) + bl_fastx_seq_len(rec) +
+		   bl_fastx_qual_len(rec));
+	seq = bl_fastx_seq(rec);
+	len = bl_fastx_seq_len(rec);
+	bases += len;
+	for (start = 0; start + k <= len; start += SEGMENT_BASES)
+	    add_segment(batch, seq + start,
+			len - start > SEGMENT_BASES + k - 1 ?
+			SEGMENT_BASES + k - 1 : len - start);
+    }
+    return status;
+}
+
+
+void    add_segment(batch_t *batch, const char *data, size_t len)
+
+{
+    segment_t   *new_segments;
+
+    if ( batch->segment_count == batch->segment_size )
+    {
+	batch->segment_size = batch->segment_size == 0 ? BATCH_RECORDS :
+			      batch->segment_size * 2;
+	new_segments = realloc(batch->segments,
+			       batch->segment_size * sizeof(*new_segments));
+	if ( new_segments == NULL )
+	{
+	    fputs("fastx-kmers: Could not allocate segments.\n", stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+	batch->segments = new_segments;
+    }
+    batch->segments[batch->segment_count].data = data;
+    batch->segments[batch->segment_count++].len = len;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Start the workers on a batch.  join_batch() waits for them.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    run_batch(kmers_t *kmers, worker_t *workers, batch_t *batch)
+
+{
+    unsigned    t;
+
+    batch->next = 0;
+    for (t = 0; t < kmers->threads; ++t)
+    {
+	workers[t].batch = batch;
+	if ( pthread_create(&workers[t].tid, NULL, kmer_worker,
+			    &workers[t]) != 0 )
+	{
+	    fputs("fastx-kmers: Could not create thread.\n", stderr);
+	    exit(EX_OSERR);
+	}
+    }
+}
+
+
+void    join_batch(kmers_t *kmers, worker_t *workers)
+
+{
+    unsigned    t;
+
+    for (t = 0; t < kmers->threads; ++t)
+	pthread_join(workers[t].tid, NULL);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: process segments from the batch until none are
+ *      left, then flush buffered k-mers and super-k-mers.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *kmer_worker(void *arg)
+
+{
+    worker_t    *worker = arg;
+    batch_t     *batch = worker->batch;
+    size_t      first, last, c;
+    unsigned    s;
+
+    memset(worker->pending_count, 0, sizeof(worker->pending_count));
+    while ( true )
+    {
+	pthread_mutex_lock(&batch->lock);
+	first = batch->next;
+	batch->next += CLAIM_SEGMENTS;
+	pthread_mutex_unlock(&batch->lock);
+	if ( first >= batch->segment_count )
+	    break;
+	last = first + CLAIM_SEGMENTS < batch->segment_count ?
+	       first + CLAIM_SEGMENTS : batch->segment_count;
+
+	for (c = first; c < last; ++c)
+	{
+	    switch(batch->mode)
+	    {
+		case MODE_COUNT:
+		    count_seq(worker, batch->segments[c].data,
+			      batch->segments[c].len);
+		    break;
+		case MODE_SPLIT:
+		    split_seq(worker, batch->segments[c].data,
+			      batch->segments[c].len);
+		    break;
+		case MODE_PACKED:
+		    count_packed(worker,
+				 (const unsigned char *)batch->segments[c].data,
+				 batch->segments[c].len);
+		    break;
+	    }
+	}
+    }
+
+    for (s = 0; s < SHARDS; ++s)
+	pending_flush(worker, s);
+    if ( batch->mode == MODE_SPLIT )
+	for (s = 0; s < worker->kmers->partition_count; ++s)
+	    part_flush(worker, s);
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count the canonical k-mers of seq.  Forward and reverse
+ *      complement k-mers are rolled one base at a time and the smaller
+ *      is counted.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    count_seq(worker_t *worker, const char *seq, size_t len)
+
+{
+    kmers_t     *kmers = worker->kmers;
+    uint64_t    fwd = 0, rev = 0, mask = kmers->mask, canon;
+    unsigned    k = kmers->k, shift = 2 * (k - 1), valid = 0, shard;
+    size_t      c;
+    int         code;
+
+    for (c = 0; c < len; ++c)
+    {
+	if ( (code = Base_code[(unsigned char)seq[c]]) < 0 )
+	{
+	    valid = 0;
+	    continue;
+	}
+	fwd = ((fwd << 2) | code) & mask;
+	rev = (rev >> 2) | ((uint64_t)(3 - code) << shift);
+	if ( ++valid >= k )
+	{
+	    canon = fwd < rev ? fwd : rev;
+	    shard = kmer_hash(canon) >> (64 - SHARD_BITS);
+	    worker->pending[shard * PENDING +
+			    worker->pending_count[shard]++] = canon;
+	    if ( worker->pending_count[shard] == PENDING )
+		pending_flush(worker, shard);
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count the k-mers of a run of packed super-k-mers, each a 4-byte
+ *      base count followed by bases packed 4 per byte
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    count_packed(worker_t *worker, const unsigned char *data, size_t len)
+
+{
+    const unsigned char *p = data, *end = data + len;
+    uint32_t            bases, c;
+
+    while ( p < end )
+    {
+	memcpy(&bases, p, sizeof(bases));
+	p += sizeof(bases);
+	for (c = 0; c < bases; ++c)
+	    worker->bases[c] = "ACGT"[(p[c >> 2] >> (6 - 2 * (c & 3))) & 3];
+	count_seq(worker, worker->bases, bases);
+	p += (bases + 3) / 4;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write the super-k-mers of each run of unambiguous bases in seq to
+ *      their partitions
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    split_seq(worker_t *worker, const char *seq, size_t len)
+
+{
+    size_t      start, c;
+
+    for (start = 0, c = 0; c <= len; ++c)
+    {
+	if ( (c == len) || (Base_code[(unsigned char)seq[c]] < 0) )
+	{
+	    if ( c - start >= worker->kmers->k )
+		split_run(worker, seq + start, c - start);
+	    start = c + 1;
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Assign each k-mer of an unambiguous run to the partition of its
+ *      minimizer and write maximal runs of k-mers with the same
+ *      partition as super-k-mers.  Minimizers over the sliding window
+ *      of k - m + 1 m-mers are maintained with a monotonic deque.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    split_run(worker_t *worker, const char *seq, size_t len)
+
+{
+    kmers_t     *kmers = worker->kmers;
+    unsigned    m = kmers->m, w = kmers->k - m + 1,
+		shift = 2 * (m - 1), part, cur_part = 0;
+    uint64_t    fwd = 0, rev = 0, *mhash;
+    size_t      *window, head = 0, tail = 0, mmers = len - m + 1,
+		c, j, first = 0;
+    void        *new_mhash, *new_window;
+    int         code;
+
+    if ( mmers > worker->run_size )
+    {
+	new_mhash = realloc(worker->mhash, mmers * sizeof(*worker->mhash));
+	if ( new_mhash != NULL )
+	    worker->mhash = new_mhash;
+	new_window = realloc(worker->window, mmers * sizeof(*worker->window));
+	if ( new_window != NULL )
+	    worker->window = new_window;
+	if ( (new_mhash == NULL) || (new_window == NULL) )
+	{
+	    fputs("fastx-kmers: Could not allocate minimizer arrays.\n",
+		  stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+	worker->run_size = mmers;
+    }
+    mhash = worker->mhash;
+    window = worker->window;
+
+    for (c = 0; c < len; ++c)
+    {
+	code = Base_code[(unsigned char)seq[c]];
+	fwd = ((fwd << 2) | code) & kmers->m_mask;
+	rev = (rev >> 2) | ((uint64_t)(3 - code) << shift);
+	if ( c + 1 < m )
+	    continue;
+
+	// m-mer j ends at base c
+	j = c + 1 - m;
+	mhash[j] = kmer_hash(fwd < rev ? fwd : rev);
+	while ( (tail > head) && (mhash[window[tail - 1]] >= mhash[j]) )
+	    --tail;
+	window[tail++] = j;
+	if ( j + 1 < w )
+	    continue;
+
+	// k-mer j + 1 - w covers m-mers j + 1 - w through j
+	if ( window[head] + w <= j )
+	    ++head;
+	part = mhash[window[head]] % kmers->partition_count;
+	if ( j + 1 == w )
+	    cur_part = part;
+	else if ( (part != cur_part) ||
+		  (j + 1 - w - first == SUPER_KMERS_MAX) )
+	{
+	    emit_super_kmer(worker, cur_part, seq + first,
+			    j - w - first + kmers->k);
+	    first = j + 1 - w;
+	    cur_part = part;
+	}
+    }
+    emit_super_kmer(worker, cur_part, seq + first, len - first);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append a super-k-mer to the worker's buffer for a partition,
+ *      packed 4 bases per byte after a 4-byte base count
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    emit_super_kmer(worker_t *worker, unsigned part, const char *seq,
+			size_t len)
+
+{
+    unsigned char   *p;
+    uint32_t        bases = len;
+    size_t          c;
+
+    if ( worker->part_len[part] + sizeof(bases) + (len + 3) / 4 >
+	    PART_BUFF_SIZE )
+	part_flush(worker, part);
+    p = worker->part_buff + part * PART_BUFF_SIZE + worker->part_len[part];
+    memcpy(p, &bases, sizeof(bases));
+    p += sizeof(bases);
+    memset(p, 0, (len + 3) / 4);
+    for (c = 0; c < len; ++c)
+	p[c >> 2] |= Base_code[(unsigned char)seq[c]] << (6 - 2 * (c & 3));
+    worker->part_len[part] += sizeof(bases) + (len + 3) / 4;
+}
+
+
+void    part_flush(worker_t *worker, unsigned part)
+
+{
+    partition_t *partition = &worker->kmers->partitions[part];
+
+    if ( worker->part_len[part] == 0 )
+	return;
+    pthread_mutex_lock(&partition->lock);
+    fwrite(worker->part_buff + part * PART_BUFF_SIZE, 1,
+	   worker->part_len[part], partition->stream);
+    pthread_mutex_unlock(&partition->lock);
+    worker->part_len[part] = 0;
+}
+
+
+void    pending_flush(worker_t *worker, unsigned shard)
+
+{
+    if ( worker->pending_count[shard] == 0 )
+	return;
+    shard_insert(&worker->kmers->shards[shard],
+		 worker->pending + shard * PENDING,
+		 worker->pending_count[shard]);
+    worker->pending_count[shard] = 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add one occurrence of each k-mer to a shard, under its lock.
+ *      Shards use linear probing and double at 70% load.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    shard_insert(shard_t *shard, const uint64_t *kmers, unsigned count)
+
+{
+    kmer_count_t    *slot;
+    size_t          mask, c;
+    unsigned        i;
+
+    pthread_mutex_lock(&shard->lock);
+    for (i = 0; i < count; ++i)
+    {
+	if ( (shard->used + 1) * 10 > shard->capacity * 7 )
+	    shard_grow(shard);
+	mask = shard->capacity - 1;
+	for (c = kmer_hash(kmers[i]) & mask; ; c = (c + 1) & mask)
+	{
+	    slot = &shard->slots[c];
+	    if ( slot->count == 0 )
+	    {
+		slot->kmer = kmers[i];
+		slot->count = 1;
+		++shard->used;
+		break;
+	    }
+	    if ( slot->kmer == kmers[i] )
+	    {
+		++slot->count;
+		break;
+	    }
+	}
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+
+void    shard_grow(shard_t *shard)
+
+{
+    kmer_count_t    *old = shard->slots, *new_slots;
+    size_t          old_capacity = shard->capacity, mask, c, s;
+
+    if ( (new_slots = calloc(old_capacity * 2, sizeof(*new_slots))) == NULL )
+    {
+	fputs("fastx-kmers: Could not grow hash table.  "
+	      "Try --partitions.\n", stderr);
+	exit(EX_UNAVAILABLE);
+    }
+    shard->slots = new_slots;
+    shard->capacity = old_capacity * 2;
+    mask = shard->capacity - 1;
+    for (s = 0; s < old_capacity; ++s)
+    {
+	if ( old[s].count == 0 )
+	    continue;
+	for (c = kmer_hash(old[s].kmer) & mask; new_slots[c].count != 0;
+	     c = (c + 1) & mask)
+	    ;
+	new_slots[c] = old[s];
+    }
+    free(old);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Count each partition in turn, writing sorted counts to a
+ *      temporary file per partition, then merge them to outstream.
+ *      For a histogram, counts are binned and nothing is merged.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     count_partitions(kmers_t *kmers, worker_t *workers, FILE *outstream)
+
+{
+    FILE        **sorted;
+    unsigned    c;
+    int         status = EX_OK;
+
+    if ( (sorted = calloc(kmers->partition_count, sizeof(*sorted))) == NULL )
+    {
+	fputs("fastx-kmers: Could not allocate partitions.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    for (c = 0; (c < kmers->partition_count) && (status == EX_OK); ++c)
+    {
+	status = count_partition(kmers, workers, kmers->partitions[c].stream);
+	fclose(kmers->partitions[c].stream);
+	if ( status != EX_OK )
+	    break;
+	if ( kmers->format != OUTPUT_HISTOGRAM )
+	{
+	    if ( (sorted[c] = temp_open(kmers->tmpdir)) == NULL )
+		status = EX_CANTCREAT;
+	    else
+	    {
+		status = table_output(kmers, sorted[c], true);
+		rewind(sorted[c]);
+	    }
+	}
+	else
+	    status = table_output(kmers, NULL, false);
+	table_clear(kmers);
+    }
+    if ( (status == EX_OK) && (kmers->format != OUTPUT_HISTOGRAM) )
+	status = merge_sorted(kmers, sorted, kmers->partition_count,
+			      outstream);
+    for (c = 0; c < kmers->partition_count; ++c)
+	if ( sorted[c] != NULL )
+	    fclose(sorted[c]);
+    free(sorted);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Load one partition file and count its super-k-mers with the
+ *      workers, in chunks of about CHUNK_BYTES
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     count_partition(kmers_t *kmers, worker_t *workers, FILE *stream)
+
+{
+    batch_t         batch;
+    unsigned char   *data, *p, *end, *chunk;
+    uint32_t        bases;
+    long            len;
+
+    if ( (fflush(stream) != 0) || ferror(stream) ||
+	 (fseek(stream, 0L, SEEK_END) != 0) || ((len = ftell(stream)) < 0) )
+    {
+	fprintf(stderr, "fastx-kmers: Error writing partition: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+    if ( len == 0 )
+	return EX_OK;
+    rewind(stream);
+    if ( (data = malloc(len)) == NULL )
+    {
+	fputs("fastx-kmers: Could not allocate partition.  "
+	      "Try more --partitions.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    PROF_START(t);
+    if ( fread(data, 1, len, stream) != (size_t)len )
+    {
+	fprintf(stderr, "fastx-kmers: Error reading partition: %s\n",
+		strerror(errno));
+	free(data);
+	return EX_IOERR;
+    }
+    PROF_STOP_IO(t, "partition-read");
+
+    memset(&batch, 0, sizeof(batch));
+    batch.mode = MODE_PACKED;
+    pthread_mutex_init(&batch.lock, NULL);
+    for (p = chunk = data, end = data + len; p < end; )
+    {
+	memcpy(&bases, p, sizeof(bases));
+	p += sizeof(bases) + (bases + 3) / 4;
+	if ( (p - chunk >= CHUNK_BYTES) || (p >= end) )
+	{
+	    add_segment(&batch, (char *)chunk, p - chunk);
+	    chunk = p;
+	}
+    }
+    PROF_RESTART(t);
+    run_batch(kmers, workers, &batch);
+    join_batch(kmers, workers);
+    PROF_STOP(t, "count");
+    pthread_mutex_destroy(&batch.lock);
+    free(batch.segments);
+    free(data);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Sort k-mer counts by k-mer.  A k-mer occupies only the low 2k
+ *      bits, so an LSD radix sort needs ceil(2k / 8) passes over the
+ *      array, far fewer than qsort's comparisons for the tens of
+ *      millions of distinct k-mers in a typical run.  Falls back to
+ *      qsort if the scratch array cannot be allocated.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    kmer_sort(kmer_count_t *kcs, size_t count, unsigned k)
+
+{
+    kmer_count_t    *src = kcs, *dest, *temp;
+    size_t          offsets[256], c, total, n;
+    unsigned        shift, digit;
+
+    if ( (count < 256) ||
+	 ((dest = malloc(count * sizeof(*dest))) == NULL) )
+    {
+	qsort(kcs, count, sizeof(*kcs), kmer_cmp);
+	return;
+    }
+    temp = dest;
+    for (shift = 0; shift < 2 * k; shift += 8)
+    {
+	memset(offsets, 0, sizeof(offsets));
+	for (c = 0; c < count; ++c)
+	    ++offsets[(src[c].kmer >> shift) & 0xff];
+	for (digit = 0, total = 0; digit < 256; ++digit)
+	{
+	    n = offsets[digit];
+	    offsets[digit] = total;
+	    total += n;
+	}
+	for (c = 0; c < count; ++c)
+	    dest[offsets[(src[c].kmer >> shift) & 0xff]++] = src[c];
+	temp = src;
+	src = dest;
+	dest = temp;
+    }
+    // After an odd number of passes the result is in the scratch array
+    if ( src != kcs )
+    {
+	memcpy(kcs, src, count * sizeof(*kcs));
+	free(src);
+    }
+    else
+	free(dest);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write the k-mers in the table with at least min_count
+ *      occurrences, sorted, to outstream, or add them to the histogram.
+ *      Sorted partitions, to be merged later, are binary pairs with no
+ *      header regardless of the output format.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     table_output(kmers_t *kmers, FILE *outstream, bool partition)
+
+{
+    kmer_count_t    *all;
+    size_t          count, c, s;
+    unsigned        shard;
+    uint32_t        k = kmers->k;
+
+    if ( kmers->format == OUTPUT_HISTOGRAM )
+    {
+	for (shard = 0; shard < SHARDS; ++shard)
+	    for (s = 0; s < kmers->shards[shard].capacity; ++s)
+		if ( kmers->shards[shard].slots[s].count > 0 )
+		    hist_add(kmers, kmers->shards[shard].slots[s].count);
+	return EX_OK;
+    }
+
+    for (shard = 0, count = 0; shard < SHARDS; ++shard)
+	count += kmers->shards[shard].used;
+    if ( (all = malloc((count + 1) * sizeof(*all))) == NULL )
+    {
+	fputs("fastx-kmers: Could not allocate output array.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    for (shard = 0, c = 0; shard < SHARDS; ++shard)
+	for (s = 0; s < kmers->shards[shard].capacity; ++s)
+	    if ( kmers->shards[shard].slots[s].count >= kmers->min_count )
+		all[c++] = kmers->shards[shard].slots[s];
+    PROF_START(t);
+    kmer_sort(all, c, k);
+    PROF_STOP(t, "sort");
+
+    PROF_RESTART(t);
+    if ( partition )
+	fwrite(all, sizeof(*all), c, outstream);
+    else
+    {
+	if ( kmers->format == OUTPUT_BINARY )
+	{
+	    fwrite(BINARY_MAGIC, 1, 4, outstream);
+	    fwrite(&k, sizeof(k), 1, outstream);
+	}
+	else
+	    fputs("#kmer\tcount\n", outstream);
+	for (s = 0; s < c; ++s)
+	    kmer_write(kmers, outstream, &all[s]);
+    }
+    PROF_STOP_IO(t, "write");
+    free(all);
+    if ( ferror(outstream) )
+    {
+	fprintf(stderr, "fastx-kmers: Error writing output: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+    return EX_OK;
+}
+
+
+void    table_clear(kmers_t *kmers)
+
+{
+    unsigned    shard;
+
+    for (shard = 0; shard < SHARDS; ++shard)
+    {
+	memset(kmers->shards[shard].slots, 0,
+	       kmers->shards[shard].capacity *
+	       sizeof(*kmers->shards[shard].slots));
+	kmers->shards[shard].used = 0;
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Add a count to the histogram.  Counts too large to bin directly
+ *      are saved and sorted at output, so the histogram is exact.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    hist_add(kmers_t *kmers, uint64_t count)
+
+{
+    uint64_t    *new_counts;
+
+    if ( count < kmers->min_count )
+	return;
+    if ( count < HIST_DIRECT )
+    {
+	++kmers->hist[count];
+	return;
+    }
+    if ( kmers->big_used == kmers->big_size )
+    {
+	kmers->big_size = kmers->big_size == 0 ? 1024 : kmers->big_size * 2;
+	new_counts = realloc(kmers->big_counts,
+			     kmers->big_size * sizeof(*new_counts));
+	if ( new_counts == NULL )
+	{
+	    fputs("fastx-kmers: Could not allocate histogram.\n", stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+	kmers->big_counts = new_counts;
+    }
+    kmers->big_counts[kmers->big_used++] = count;
+}
+
+
+int     hist_write(kmers_t *kmers, FILE *outstream)
+
+{
+    uint64_t    c, n;
+    size_t      b;
+
+    fputs("#count\tkmers\n", outstream);
+    for (c = 1; c < HIST_DIRECT; ++c)
+	if ( kmers->hist[c] > 0 )
+	    fprintf(outstream, "%" PRIu64 "\t%" PRIu64 "\n", c, kmers->hist[c]);
+    qsort(kmers->big_counts, kmers->big_used, sizeof(*kmers->big_counts),
+	  uint64_cmp);
+    for (b = 0; b < kmers->big_used; b += n)
+    {
+	for (n = 1; (b + n < kmers->big_used) &&
+		    (kmers->big_counts[b + n] == kmers->big_counts[b]); ++n)
+	    ;
+	fprintf(outstream, "%" PRIu64 "\t%" PRIu64 "\n",
+		kmers->big_counts[b], n);
+    }
+    return ferror(outstream) ? EX_IOERR : EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Merge sorted partition files.  Each k-mer occurs in only one
+ *      partition, so this is a plain k-way merge on a binary heap.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     merge_sorted(kmers_t *kmers, FILE **streams, unsigned count,
+		     FILE *outstream)
+
+{
+    kmer_count_t    *heads;
+    unsigned        *heap, heap_len = 0, c, child, top;
+    uint32_t        k = kmers->k;
+
+    heads = malloc(count * sizeof(*heads));
+    heap = malloc(count * sizeof(*heap));
+    if ( (heads == NULL) || (heap == NULL) )
+    {
+	fputs("fastx-kmers: Could not allocate merge heap.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    if ( kmers->format == OUTPUT_BINARY )
+    {
+	fwrite(BINARY_MAGIC, 1, 4, outstream);
+	fwrite(&k, sizeof(k), 1, outstream);
+    }
+    else
+	fputs("#kmer\tcount\n", outstream);
+
+    PROF_START(t);
+    for (c = 0; c < count; ++c)
+    {
+	if ( fread(&heads[c], sizeof(*heads), 1, streams[c]) != 1 )
+	    continue;
+	// Sift up
+	for (child = heap_len++; (child > 0) &&
+	     (heads[heap[(child - 1) / 2]].kmer > heads[c].kmer);
+	     child = (child - 1) / 2)
+	    heap[child] = heap[(child - 1) / 2];
+	heap[child] = c;
+    }
+    while ( heap_len > 0 )
+    {
+	top = heap[0];
+	kmer_write(kmers, outstream, &heads[top]);
+	if ( fread(&heads[top], sizeof(*heads), 1, streams[top]) != 1 )
+	    top = heap[--heap_len];
+	// Sift down
+	for (c = 0; (child = 2 * c + 1) < heap_len; c = child)
+	{
+	    if ( (child + 1 < heap_len) &&
+		 (heads[heap[child + 1]].kmer < heads[heap[child]].kmer) )
+		++child;
+	    if ( heads[heap[child]].kmer >= heads[top].kmer )
+		break;
+	    heap[c] = heap[child];
+	}
+	if ( heap_len > 0 )
+	    heap[c] = top;
+    }
+    PROF_STOP_IO(t, "merge");
+    free(heads);
+    free(heap);
+    if ( ferror(outstream) )
+    {
+	fprintf(stderr, "fastx-kmers: Error writing output: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write one k-mer and count as TSV or as a binary pair
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    kmer_write(kmers_t *kmers, FILE *outstream, const kmer_count_t *kc)
+
+{
+    char        text[KMER_MAX + 24], digits[21], *p;
+    unsigned    c;
+    uint64_t    count;
+
+    if ( kmers->format == OUTPUT_BINARY )
+    {
+	fwrite(kc, sizeof(*kc), 1, outstream);
+	return;
+    }
+    // Formatted by hand: fprintf() dominates the run time otherwise
+    for (c = 0; c < kmers->k; ++c)
+	text[c] = "ACGT"[(kc->kmer >> (2 * (kmers->k - 1 - c))) & 3];
+    p = text + c;
+    *p++ = '\t';
+    count = kc->count;
+    c = 0;
+    do
+    {
+	digits[c++] = '0' + count % 10;
+	count /= 10;
+    }   while ( count > 0 );
+    while ( c > 0 )
+	*p++ = digits[--c];
+    *p++ = '\n';
+    fwrite(text, 1, p - text, outstream);
+}
+
+
+int     kmer_cmp(const void *p1, const void *p2)
+
+{
+    const kmer_count_t  *kc1 = p1, *kc2 = p2;
+
+    return (kc1->kmer > kc2->kmer) - (kc1->kmer < kc2->kmer);
+}
+
+
+int     uint64_cmp(const void *p1, const void *p2)
+
+{
+    const uint64_t  *v1 = p1, *v2 = p2;
+
+    return (*v1 > *v2) - (*v1 < *v2);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create an anonymous temporary file in dir, which is removed
+ *      when closed
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *temp_open(const char *dir)
+
+{
+    char    path[PATH_MAX + 1];
+    int     fd;
+    FILE    *stream;
+
+    snprintf(path, PATH_MAX, "%s/fastx-kmers.XXXXXX", dir);
+    if ( (fd = mkstemp(path)) == -1 )
+    {
+	fprintf(stderr, "fastx-kmers: Cannot create temporary file in %s: "
+		"%s\n", dir, strerror(errno));
+	return NULL;
+    }
+    unlink(path);
+    if ( (stream = fdopen(fd, "w+")) == NULL )
+	close(fd);
+    return stream;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Scramble a k-mer for shard and slot selection and minimizer
+ *      ordering (splitmix64 finalizer).  Plain k-mer order would put
+ *      poly-A in every minimizer and cluster slots.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+static inline uint64_t  kmer_hash(uint64_t kmer)
+
+{
+    kmer ^= kmer >> 30;
+    kmer *= 0xbf58476d1ce4e5b9ULL;
+    kmer ^= kmer >> 27;
+    kmer *= 0x94d049bb133111ebULL;
+    kmer ^= kmer >> 31;
+    return kmer;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [-k K] [--min-count N] "
+		    "[--binary|--histogram]\n"
+		    "    [--partitions N [--tmpdir dir]] [--threads N] "
+		    "[file.fastx ...]\n", argv[0]);
+    exit(EX_USAGE);
+}
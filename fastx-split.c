@@ -0,0 +1,621 @@
+/***************************************************************************
+ *  Description:
+ *      Split a FASTA or FASTQ file into parts in a single pass, for
+ *      scatter-gather processing across cluster nodes.
+ *
+ *      Parts are either contiguous, ending when they reach a number of
+ *      records, bases, or bytes, or filled round-robin, one record to
+ *      each part in turn.  Records are parsed with biolibc, so FASTA
+ *      records of any number of lines are never split, and copied to
+ *      each part through a large buffer.  Round-robin keeps every part
+ *      open at once, dividing a fixed budget of buffer space, including
+ *      BGZF compression buffers, among them.  The parts share one pool
+ *      of BGZF compression threads rather than starting their own.
+ *
+ *      A regular, uncompressed file split by --parts or --bytes does not
+ *      need parsing at all.  It is mapped into memory, a record boundary
+ *      is found near each target offset by scanning forward a few lines,
+ *      and the byte ranges between boundaries are written out unchanged.
+ *      With --index, the ranges are only listed, so no data is read
+ *      beyond the lines around each boundary, and tools such as
+ *      fastx-stats and fastx-derep can read the ranges in place with
+ *      --range.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <biolibc/fastx.h>
+#include "blt-writer.h"
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+#define MAX_OPEN_PARTS      4096
+#define PART_BUFF_SIZE      (1024 * 1024)
+#define PART_BUFF_MIN       (64 * 1024)
+#define PART_BUFF_TOTAL     (64 * 1024 * 1024)  // Shared by open parts
+#define RANGE_WRITE_SIZE    (16 * 1024 * 1024)
+
+typedef enum
+{
+    SPLIT_NONE,
+    SPLIT_RECORDS,
+    SPLIT_BASES,
+    SPLIT_BYTES,
+    SPLIT_PARTS,
+    SPLIT_ROUND_ROBIN
+}   split_mode_t;
+
+typedef struct
+{
+    split_mode_t    mode;
+    uint64_t        size;           // Records, bases, bytes, or parts
+    const char      *prefix;
+    const char      *ext;           // ".fasta" or ".fastq"
+    bool            bgzf;
+    bool            index;
+    unsigned        threads;        // BGZF threads
+    blt_zpool_t     *pool;          // Shared by round-robin BGZF parts
+}   split_t;
+
+typedef struct
+{
+    FILE            *stream;
+    int             fd;             // For BGZF, which does not close it
+    blt_writer_t    writer;
+}   part_t;
+
+int     split_stream(const char *filename, split_t *split);
+int     split_file(const char *filename, split_t *split);
+size_t  next_record(const char *map, size_t size, size_t pos, int format);
+bool    fastq_record_at(const char *map, size_t size, size_t line);
+int     part_open(part_t *part, split_t *split, unsigned number,
+		  size_t buff_size);
+int     part_close(part_t *part);
+void    usage(char *argv[]);
+
+int     main(int argc,char *argv[])
+
+{
+    split_t     split = { SPLIT_NONE, 0, "part", "", false, false,
+			  BLT_ZIO_THREADS_DEFAULT, NULL };
+    const char  *filename = "-";
+    long        cpus;
+    int         arg, status;
+    char        *end;
+
+    PROF_INIT("fastx-split");
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	end = "";
+	if ( (strcmp(argv[arg], "--records") == 0) && (arg + 1 < argc) )
+	{
+	    split.mode = SPLIT_RECORDS;
+	    split.size = strtoull(argv[++arg], &end, 10);
+	}
+	else if ( (strcmp(argv[arg], "--bases") == 0) && (arg + 1 < argc) )
+	{
+	    split.mode = SPLIT_BASES;
+	    split.size = strtoull(argv[++arg], &end, 10);
+	}
+	else if ( (strcmp(argv[arg], "--bytes") == 0) && (arg + 1 < argc) )
+	{
+	    split.mode = SPLIT_BYTES;
+	    split.size = strtoull(argv[++arg], &end, 10);
+	}
+	else if ( (strcmp(argv[arg], "--parts") == 0) && (arg + 1 < argc) )
+	{
+	    split.mode = SPLIT_PARTS;
+	    split.size = strtoull(argv[++arg], &end, 10);
+	}
+	else if ( (strcmp(argv[arg], "--round-robin") == 0) &&
+		  (arg + 1 < argc) )
+	{
+	    split.mode = SPLIT_ROUND_ROBIN;
+	    split.size = strtoull(argv[++arg], &end, 10);
+	    if ( split.size > MAX_OPEN_PARTS )
+	    {
+		fprintf(stderr, "Round-robin parts must be 1 to %u.\n",
+			MAX_OPEN_PARTS);
+		usage(argv);
+	    }
+	}
+	else if ( (strcmp(argv[arg], "--prefix") == 0) && (arg + 1 < argc) )
+	    split.prefix = argv[++arg];
+	else if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    split.bgzf = true;
+	else if ( strcmp(argv[arg], "--index") == 0 )
+	    split.index = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &split.threads) != 0 )
+		usage(argv);
+	}
+	else if ( (argv[arg][0] != '-') || (strcmp(argv[arg], "-") == 0) )
+	    filename = argv[arg];
+	else
+	    usage(argv);
+	if ( *end != '\0' )
+	{
+	    fprintf(stderr, "Invalid value: %s\n", argv[arg]);
+	    usage(argv);
+	}
+    }
+    if ( (split.mode == SPLIT_NONE) || (split.size == 0) )
+	usage(argv);
+    if ( split.index && (split.mode != SPLIT_PARTS) &&
+	 (split.mode != SPLIT_BYTES) )
+    {
+	fputs("--index requires --parts or --bytes.\n", stderr);
+	usage(argv);
+    }
+    if ( split.threads == BLT_ZIO_THREADS_DEFAULT )
+	split.threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1 ? 1 : cpus;
+
+    // Byte-based splits of plain files need only the record boundaries
+    if ( (split.mode == SPLIT_PARTS) || (split.mode == SPLIT_BYTES) )
+    {
+	if ( (status = split_file(filename, &split)) != -1 )
+	    return status;
+	if ( (split.mode == SPLIT_PARTS) || split.index )
+	{
+	    fputs("fastx-split: --parts and --index require an uncompressed "
+		  "FASTA or FASTQ file.\n", stderr);
+	    return EX_NOINPUT;
+	}
+    }
+    return split_stream(filename, &split);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Split by parsing records, for any input blt_zopen() can read.
+ *      Contiguous parts are opened one at a time as the previous one
+ *      fills.  Round-robin parts are all opened at the start.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     split_stream(const char *filename, split_t *split)
+
+{
+    bl_fastx_t  rec;
+    FILE        *instream;
+    part_t      *parts;
+    unsigned    part_count, open_count, c, p = 0;
+    uint64_t    records = 0, filled = 0;
+    size_t      buff_size;
+    int         status = BL_READ_OK, ex_status = EX_OK;
+
+    if ( (instream = blt_zopen(filename, split->threads)) == NULL )
+    {
+	fprintf(stderr, "fastx-split: Cannot open %s: %s\n", filename,
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    bl_fastx_init(&rec, instream);
+    switch(BL_FASTX_FORMAT(&rec))
+    {
+	case BL_FASTX_FORMAT_FASTA:
+	    split->ext = ".fasta";
+	    break;
+	case BL_FASTX_FORMAT_FASTQ:
+	    split->ext = ".fastq";
+	    break;
+	default:
+	    // Empty input: no parts
+	    blt_zclose(instream);
+	    fputs("fastx-split: 0 records in 0 parts.\n", stderr);
+	    return EX_OK;
+    }
+
+    if ( split->mode == SPLIT_ROUND_ROBIN )
+    {
+	open_count = part_count = split->size;
+	// Record buffers and BGZF slots share the budget
+	buff_size = PART_BUFF_TOTAL / open_count / (split->bgzf ? 2 : 1);
+	if ( buff_size > PART_BUFF_SIZE )
+	    buff_size = PART_BUFF_SIZE;
+	else if ( buff_size < PART_BUFF_MIN )
+	    buff_size = PART_BUFF_MIN;
+    }
+    else
+    {
+	open_count = 1;
+	part_count = 0;
+	buff_size = PART_BUFF_SIZE;
+    }
+    if ( (split->mode == SPLIT_ROUND_ROBIN) && split->bgzf &&
+	 ((split->pool = blt_zpool_create(split->threads)) == NULL) )
+    {
+	fprintf(stderr, "fastx-split: Cannot start BGZF threads: %s\n",
+		strerror(errno));
+	blt_zclose(instream);
+	return EX_OSERR;
+    }
+    if ( (parts = calloc(open_count, sizeof(*parts))) == NULL )
+    {
+	fputs("fastx-split: Could not allocate parts.\n", stderr);
+	blt_zpool_destroy(split->pool);
+	blt_zclose(instream);
+	return EX_UNAVAILABLE;
+    }
+    for (c = 0; (c < part_count) && (ex_status == EX_OK); ++c)
+	ex_status = part_open(&parts[c], split, c + 1, buff_size);
+
+    PROF_START(t);
+    while ( (ex_status == EX_OK) &&
+	    ((status = bl_fastx_read(&rec, instream)) == BL_READ_OK) )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_RESTART(t);
+	if ( split->mode == SPLIT_ROUND_ROBIN )
+	    p = records % part_count;
+	else if ( (part_count == 0) || (filled >= split->size) )
+	{
+	    if ( (part_count > 0) && (part_close(&parts[0]) != EX_OK) )
+		ex_status = EX_IOERR;
+	    else
+		ex_status = part_open(&parts[0], split, ++part_count,
+				      buff_size);
+	    if ( ex_status != EX_OK )
+		break;
+	    filled = 0;
+	}
+	blt_writer_record(&parts[p].writer, &rec);
+	++records;
+	if ( split->mode == SPLIT_RECORDS )
+	    ++filled;
+	else if ( split->mode == SPLIT_BASES )
+	    filled += bl_fastx_seq_len(&rec);
+	else
+	    filled += blt_writer_record_size(&rec);
+	PROF_STOP_IO(t, "write");
+	PROF_RECORDS(1);
+	PROF_BYTES(bl_fastx_desc_len(&rec) + bl_fastx_seq_len(&rec) +
+		   bl_fastx_qual_len(&rec));
+	PROF_RESTART(t);
+    }
+    bl_fastx_free(&rec);
+    blt_zclose(instream);
+
+    if ( split->mode != SPLIT_ROUND_ROBIN )
+	open_count = part_count > 0 ? 1 : 0;
+    for (c = 0; c < open_count; ++c)
+    {
+	if ( (parts[c].stream != NULL) && (part_close(&parts[c]) != EX_OK) &&
+	     (ex_status == EX_OK) )
+	    ex_status = EX_IOERR;
+    }
+    free(parts);
+    blt_zpool_destroy(split->pool);
+    split->pool = NULL;
+
+    if ( ex_status != EX_OK )
+	return ex_status;
+    if ( status != BL_READ_EOF )
+    {
+	fprintf(stderr, "fastx-split: Error reading record %ju.\n",
+		(uintmax_t)records + 1);
+	return EX_DATAERR;
+    }
+    fprintf(stderr, "fastx-split: %ju records in %u parts.\n",
+	    (uintmax_t)records, part_count);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Split a regular, uncompressed file at record boundaries found
+ *      near each target offset, writing each byte range unchanged, or
+ *      listing the ranges with --index.
+ *
+ *  Returns:
+ *      A sysexits(3) code, or -1 without reporting an error if the file
+ *      is compressed or not a regular file, so the caller can fall back
+ *      to split_stream()
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     split_file(const char *filename, split_t *split)
+
+{
+    struct stat st;
+    part_t      part;
+    const char  *map;
+    size_t      size, start, end, target, len, done,
+		unmapped = 0,
+		page_size = sysconf(_SC_PAGESIZE);
+    unsigned    number;
+    int         fd, format, ex_status = EX_OK;
+
+    if ( strcmp(filename, "-") == 0 )
+	fd = STDIN_FILENO;
+    else if ( (fd = open(filename, O_RDONLY)) == -1 )
+    {
+	fprintf(stderr, "fastx-split: Cannot open %s: %s\n", filename,
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( (fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) ||
+	 (lseek(fd, 0, SEEK_CUR) != 0) )
+    {
+	if ( fd != STDIN_FILENO )
+	    close(fd);
+	return -1;
+    }
+    size = st.st_size;
+    if ( size == 0 )
+	map = "";   // mmap() fails on empty files
+    else if ( (map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0))
+		== MAP_FAILED )
+    {
+	fprintf(stderr, "fastx-split: Cannot map %s: %s\n", filename,
+		strerror(errno));
+	if ( fd != STDIN_FILENO )
+	    close(fd);
+	return EX_NOINPUT;
+    }
+
+    // Anything else is compressed or not FASTA/FASTQ: parse it instead
+    if ( (size > 0) && (map[0] != '>') && (map[0] != '@') )
+    {
+	munmap((void *)map, size);
+	if ( fd != STDIN_FILENO )
+	    close(fd);
+	return -1;
+    }
+    format = map[0] == '>' ? BL_FASTX_FORMAT_FASTA : BL_FASTX_FORMAT_FASTQ;
+    split->ext = format == BL_FASTX_FORMAT_FASTA ? ".fasta" : ".fastq";
+#ifdef POSIX_FADV_SEQUENTIAL
+    if ( !split->index )
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    if ( split->index )
+	printf("#part\tstart\tend\n");
+    PROF_START(t);
+    for (start = 0, number = 1; (ex_status == EX_OK) &&
+	 ((start < size) || ((split->mode == SPLIT_PARTS) &&
+			     (number <= split->size))); ++number)
+    {
+	if ( split->mode == SPLIT_PARTS )
+	    target = number == split->size ? size :
+		     (size_t)((double)size * number / split->size);
+	else
+	    target = size - start > split->size ? start + split->size : size;
+	end = next_record(map, size, target > start ? target : start, format);
+	PROF_STOP(t, "boundary");
+
+	PROF_RESTART(t);
+	if ( split->index )
+	    printf("%u\t%zu\t%zu\n", number, start, end);
+	else if ( (ex_status = part_open(&part, split, number, 0)) == EX_OK )
+	{
+	    // Straight from the map, in large pieces
+	    for (; start < end; start += len)
+	    {
+		len = end - start > RANGE_WRITE_SIZE ? RANGE_WRITE_SIZE :
+		      end - start;
+		fwrite(map + start, len, 1, part.stream);
+#ifdef MADV_DONTNEED
+		// Unmap pages written, so RSS does not grow with the file
+		done = (start + len) & ~(page_size - 1);
+		if ( done > unmapped )
+		{
+		    madvise((void *)(map + unmapped), done - unmapped,
+			    MADV_DONTNEED);
+		    unmapped = done;
+		}
+#endif
+	    }
+	    ex_status = part_close(&part);
+	}
+	PROF_STOP_IO(t, "write");
+	PROF_RESTART(t);
+	start = end;
+    }
+    PROF_BYTES(size);
+
+    if ( size > 0 )
+	munmap((void *)map, size);
+    if ( fd != STDIN_FILENO )
+	close(fd);
+    if ( (ex_status == EX_OK) && !split->index )
+	fprintf(stderr, "fastx-split: %zu bytes in %u parts.\n", size,
+		number - 1);
+    return ex_status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Find the first record start at or after pos.  FASTA records are
+ *      the only lines starting with '>'.  A FASTQ quality line may start
+ *      with '@', so a candidate header must be followed by a line
+ *      starting with '+' two lines later.
+ *
+ *  Returns:
+ *      The offset of the record, or size if there is none
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+size_t  next_record(const char *map, size_t size, size_t pos, int format)
+
+{
+    const char  *nl;
+    size_t      line;
+
+    // Start of the first line at or after pos
+    if ( (pos == 0) || (pos >= size) || (map[pos - 1] == '\n') )
+	line = pos;
+    else if ( (nl = memchr(map + pos, '\n', size - pos)) == NULL )
+	return size;
+    else
+	line = nl - map + 1;
+
+    while ( line < size )
+    {
+	if ( (format == BL_FASTX_FORMAT_FASTA) ? map[line] == '>' :
+	     (map[line] == '@') && fastq_record_at(map, size, line) )
+	    return line;
+	if ( (nl = memchr(map + line, '\n', size - line)) == NULL )
+	    return size;
+	line = nl - map + 1;
+    }
+    return size;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether a line starting with '@' is a FASTQ header: the
+ *      line two after it starts with '+' and the sequence and quality
+ *      lines have the same length.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    fastq_record_at(const char *map, size_t size, size_t line)
+
+{
+    size_t      starts[5];
+    const char  *nl;
+    unsigned    c;
+
+    starts[0] = line;
+    for (c = 1; c < 5; ++c)
+    {
+	if ( starts[c - 1] >= size )
+	    return false;
+	nl = memchr(map + starts[c - 1], '\n', size - starts[c - 1]);
+	starts[c] = nl == NULL ? size + 1 : (size_t)(nl - map) + 1;
+    }
+    return (map[starts[2]] == '+') &&
+	   (starts[2] - starts[1] == starts[4] - starts[3]);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create part number of the output, BGZF-compressed with --bgzf,
+ *      by the shared pool if there is one, in which case its slots take
+ *      another buff_size bytes.  buff_size 0 means no record buffer, for
+ *      writing byte ranges.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     part_open(part_t *part, split_t *split, unsigned number,
+		  size_t buff_size)
+
+{
+    char    filename[PATH_MAX + 1];
+
+    snprintf(filename, sizeof(filename), "%s-%04u%s%s", split->prefix,
+	     number, split->ext, split->bgzf ? ".gz" : "");
+    part->fd = -1;
+    if ( split->bgzf )
+    {
+	if ( (part->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666))
+		== -1 )
+	{
+	    fprintf(stderr, "fastx-split: Cannot create %s: %s\n", filename,
+		    strerror(errno));
+	    return EX_CANTCREAT;
+	}
+	if ( split->pool != NULL )
+	    part->stream = blt_bgzf_fdopen_pool(part->fd, split->pool,
+						buff_size);
+	else
+	    part->stream = blt_bgzf_fdopen(part->fd, split->threads);
+	if ( part->stream == NULL )
+	{
+	    fprintf(stderr, "fastx-split: Cannot open BGZF output %s: %s\n",
+		    filename, strerror(errno));
+	    close(part->fd);
+	    return EX_CANTCREAT;
+	}
+    }
+    else if ( (part->stream = fopen(filename, "w")) == NULL )
+    {
+	fprintf(stderr, "fastx-split: Cannot create %s: %s\n", filename,
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    part->writer.buf = NULL;
+    if ( (buff_size > 0) &&
+	 (blt_writer_init(&part->writer, part->stream, buff_size) != 0) )
+    {
+	fprintf(stderr, "fastx-split: Could not allocate buffer for %s.\n",
+		filename);
+	return EX_UNAVAILABLE;
+    }
+    return EX_OK;
+}
+
+
+int     part_close(part_t *part)
+
+{
+    int     status;
+
+    if ( part->writer.buf != NULL )
+	blt_writer_free(&part->writer);
+    status = ferror(part->stream);
+    if ( part->fd == -1 )
+	status |= fclose(part->stream);
+    else
+    {
+	status |= blt_zclose(part->stream);
+	status |= close(part->fd);
+    }
+    part->stream = NULL;
+    if ( status != 0 )
+    {
+	fputs("fastx-split: Error writing output.\n", stderr);
+	return EX_IOERR;
+    }
+    return EX_OK;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s --records N|--bases N|--bytes N|--parts N|"
+		    "--round-robin N\n"
+		    "\t[--prefix prefix] [--bgzf] [--threads N] "
+		    "[file.fastx]\n"
+		    "       %s --index --parts N|--bytes N file.fastx\n",
+		    argv[0], argv[0]);
+    exit(EX_USAGE);
+}
@@ -10,41 +10,58 @@
 
 #include <stdio.h>
 #include <sysexits.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
 #include <ctype.h>
 #include <math.h>
 #include <xtend/string.h>
-#include <xtend/file.h>
 #include <biolibc/fastx.h>
 #include <biolibc/biolibc.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
 
-int     fastx_stats(char *filename);
+int     fastx_stats(char *filename, off_t start, off_t end);
+void    usage(char *argv[]);
 
 int     main(int argc, char *argv[])
 
 {
     int     arg,
+	    files = 0,
 	    status;
+    off_t   start = 0,
+	    end = -1;   // Whole file
 
-    switch(argc)
+    PROF_INIT("fastx-stats");
+
+    for (arg = 1; arg < argc; ++arg)
     {
-	case 1:
-	    return fastx_stats("-");
-	    break;
-	
-	default:
-	    for (arg = 1; arg < argc; ++arg)
-		if ( (status = fastx_stats(argv[arg])) != EX_OK )
-		    return status;
+	if ( strcmp(argv[arg], "--range") == 0 )
+	{
+	    if ( (arg + 1 == argc) ||
+		 (blt_parse_range(argv[++arg], &start, &end) != 0) )
+		usage(argv);
+	}
+	else
+	{
+	    if ( (status = fastx_stats(argv[arg], start, end)) != EX_OK )
+		return status;
+	    ++files;
+	    start = 0;
+	    end = -1;
+	}
     }
+    if ( files == 0 )
+	return fastx_stats("-", start, end);
 	
     return EX_OK;
 }
 
 
-int     fastx_stats(char *filename)
+int     fastx_stats(char *filename, off_t start, off_t end)
 
 {
     bl_fastx_t      rec = BL_FASTX_INIT;
@@ -59,9 +76,11 @@ int     fastx_stats(char *filename)
     int             status;
     double          mean_len, sum_sq, variance;
 
-    if ( strcmp(filename, "-") == 0 )
-	fastx_stream = stdin;
-    else if ( (fastx_stream = xt_fopen(filename, "r")) == NULL )
+    if ( end == -1 )
+	fastx_stream = blt_zopen(filename, BLT_ZIO_THREADS_DEFAULT);
+    else
+	fastx_stream = blt_zopen_range(filename, start, end);
+    if ( fastx_stream == NULL )
     {
 	fprintf(stderr, "fastx-stats: Cannot open %s: %s\n",
 		filename, strerror(errno));
@@ -71,8 +90,15 @@ int     fastx_stats(char *filename)
     memset(counts, 0, 26 * sizeof(*counts));
     bl_fastx_init(&rec, fastx_stream);
     sum_sq = 0.0;
+    PROF_START(t);
     while ( (status = bl_fastx_read(&rec, fastx_stream)) == BL_READ_OK )
     {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
+	// Excluding line breaks and the FASTQ '+' line
+	PROF_BYTES(bl_fastx_desc_len(&rec) + bl_fastx_seq_len(&rec) +
+		   bl_fastx_qual_len(&rec));
+	PROF_RESTART(t);
 	++records;
 	len = bl_fastx_seq_len(&rec);
 	bases += len;
@@ -83,10 +109,11 @@ int     fastx_stats(char *filename)
 	    min_len = len;
 	for (p = bl_fastx_seq(&rec); *p != '\0'; ++p)
 	    ++counts[tolower(*p) - 'a'];
+	PROF_STOP(t, "count");
+	PROF_RESTART(t);
     }
 
-    if ( fastx_stream != stdin )
-	xt_fclose(fastx_stream);
+    blt_zclose(fastx_stream);
     bl_fastx_free(&rec);
     
     if ( status != BL_READ_EOF )
@@ -99,7 +126,11 @@ int     fastx_stats(char *filename)
     // Single-pass variance
     variance = sum_sq / records - mean_len * mean_len;
     
-    printf("\nFilename:           %s\n", filename);
+    if ( end == -1 )
+	printf("\nFilename:           %s\n", filename);
+    else
+	printf("\nFilename:           %s:%jd-%jd\n", filename,
+	       (intmax_t)start, (intmax_t)end);
     printf("Sequences:          %lu\n", records);
     printf("Bases:              %lu\n", bases);
     printf("Mean-length:        %0.2f\n", mean_len);
@@ -120,3 +151,12 @@ int     fastx_stats(char *filename)
 	    (counts['g' - 'a'] + counts['c' - 'a']) * 100.0 / bases);
     return EX_OK;
 }
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [[--range start-end] file.fastx ...]\n",
+	    argv[0]);
+    exit(EX_USAGE);
+}
@@ -0,0 +1,382 @@
+/***************************************************************************
+ *  Description:
+ *      Translate nucleotide sequences from a FASTA or FASTQ stream to
+ *      protein sequences in 1, 3, or 6 reading frames.
+ *
+ *      Bases are encoded to 2-bit values with a branch-free expression
+ *      the compiler can vectorize, and each codon is translated by a
+ *      64-entry table indexed by the 6-bit codon code.  Records are read
+ *      in batches and translated by a pool of threads, each producing
+ *      the complete output for a record in a single buffer, which is
+ *      written in input order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <biolibc/fastx.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+// Limits on records and bases buffered for one batch of threads
+#define BATCH_RECORDS   4096
+#define BATCH_BASES     (64 * 1024 * 1024)
+
+// Added to a base code for anything other than ACGTU
+#define AMBIGUOUS       4
+
+typedef struct
+{
+    bl_fastx_t  *records;
+    char        **output;
+    size_t      *output_len;
+    unsigned    count,
+		next,           // Next record to translate
+		frames;
+    pthread_mutex_t lock;
+}   translate_batch_t;
+
+int     fastx_translate(FILE *instream, unsigned frames, unsigned threads);
+void    *translate_worker(void *arg);
+void    codon_table_init(void);
+void    encode_bases(uint8_t *codes, const char *seq, size_t len);
+char    *translate_frame(char *out, const uint8_t *codes, size_t len,
+			 int frame);
+void    usage(char *argv[]);
+
+/*
+ *  Amino acids indexed by 6-bit codon code.  Bases are encoded as
+ *  (ASCII >> 1) & 3, i.e. A=0, C=1, T/U=2, G=3, first base in the
+ *  high-order bits.
+ */
+static char     Codon_table[64];
+
+int     main(int argc,char *argv[])
+
+{
+    long        frames = 1, cpus;
+    unsigned    threads;
+    int         arg, status;
+    char        *end;
+    FILE        *instream;
+
+    PROF_INIT("fastx-translate");
+
+    threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1 ? 1 : cpus;
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( (strcmp(argv[arg], "--frames") == 0) && (arg + 1 < argc) )
+	{
+	    frames = strtol(argv[++arg], &end, 10);
+	    if ( (*end != '\0') ||
+		 ((frames != 1) && (frames != 3) && (frames != 6)) )
+	    {
+		fprintf(stderr, "Frames must be 1, 3, or 6: %s\n", argv[arg]);
+		usage(argv);
+	    }
+	}
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+
+    codon_table_init();
+    // Read ahead or decompress on another thread while translating
+    if ( (instream = blt_zopen("-", BLT_ZIO_THREADS_DEFAULT)) == NULL )
+    {
+	fprintf(stderr, "fastx-translate: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    status = fastx_translate(instream, frames, threads);
+    PROF_STREAM_BYTES(instream);
+    blt_zclose(instream);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Build the codon table from the standard genetic code, listed
+ *      in the traditional TCAG order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    codon_table_init(void)
+
+{
+    static const char   standard[] =
+	"FFLLSSSSYY**CC*WLLLLPPPPHHQQRRRRIIIMTTTTNNKKSSRRVVVVAAAADDEEGGGG";
+    // Position in TCAG order -> 2-bit code
+    static const int    tcag_code[4] = { 2, 1, 0, 3 };
+    int     b1, b2, b3;
+
+    for (b1 = 0; b1 < 4; ++b1)
+	for (b2 = 0; b2 < 4; ++b2)
+	    for (b3 = 0; b3 < 4; ++b3)
+		Codon_table[(tcag_code[b1] << 4) | (tcag_code[b2] << 2) |
+			    tcag_code[b3]] = standard[b1 * 16 + b2 * 4 + b3];
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read records in batches and translate each batch in parallel,
+ *      writing output in input order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     fastx_translate(FILE *instream, unsigned frames, unsigned threads)
+
+{
+    translate_batch_t   batch;
+    pthread_t   *tids;
+    size_t      bases;
+    unsigned    c, t;
+    int         status = BL_READ_OK, error;
+
+    batch.records = calloc(BATCH_RECORDS, sizeof(*batch.records));
+    batch.output = calloc(BATCH_RECORDS, sizeof(*batch.output));
+    batch.output_len = calloc(BATCH_RECORDS, sizeof(*batch.output_len));
+    tids = calloc(threads, sizeof(*tids));
+    if ( (batch.records == NULL) || (batch.output == NULL) ||
+	 (batch.output_len == NULL) || (tids == NULL) )
+    {
+	fputs("fastx-translate: Could not allocate batch.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    for (c = 0; c < BATCH_RECORDS; ++c)
+	bl_fastx_init(&batch.records[c], instream);
+    batch.frames = frames;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    PROF_START(t0);
+    while ( status == BL_READ_OK )
+    {
+	for (batch.count = 0, bases = 0;
+	     (batch.count < BATCH_RECORDS) && (bases < BATCH_BASES) &&
+	     ((status = bl_fastx_read(&batch.records[batch.count], instream))
+		== BL_READ_OK);
+	     ++batch.count)
+	    bases += bl_fastx_seq_len(&batch.records[batch.count]);
+	PROF_STOP_IO(t0, "read");
+	PROF_RECORDS(batch.count);
+
+	PROF_RESTART(t0);
+	batch.next = 0;
+	for (t = 0, error = 0; (t < threads) && (t < batch.count) &&
+	     ((error = pthread_create(&tids[t], NULL, translate_worker,
+				      &batch)) == 0); ++t)
+	    ;
+	// Translate what the threads started, if any, have not claimed
+	if ( error != 0 )
+	    translate_worker(&batch);
+	while ( t > 0 )
+	    pthread_join(tids[--t], NULL);
+	PROF_STOP(t0, "translate");
+
+	PROF_RESTART(t0);
+	for (c = 0; c < batch.count; ++c)
+	{
+	    fwrite(batch.output[c], batch.output_len[c], 1, stdout);
+	    free(batch.output[c]);
+	}
+	PROF_STOP_IO(t0, "write");
+	PROF_RESTART(t0);
+    }
+
+    for (c = 0; c < BATCH_RECORDS; ++c)
+	bl_fastx_free(&batch.records[c]);
+    free(batch.records);
+    free(batch.output);
+    free(batch.output_len);
+    free(tids);
+    pthread_mutex_destroy(&batch.lock);
+
+    if ( status != BL_READ_EOF )
+    {
+	fprintf(stderr, "fastx-translate: Error reading input: %s\n",
+		strerror(errno));
+	return EX_DATAERR;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: translate records from the batch until none
+ *      are left.  Output for each record is sized exactly in advance
+ *      and built in one buffer.  Also called directly when a thread
+ *      cannot be created.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *translate_worker(void *arg)
+
+{
+    static const int    frame_list[6] = { 1, 2, 3, -1, -2, -3 };
+    translate_batch_t   *batch = arg;
+    bl_fastx_t  *record;
+    uint8_t     *codes = NULL;
+    size_t      codes_size = 0, seq_len, id_len, out_size;
+    char        *id, *out, *p;
+    unsigned    c, f;
+
+    while ( true )
+    {
+	pthread_mutex_lock(&batch->lock);
+	c = batch->next++;
+	pthread_mutex_unlock(&batch->lock);
+	if ( c >= batch->count )
+	    break;
+
+	record = &batch->records[c];
+	seq_len = bl_fastx_seq_len(record);
+	if ( seq_len > codes_size )
+	{
+	    codes_size = seq_len;
+	    free(codes);
+	    if ( (codes = malloc(codes_size)) == NULL )
+	    {
+		fputs("fastx-translate: Could not allocate codes.\n", stderr);
+		exit(EX_UNAVAILABLE);
+	    }
+	}
+	encode_bases(codes, bl_fastx_seq(record), seq_len);
+
+	// Skip '>' or '@', ID ends at first whitespace
+	id = bl_fastx_desc(record) + 1;
+	id_len = strcspn(id, " \t");
+
+	// ">" id " frame=+1\n" protein "\n"
+	out_size = batch->frames * (id_len + seq_len / 3 + 12);
+	if ( (out = malloc(out_size)) == NULL )
+	{
+	    fputs("fastx-translate: Could not allocate output.\n", stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+	for (f = 0, p = out; f < batch->frames; ++f)
+	{
+	    *p++ = '>';
+	    memcpy(p, id, id_len);
+	    p += id_len;
+	    p += sprintf(p, " frame=%+d\n", frame_list[f]);
+	    p = translate_frame(p, codes, seq_len, frame_list[f]);
+	    *p++ = '\n';
+	}
+	batch->output[c] = out;
+	batch->output_len[c] = p - out;
+    }
+    free(codes);
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Encode bases as 2-bit codes: A=0, C=1, T/U=2, G=3, upper or lower
+ *      case.  Any other character gets AMBIGUOUS added.  The loop has
+ *      no branches or table lookups so that it vectorizes.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    encode_bases(uint8_t *codes, const char *seq, size_t len)
+
+{
+    size_t  c;
+    uint8_t ch, lower, valid;
+
+    for (c = 0; c < len; ++c)
+    {
+	ch = seq[c];
+	lower = ch | 0x20;
+	valid = (lower == 'a') | (lower == 'c') | (lower == 'g') |
+		(lower == 't') | (lower == 'u');
+	codes[c] = ((ch >> 1) & 3) | ((valid ^ 1) << 2);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Translate one frame of an encoded sequence into out, returning
+ *      a pointer to the end of the protein.  Frames 1 to 3 start at
+ *      offsets 0 to 2 of the forward strand, -1 to -3 at offsets 0 to 2
+ *      from the end of the reverse complement.  Codons with ambiguous
+ *      bases translate to X.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *translate_frame(char *out, const uint8_t *codes, size_t len,
+			 int frame)
+
+{
+    size_t  c, offset;
+    uint8_t b1, b2, b3;
+
+    if ( frame > 0 )
+    {
+	for (c = frame - 1; c + 3 <= len; c += 3)
+	{
+	    b1 = codes[c];
+	    b2 = codes[c + 1];
+	    b3 = codes[c + 2];
+	    *out++ = (b1 | b2 | b3) & AMBIGUOUS ? 'X' :
+		     Codon_table[(b1 << 4) | (b2 << 2) | b3];
+	}
+    }
+    else
+    {
+	// Complement of A=0 C=1 T=2 G=3 is code ^ 2
+	offset = -frame - 1;
+	for (c = len > offset ? len - offset : 0; c >= 3; c -= 3)
+	{
+	    b1 = codes[c - 1];
+	    b2 = codes[c - 2];
+	    b3 = codes[c - 3];
+	    *out++ = (b1 | b2 | b3) & AMBIGUOUS ? 'X' :
+		     Codon_table[((b1 ^ 2) << 4) | ((b2 ^ 2) << 2) | (b3 ^ 2)];
+	}
+    }
+    return out;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--frames 1|3|6] [--threads N] < file.fast[aq]\n",
+	    argv[0]);
+    exit(EX_USAGE);
+}
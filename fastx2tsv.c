@@ -13,16 +13,43 @@
 
 #include <stdio.h>
 #include <sysexits.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include <xtend/string.h>
 #include <biolibc/fastx.h>
 #include <biolibc/biolibc.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+void    usage(char *argv[]);
 
 int     main(int argc, char *argv[])
 
 {
     bl_fastx_t      rec = BL_FASTX_INIT;
     unsigned long   records = 0;
+    unsigned        threads = BLT_ZIO_THREADS_DEFAULT;
+    bool            bgzf = false;
+    int             arg;
+    FILE            *instream, *outstream = stdout;
+
+    PROF_INIT("fastx2tsv");
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    bgzf = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
 
     /*
      *  FIXME: This runs about as fast as
@@ -35,26 +62,64 @@ int     main(int argc, char *argv[])
     fputs("\nBe aware than fastx2tsv replaces TABs with spaces in the description\n"
 	  "so that they won't be interpreted as separators.\n\n", stderr);
 
-    bl_fastx_init(&rec, stdin);
-    while ( bl_fastx_read(&rec, stdin) != BL_READ_EOF )
+    // Decompress gzip or BGZF input on other cores
+    if ( (instream = blt_zopen("-", threads)) == NULL )
+    {
+	fprintf(stderr, "fastx2tsv: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( bgzf &&
+	 ((outstream = blt_bgzf_fdopen(STDOUT_FILENO, threads)) == NULL) )
     {
+	fprintf(stderr, "fastx2tsv: Cannot open BGZF output: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    bl_fastx_init(&rec, instream);
+    PROF_START(t);
+    while ( bl_fastx_read(&rec, instream) != BL_READ_EOF )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_RESTART(t);
 	// Replace TABs in description to avoid interpretation as separators
 	xt_strtr(bl_fastx_desc(&rec), "\t", " ", 0);
+	PROF_STOP(t, "convert");
+	PROF_RESTART(t);
 	switch(BL_FASTX_FORMAT(&rec))
 	{
 	    case    BL_FASTX_FORMAT_FASTA:
-		printf("%s\t%s\n",
+		fprintf(outstream, "%s\t%s\n",
 			bl_fastx_desc(&rec), bl_fastx_seq(&rec));
 			break;
 	    case    BL_FASTX_FORMAT_FASTQ:
-		printf("%s\t%s\t%s\t%s\n",
+		fprintf(outstream, "%s\t%s\t%s\t%s\n",
 			bl_fastx_desc(&rec), bl_fastx_seq(&rec),
 			bl_fastx_plus(&rec), bl_fastx_qual(&rec));
 			break;
 	}
+	PROF_STOP_IO(t, "write");
 	++records;
+	PROF_RESTART(t);
     }
+    PROF_RECORDS(records);
+    PROF_STREAM_BYTES(instream);
     bl_fastx_free(&rec);
+    blt_zclose(instream);
+    if ( blt_zclose(outstream) != 0 )
+    {
+	fprintf(stderr, "fastx2tsv: Error writing output.\n");
+	return EX_IOERR;
+    }
     fprintf(stderr, "%lu records processed.\n", records);
     return EX_OK;
 }
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--bgzf [--threads N]] < file.fastx > file.tsv\n",
+	    argv[0]);
+    exit(EX_USAGE);
+}
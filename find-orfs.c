@@ -2,83 +2,652 @@
  *  Description:
  *      Locate open reading frames (start codons and corresponding stop
  *      codons) in a sequence stream, which is often generated from a
- *      FASTA stream using blt fasta2seq.
+ *      FASTA stream using blt fasta2seq, or in each record of a FASTA
+ *      stream.
  *
- *  History: 
+ *      The stream is read in large blocks and each base is encoded as
+ *      a 2-bit value.  A rolling 6-bit codon code indexes a 64-entry
+ *      table of start and stop codons for both strands, so all six
+ *      reading frames are scanned in a single pass.
+ *
+ *      FASTA records are read in batches and scanned by a pool of
+ *      threads, one record at a time per thread, while the next batch
+ *      is read.  Output for each record is collected in memory and
+ *      written in input order.
+ *
+ *  History:
  *  Date        Name        Modification
  *  2022-04-14  Jason Bacon Begin
  ***************************************************************************/
 
 #include <stdio.h>
 #include <sysexits.h>
-#include <ctype.h>
 #include <stdlib.h>
-#include <sys/stat.h>
-#include <biolibc/translate.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <biolibc/fasta.h>
+#include "blt-profile.h"
+#include "blt-zio.h"
+
+#define BUFF_SIZE   (1024 * 1024)
+
+// Limits on records and bases buffered for one batch of threaded scans
+#define BATCH_RECORDS   4096
+#define BATCH_BASES     (64 * 1024 * 1024)
 
+// Codon classes, indexed by 6-bit codon code (first base in high bits)
+#define FWD_START   0x01    // ATG
+#define FWD_STOP    0x02    // TAA, TAG, TGA
+#define REV_START   0x04    // CAT (reverse complement of ATG)
+#define REV_STOP    0x08    // TTA, CTA, TCA
+
+#define NONE        -1
+
+typedef struct
+{
+    const char  *seqid;         // Prefix column for FASTA input, or NULL
+    int64_t     pos,            // Bases scanned so far
+		min_len,
+		fwd_start[3],   // First ATG after last stop, per frame
+		rev_stop[3],    // Last reverse stop, per frame
+		rev_start[3];   // Last CAT after rev_stop, per frame
+    int         rev_stop_codon[3];
+    unsigned    codon,          // Rolling 6-bit code of last 3 bases
+		valid;          // Consecutive unambiguous bases
+}   orf_state_t;
+
+typedef struct
+{
+    bl_fasta_t  *records;
+    char        **output;
+    size_t      *output_len;
+    unsigned    count,
+		next;           // Next record to scan
+    int64_t     min_len;
+    pthread_mutex_t lock;
+}   orf_batch_t;
+
+void    orf_tables_init(void);
+void    orf_state_init(orf_state_t *state, const char *seqid,
+		       int64_t offset, int64_t min_len);
+void    orf_scan(orf_state_t *state, const unsigned char *buff,
+		 size_t len, FILE *out);
+void    orf_flush(orf_state_t *state, FILE *out);
+void    orf_print(orf_state_t *state, FILE *out, char strand,
+		  unsigned frame, int64_t start, int64_t end,
+		  int start_codon, int stop_codon);
+int     find_orfs_raw(FILE *instream, int64_t offset, int64_t min_len);
+int     find_orfs_fasta(FILE *instream, int64_t min_len, unsigned threads);
+int     orf_batch_init(orf_batch_t *batch, int64_t min_len);
+int     orf_batch_read(orf_batch_t *batch, FILE *instream);
+void    orf_batch_free(orf_batch_t *batch);
+void    *orf_worker(void *arg);
+void    codon_string(char *str, int code, int reverse);
 void    usage(char *argv[]);
 
+static unsigned char    Codon_class[64];
+static int8_t           Base_code[256];
+
 int     main(int argc,char *argv[])
 
 {
-    long        pos,
-		offset,
-		c;
-    char        codon[4],
-		*end;
-    struct stat st;
-    FILE        *stream = stdin;
-    
-    if ( argc != 2 )
-	usage(argv);
+    int64_t     offset = -1,
+		min_len = 0;
+    long        cpus;
+    unsigned    threads;
+    int         arg, ch;
+    char        *end;
+
+    PROF_INIT("find-orfs");
+
+    threads = (cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1 ? 1 : cpus;
 
-    pos = strtol(argv[1], &end, 10);
-    if ( *end != '\0' )
+    for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); ++arg)
     {
-	fprintf(stderr, "Invalid offset: %s\n", argv[1]);
-	usage(argv);
+	if ( (strcmp(argv[arg], "--min-len") == 0) && (arg + 1 < argc) )
+	{
+	    min_len = strtoll(argv[++arg], &end, 10);
+	    if ( (*end != '\0') || (min_len < 0) )
+	    {
+		fprintf(stderr, "Invalid minimum length: %s\n", argv[arg]);
+		usage(argv);
+	    }
+	}
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+
+    switch(argc - arg)
+    {
+	case 0:
+	    break;
+
+	case 1:
+	    offset = strtoll(argv[arg], &end, 10);
+	    if ( (*end != '\0') || (offset < 0) )
+	    {
+		fprintf(stderr, "Invalid offset: %s\n", argv[arg]);
+		usage(argv);
+	    }
+	    break;
+
+	default:
+	    usage(argv);
     }
-    ++pos;  // Make 1-based
-    
-    fstat(fileno(stream), &st);
-    if ( ! (st.st_mode & S_IFIFO) )
+
+    orf_tables_init();
+
+    // FASTA input is detected by the '>' of the first description
+    if ( (ch = getc(stdin)) == EOF )
+	return EX_OK;
+    ungetc(ch, stdin);
+    if ( ch == '>' )
     {
-	if ( fseek(stream, pos - 1, SEEK_CUR) == -1 )
+	if ( offset != -1 )
 	{
-	    fputs("Seek failed.", stderr);
-	    return EX_SOFTWARE;
+	    fprintf(stderr, "%s: offset is not supported for FASTA input.\n",
+		    argv[0]);
+	    return EX_USAGE;
 	}
+	return find_orfs_fasta(stdin, min_len, threads);
     }
     else
+	return find_orfs_raw(stdin, offset == -1 ? 0 : offset, min_len);
+}
+
+
+void    orf_tables_init(void)
+
+{
+    memset(Base_code, -1, sizeof(Base_code));
+    Base_code['A'] = Base_code['a'] = 0;
+    Base_code['C'] = Base_code['c'] = 1;
+    Base_code['G'] = Base_code['g'] = 2;
+    Base_code['T'] = Base_code['t'] = Base_code['U'] = Base_code['u'] = 3;
+
+    // A=0 C=1 G=2 T=3, first base in bits 4-5
+    memset(Codon_class, 0, sizeof(Codon_class));
+    Codon_class[0x0e] = FWD_START;  // ATG
+    Codon_class[0x30] = FWD_STOP;   // TAA
+    Codon_class[0x32] = FWD_STOP;   // TAG
+    Codon_class[0x38] = FWD_STOP;   // TGA
+    Codon_class[0x13] = REV_START;  // CAT
+    Codon_class[0x3c] = REV_STOP;   // TTA
+    Codon_class[0x1c] = REV_STOP;   // CTA
+    Codon_class[0x34] = REV_STOP;   // TCA
+}
+
+
+void    orf_state_init(orf_state_t *state, const char *seqid,
+		       int64_t offset, int64_t min_len)
+
+{
+    int     frame;
+
+    state->seqid = seqid;
+    state->pos = offset;
+    state->min_len = min_len;
+    state->codon = state->valid = 0;
+    for (frame = 0; frame < 3; ++frame)
     {
-	for (c = 0; c < pos - 1; ++c)
-	    getc(stream);
+	state->fwd_start[frame] = NONE;
+	state->rev_stop[frame] = NONE;
+	state->rev_start[frame] = NONE;
     }
-    while ( ! feof(stream) )
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Scan a block of sequence for ORFs in all six reading frames,
+ *      continuing from the state left by the previous block.
+ *
+ *      Positions are 1-based and relative to the start of the sequence.
+ *      Forward ORFs run from the first ATG following a stop codon to the
+ *      next in-frame stop.  Reverse ORFs run from the last CAT preceding
+ *      a reverse stop down to the previous in-frame reverse stop, i.e.
+ *      the longest ORF on the minus strand.  Codons containing bases
+ *      other than ACGTU are never starts or stops.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    orf_scan(orf_state_t *state, const unsigned char *buff,
+		 size_t len, FILE *out)
+
+{
+    const unsigned char *p, *end;
+    int64_t     start, stop;
+    unsigned    frame, class;
+    int         code;
+
+    for (p = buff, end = buff + len; p < end; ++p)
     {
-	if ( (offset = bl_next_start_codon(stream, codon)) != EOF )
+	if ( (*p == '\n') || (*p == '\r') )
+	    continue;
+	++state->pos;
+	if ( (code = Base_code[*p]) < 0 )
 	{
-	    printf("Start codon %s at %ld (+%ld)\n", codon, pos + offset, offset);
-	    pos += offset + 3;
-	    if ( (offset = bl_next_stop_codon(stream, codon)) != EOF )
+	    state->valid = 0;
+	    continue;
+	}
+	state->codon = ((state->codon << 2) | code) & 0x3f;
+	if ( ++state->valid < 3 )
+	    continue;
+	if ( (class = Codon_class[state->codon]) == 0 )
+	    continue;
+
+	// 0-based position of the first base of this codon
+	start = state->pos - 3;
+	frame = start % 3;
+
+	if ( class == FWD_START )
+	{
+	    if ( state->fwd_start[frame] == NONE )
+		state->fwd_start[frame] = start;
+	}
+	else if ( class == FWD_STOP )
+	{
+	    if ( state->fwd_start[frame] != NONE )
 	    {
-		printf("Stop codon %s at %ld (+%ld)\n", codon, pos + offset, offset);
-		pos += offset + 3;
+		orf_print(state, out, '+', frame, state->fwd_start[frame],
+			  start + 3, 0x0e, state->codon);
+		state->fwd_start[frame] = NONE;
 	    }
-	    else
-		puts("No stop codon found.");
 	}
+	else if ( class == REV_START )
+	    state->rev_start[frame] = start;
 	else
-	    puts("No start codon found.");
+	{
+	    stop = state->rev_stop[frame];
+	    if ( (stop != NONE) && (state->rev_start[frame] > stop) )
+		orf_print(state, out, '-', frame, stop,
+			  state->rev_start[frame] + 3, 0x13,
+			  state->rev_stop_codon[frame]);
+	    state->rev_stop[frame] = start;
+	    state->rev_stop_codon[frame] = state->codon;
+	    state->rev_start[frame] = NONE;
+	}
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Report reverse ORFs still pending at the end of a sequence.  A
+ *      reverse ORF is normally printed when the next in-frame reverse
+ *      stop shows that its CAT was the last one, and the end of the
+ *      sequence shows the same.  Forward ORFs without a stop are not
+ *      complete and are not printed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    orf_flush(orf_state_t *state, FILE *out)
+
+{
+    unsigned    frame;
+    int64_t     stop;
+
+    for (frame = 0; frame < 3; ++frame)
+    {
+	stop = state->rev_stop[frame];
+	if ( (stop != NONE) && (state->rev_start[frame] > stop) )
+	    orf_print(state, out, '-', frame, stop,
+		      state->rev_start[frame] + 3, 0x13,
+		      state->rev_stop_codon[frame]);
+	state->rev_stop[frame] = state->rev_start[frame] = NONE;
     }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print one ORF if it meets the minimum length.  start is 0-based,
+ *      end is 1-based (i.e. 0-based exclusive), codons are 6-bit codes
+ *      on the forward strand.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    orf_print(orf_state_t *state, FILE *out, char strand,
+		  unsigned frame, int64_t start, int64_t end,
+		  int start_codon, int stop_codon)
+
+{
+    char    start_str[4], stop_str[4];
+
+    if ( end - start < state->min_len )
+	return;
+    codon_string(start_str, start_codon, strand == '-');
+    codon_string(stop_str, stop_codon, strand == '-');
+    if ( state->seqid != NULL )
+	fprintf(out, "%s\t", state->seqid);
+    fprintf(out, "%c\t%u\t%" PRId64 "\t%" PRId64 "\t%" PRId64 "\t%s\t%s\n",
+	    strand, frame + 1, start + 1, end, end - start,
+	    start_str, stop_str);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Scan a raw sequence stream (no description lines) as a single
+ *      sequence.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     find_orfs_raw(FILE *instream, int64_t offset, int64_t min_len)
+
+{
+    static unsigned char    buff[BUFF_SIZE];
+    static char             out_buff[BUFF_SIZE];
+    size_t          bytes;
+    int64_t         skip;
+    orf_state_t     state;
+
+    setvbuf(stdout, out_buff, _IOFBF, BUFF_SIZE);
+    orf_state_init(&state, NULL, offset, min_len);
+
+    // Seek past offset if possible, otherwise read past it in blocks
+    if ( (offset > 0) && (fseeko(instream, offset, SEEK_CUR) == -1) )
+    {
+	for (skip = offset; skip > 0; skip -= bytes)
+	{
+	    bytes = fread(buff, 1, skip < BUFF_SIZE ? skip : BUFF_SIZE,
+			  instream);
+	    if ( bytes == 0 )
+		break;
+	}
+    }
+
+    puts("#strand\tframe\tstart\tend\tlength\tstart-codon\tstop-codon");
+    PROF_START(t);
+    while ( (bytes = fread(buff, 1, BUFF_SIZE, instream)) > 0 )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(bytes);
+	PROF_RESTART(t);
+	orf_scan(&state, buff, bytes, stdout);
+	PROF_STOP(t, "scan");
+	PROF_RESTART(t);
+    }
+
+    if ( ferror(instream) )
+    {
+	fprintf(stderr, "find-orfs: Error reading input: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+    orf_flush(&state, stdout);
+    fflush(stdout);
     return EX_OK;
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Scan each record of a FASTA stream separately, using a pool of
+ *      threads.  Records are read in batches limited by record count
+ *      and total bases.  Each batch is scanned in parallel while the
+ *      main thread reads the next into a second batch, and output is
+ *      written in input order once the scan is done.  If a thread cannot
+ *      be created, the main thread scans the rest of the batch itself
+ *      before reading on.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     find_orfs_fasta(FILE *instream, int64_t min_len, unsigned threads)
+
+{
+    orf_batch_t batch[2], *scan;
+    pthread_t   *tids;
+    unsigned    c, t, next = 0;
+    int         status, error;
+
+    tids = calloc(threads, sizeof(*tids));
+    if ( (tids == NULL) || (orf_batch_init(&batch[0], min_len) != 0) ||
+	 (orf_batch_init(&batch[1], min_len) != 0) )
+    {
+	fputs("find-orfs: Could not allocate batch.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    puts("#seqid\tstrand\tframe\tstart\tend\tlength\tstart-codon\tstop-codon");
+    PROF_START(t0);
+    status = orf_batch_read(&batch[next], instream);
+    PROF_STOP_IO(t0, "read");
+    while ( batch[next].count > 0 )
+    {
+	scan = &batch[next];
+	next = !next;
+
+	PROF_RESTART(t0);
+	scan->next = 0;
+	for (t = 0, error = 0; (t < threads) && (t < scan->count) &&
+	     ((error = pthread_create(&tids[t], NULL, orf_worker, scan)) == 0);
+	     ++t)
+	    ;
+	if ( error != 0 )
+	    orf_worker(scan);
+	PROF_STOP(t0, "scan");
+
+	PROF_RESTART(t0);
+	if ( status == BL_READ_OK )
+	    status = orf_batch_read(&batch[next], instream);
+	else
+	    batch[next].count = 0;
+	PROF_STOP_IO(t0, "read");
+
+	PROF_RESTART(t0);
+	while ( t > 0 )
+	    pthread_join(tids[--t], NULL);
+	PROF_STOP(t0, "scan");
+
+	PROF_RESTART(t0);
+	for (c = 0; c < scan->count; ++c)
+	{
+	    fwrite(scan->output[c], scan->output_len[c], 1, stdout);
+	    free(scan->output[c]);
+	}
+	PROF_STOP_IO(t0, "write");
+    }
+
+    orf_batch_free(&batch[0]);
+    orf_batch_free(&batch[1]);
+    free(tids);
+
+    if ( status != BL_READ_EOF )
+    {
+	fprintf(stderr, "find-orfs: Error reading FASTA stream: %s\n",
+		strerror(errno));
+	return EX_DATAERR;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Allocate the records and output buffers of a batch.  Returns 0,
+ *      or -1 if out of memory.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     orf_batch_init(orf_batch_t *batch, int64_t min_len)
+
+{
+    unsigned    c;
+
+    batch->records = calloc(BATCH_RECORDS, sizeof(*batch->records));
+    batch->output = calloc(BATCH_RECORDS, sizeof(*batch->output));
+    batch->output_len = calloc(BATCH_RECORDS, sizeof(*batch->output_len));
+    if ( (batch->records == NULL) || (batch->output == NULL) ||
+	 (batch->output_len == NULL) )
+	return -1;
+    for (c = 0; c < BATCH_RECORDS; ++c)
+	bl_fasta_init(&batch->records[c]);
+    batch->count = 0;
+    batch->min_len = min_len;
+    pthread_mutex_init(&batch->lock, NULL);
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read the next batch of records.  Returns the status of the last
+ *      bl_fasta_read(), BL_READ_OK if the batch filled up first.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     orf_batch_read(orf_batch_t *batch, FILE *instream)
+
+{
+    size_t  bases;
+    int     status = BL_READ_OK;
+
+    for (batch->count = 0, bases = 0;
+	 (batch->count < BATCH_RECORDS) && (bases < BATCH_BASES) &&
+	 ((status = bl_fasta_read(&batch->records[batch->count], instream))
+	    == BL_READ_OK);
+	 ++batch->count)
+	bases += strlen(BL_FASTA_SEQ(&batch->records[batch->count]));
+    PROF_RECORDS(batch->count);
+    PROF_BYTES(bases);
+    return status;
+}
+
+
+void    orf_batch_free(orf_batch_t *batch)
+
+{
+    unsigned    c;
+
+    for (c = 0; c < BATCH_RECORDS; ++c)
+	bl_fasta_free(&batch->records[c]);
+    free(batch->records);
+    free(batch->output);
+    free(batch->output_len);
+    pthread_mutex_destroy(&batch->lock);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Thread function: scan records from the batch until none are left,
+ *      writing ORFs for each record to a separate memory stream.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *orf_worker(void *arg)
+
+{
+    orf_batch_t *batch = arg;
+    orf_state_t state;
+    bl_fasta_t  *record;
+    FILE        *out;
+    char        *seqid;
+    size_t      len;
+    unsigned    c;
+
+    while ( true )
+    {
+	pthread_mutex_lock(&batch->lock);
+	c = batch->next++;
+	pthread_mutex_unlock(&batch->lock);
+	if ( c >= batch->count )
+	    break;
+
+	// Seqid is the description up to the first whitespace
+	record = &batch->records[c];
+	seqid = BL_FASTA_DESC(record) + 1;
+	len = strcspn(seqid, " \t");
+	seqid[len] = '\0';
+
+	out = open_memstream(&batch->output[c], &batch->output_len[c]);
+	if ( out == NULL )
+	{
+	    fputs("find-orfs: Could not open memory stream.\n", stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+	orf_state_init(&state, seqid, 0, batch->min_len);
+	orf_scan(&state, (unsigned char *)BL_FASTA_SEQ(record),
+		 strlen(BL_FASTA_SEQ(record)), out);
+	orf_flush(&state, out);
+	fclose(out);
+    }
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert a 6-bit codon code to text.  If reverse is non-zero,
+ *      return the reverse complement, i.e. the codon as read on the
+ *      minus strand.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    codon_string(char *str, int code, int reverse)
+
+{
+    static const char   bases[] = "ACGT";
+
+    if ( reverse )
+    {
+	str[0] = bases[3 - (code & 3)];
+	str[1] = bases[3 - ((code >> 2) & 3)];
+	str[2] = bases[3 - (code >> 4)];
+    }
+    else
+    {
+	str[0] = bases[code >> 4];
+	str[1] = bases[(code >> 2) & 3];
+	str[2] = bases[code & 3];
+    }
+    str[3] = '\0';
+}
+
+
 void    usage(char *argv[])
 
 {
-    fprintf(stderr, "Usage: %s offset\n(offset is 0-based)\n",
+    fprintf(stderr, "Usage: %s [--min-len N] [--threads N] [offset] < file.seq|file.fasta\n"
+		    "(offset is 0-based, raw sequence input only)\n",
 	    argv[0]);
     exit(EX_USAGE);
 }
@@ -0,0 +1,676 @@
+/***************************************************************************
+ *  Description:
+ *      Report GFF3 features overlapping genomic regions, using a
+ *      persistent index built once per GFF3 file.
+ *
+ *      The index holds one fixed-size record per feature (start, end,
+ *      and location of the line in the GFF3 file), grouped by seqid and
+ *      sorted by start, plus a string pool of seqids.  Within each seqid
+ *      the sorted array is treated as an implicit binary tree in which
+ *      each node also holds the maximum end of its subtree (an augmented
+ *      interval tree), so an overlap query visits only O(log n) nodes
+ *      plus the hits.  Both the index and the GFF3 file are mmap()ed,
+ *      so queries need no parsing and almost no startup time.
+ *
+ *      The size and modification time of the GFF3 file are recorded in
+ *      the index, so a stale index is detected.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "blt-profile.h"
+
+#define GQI_MAGIC       "BLTGQI2"  // 2: max_end fixed, rebuild old indexes
+#define GQI_EXT         ".gqi"
+#define GFF3_COLS       9
+#define BED_LINE_MAX    4096
+
+typedef struct
+{
+    char        magic[8];
+    uint64_t    gff3_size;
+    int64_t     gff3_mtime;
+    uint64_t    seq_count,
+		feature_count,
+		pool_size;
+}   gqi_header_t;
+
+typedef struct
+{
+    uint64_t    name_offset,    // In string pool, null-terminated
+		first_feature,
+		feature_count;
+    int64_t     root_level;     // Level of the root of the implicit tree
+}   gqi_seq_t;
+
+typedef struct
+{
+    int64_t     start,          // 0-based
+		end,            // 0-based, exclusive
+		max_end;        // Max end in this node's subtree
+    uint64_t    line_offset;    // In GFF3 file
+    uint32_t    line_len,       // Excluding newline
+		seqid_len;      // Used only while building
+}   gqi_feature_t;
+
+typedef struct
+{
+    const char      *gff3;      // mmap()ed GFF3
+    size_t          gff3_size;
+    gqi_header_t    *header;    // mmap()ed index
+    size_t          index_size;
+    gqi_seq_t       *seqs;
+    gqi_feature_t   *features;
+    const char      *pool;
+}   gqi_t;
+
+int     gqi_build(const char *gff3_file);
+int     gqi_open(gqi_t *gqi, const char *gff3_file);
+int64_t gqi_make_tree(gqi_feature_t *a, int64_t n);
+int     gqi_query(gqi_t *gqi, const char *seqid, int64_t start, int64_t end);
+int     gqi_query_bed(gqi_t *gqi, const char *bed_file);
+void    print_feature(gqi_t *gqi, gqi_feature_t *feature);
+int     feature_cmp(const void *p1, const void *p2);
+void    *map_file(const char *filename, size_t *size, struct stat *st);
+void    usage(char *argv[]);
+
+// GFF3 text for feature_cmp() during build
+static const char   *Gff3_text;
+
+int     main(int argc,char *argv[])
+
+{
+    gqi_t   gqi;
+    char    *seqid, *p, *end;
+    int64_t start, stop;
+    int     arg, status;
+
+    PROF_INIT("gff3-query");
+
+    if ( argc < 3 )
+	usage(argv);
+
+    if ( strcmp(argv[1], "--index") == 0 )
+    {
+	for (arg = 2; arg < argc; ++arg)
+	    if ( (status = gqi_build(argv[arg])) != EX_OK )
+		return status;
+	return EX_OK;
+    }
+
+    if ( (status = gqi_open(&gqi, argv[1])) != EX_OK )
+	return status;
+
+    if ( strcmp(argv[2], "--bed") == 0 )
+    {
+	if ( argc != 4 )
+	    usage(argv);
+	return gqi_query_bed(&gqi, argv[3]);
+    }
+
+    // chrom:start-end, 1-based, inclusive like GFF3
+    for (arg = 2; arg < argc; ++arg)
+    {
+	seqid = argv[arg];
+	if ( (p = strrchr(seqid, ':')) == NULL )
+	{
+	    fprintf(stderr, "%s: Region must be seqid:start-end: %s\n",
+		    argv[0], argv[arg]);
+	    return EX_USAGE;
+	}
+	*p++ = '\0';
+	start = strtoll(p, &end, 10);
+	if ( (*end != '-') || (start < 1) )
+	{
+	    fprintf(stderr, "%s: Invalid start: %s\n", argv[0], p);
+	    return EX_USAGE;
+	}
+	stop = strtoll(end + 1, &end, 10);
+	if ( (*end != '\0') || (stop < start) )
+	{
+	    fprintf(stderr, "%s: Invalid end: %s\n", argv[0], p);
+	    return EX_USAGE;
+	}
+	PROF_START(t);
+	status = gqi_query(&gqi, seqid, start - 1, stop);
+	PROF_STOP(t, "query");
+	PROF_RECORDS(1);
+	if ( status != EX_OK )
+	    return status;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Build gff3_file.gqi from gff3_file.  Comment and directive lines
+ *      are skipped, and indexing stops at a ##FASTA directive.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gqi_build(const char *gff3_file)
+
+{
+    struct stat     st;
+    const char      *gff3, *line, *eol, *end, *col, *tab;
+    char            index_file[PATH_MAX + 1], tmp_file[PATH_MAX + 8], *num_end;
+    size_t          gff3_size, count = 0, array_size = 1024, seq_count, f,
+		    first, pool_size;
+    gqi_feature_t   *features, *new_features;
+    gqi_seq_t       *seqs;
+    gqi_header_t    header;
+    FILE            *out;
+    int             c;
+
+    if ( (gff3 = map_file(gff3_file, &gff3_size, &st)) == NULL )
+	return EX_NOINPUT;
+
+    if ( (features = malloc(array_size * sizeof(*features))) == NULL )
+    {
+	fputs("gff3-query: Could not allocate features.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    end = gff3 + gff3_size;
+    PROF_START(t);
+    for (line = gff3; line < end; line = eol + 1)
+    {
+	if ( (eol = memchr(line, '\n', end - line)) == NULL )
+	    eol = end;
+	if ( (*line == '#') || (eol == line) )
+	{
+	    if ( (eol - line >= 7) && (memcmp(line, "##FASTA", 7) == 0) )
+		break;
+	    continue;
+	}
+
+	if ( count == array_size )
+	{
+	    array_size *= 2;
+	    new_features = realloc(features, array_size * sizeof(*features));
+	    if ( new_features == NULL )
+	    {
+		fputs("gff3-query: Could not allocate features.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    features = new_features;
+	}
+
+	// Columns 1, 4, and 5: seqid, start, end
+	for (c = 1, col = line; (c < 4) && (col != NULL); ++c)
+	    if ( (col = memchr(col, '\t', eol - col)) != NULL )
+		++col;
+	if ( col == NULL )
+	{
+	    fprintf(stderr, "gff3-query: Expected %d columns: %.*s\n",
+		    GFF3_COLS, (int)(eol - line), line);
+	    return EX_DATAERR;
+	}
+	features[count].start = strtoll(col, &num_end, 10) - 1;
+	if ( *num_end != '\t' )
+	{
+	    fprintf(stderr, "gff3-query: Invalid start: %.*s\n",
+		    (int)(eol - line), line);
+	    return EX_DATAERR;
+	}
+	features[count].end = strtoll(num_end + 1, &num_end, 10);
+	if ( *num_end != '\t' )
+	{
+	    fprintf(stderr, "gff3-query: Invalid end: %.*s\n",
+		    (int)(eol - line), line);
+	    return EX_DATAERR;
+	}
+	tab = memchr(line, '\t', eol - line);
+	features[count].seqid_len = tab - line;
+	features[count].line_offset = line - gff3;
+	features[count].line_len = eol - line;
+	if ( (eol > line) && (eol[-1] == '\r') )
+	    --features[count].line_len;
+	++count;
+    }
+    PROF_STOP(t, "parse");
+    PROF_RECORDS(count);
+    PROF_BYTES(gff3_size);
+
+    // Group by seqid, then sort by start
+    PROF_RESTART(t);
+    Gff3_text = gff3;
+    qsort(features, count, sizeof(*features), feature_cmp);
+    PROF_STOP(t, "sort");
+
+    // Count seqids and size the string pool
+    seq_count = pool_size = 0;
+    for (f = 0; f < count; ++f)
+	if ( (f == 0) || (feature_cmp(&features[f - 1], &features[f]) <= -2) )
+	{
+	    ++seq_count;
+	    pool_size += features[f].seqid_len + 1;
+	}
+
+    if ( (seqs = calloc(seq_count, sizeof(*seqs))) == NULL )
+    {
+	fputs("gff3-query: Could not allocate seqids.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    snprintf(index_file, PATH_MAX, "%s%s", gff3_file, GQI_EXT);
+    snprintf(tmp_file, PATH_MAX + 8, "%s.tmp", index_file);
+    if ( (out = fopen(tmp_file, "w")) == NULL )
+    {
+	fprintf(stderr, "gff3-query: Cannot create %s: %s\n",
+		tmp_file, strerror(errno));
+	return EX_CANTCREAT;
+    }
+
+    // Build the tree for each seqid and fill in the seqid table
+    PROF_RESTART(t);
+    seq_count = pool_size = 0;
+    for (first = 0; first < count; first = f)
+    {
+	for (f = first + 1; (f < count) &&
+	     (feature_cmp(&features[first], &features[f]) > -2); ++f)
+	    ;
+	seqs[seq_count].name_offset = pool_size;
+	seqs[seq_count].first_feature = first;
+	seqs[seq_count].feature_count = f - first;
+	seqs[seq_count].root_level = gqi_make_tree(features + first, f - first);
+	pool_size += features[first].seqid_len + 1;
+	++seq_count;
+    }
+    PROF_STOP(t, "tree");
+
+    PROF_RESTART(t);
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GQI_MAGIC, sizeof(header.magic));
+    header.gff3_size = st.st_size;
+    header.gff3_mtime = st.st_mtime;
+    header.seq_count = seq_count;
+    header.feature_count = count;
+    header.pool_size = pool_size;
+
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(seqs, sizeof(*seqs), seq_count, out);
+    fwrite(features, sizeof(*features), count, out);
+    for (f = 0; f < seq_count; ++f)
+    {
+	first = seqs[f].first_feature;
+	fwrite(gff3 + features[first].line_offset,
+	       features[first].seqid_len, 1, out);
+	putc('\0', out);
+    }
+    if ( (fclose(out) != 0) || (rename(tmp_file, index_file) != 0) )
+    {
+	fprintf(stderr, "gff3-query: Error writing %s: %s\n",
+		index_file, strerror(errno));
+	unlink(tmp_file);
+	return EX_IOERR;
+    }
+    PROF_STOP_IO(t, "write");
+
+    fprintf(stderr, "gff3-query: Indexed %zu features on %zu seqids in %s.\n",
+	    count, seq_count, index_file);
+    if ( gff3_size > 0 )
+	munmap((void *)gff3, gff3_size);
+    free(features);
+    free(seqs);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Order features by seqid, then start, then end.  Returns -2 or
+ *      less for different seqids, -1, 0, or 1 for the same seqid.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     feature_cmp(const void *p1, const void *p2)
+
+{
+    const gqi_feature_t *f1 = p1, *f2 = p2;
+    size_t  len;
+    int     status;
+
+    len = f1->seqid_len < f2->seqid_len ? f1->seqid_len : f2->seqid_len;
+    status = memcmp(Gff3_text + f1->line_offset, Gff3_text + f2->line_offset,
+		    len);
+    if ( status != 0 )
+	return status < 0 ? -2 : 2;
+    if ( f1->seqid_len != f2->seqid_len )
+	return f1->seqid_len < f2->seqid_len ? -2 : 2;
+    if ( f1->start != f2->start )
+	return f1->start < f2->start ? -1 : 1;
+    if ( f1->end != f2->end )
+	return f1->end < f2->end ? -1 : 1;
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compute max_end for the implicit interval tree over n features
+ *      sorted by start.  Node i is at level k if its k lowest bits are
+ *      1 and bit k is 0, so leaves are even indices.  The children of
+ *      node i at level k are i - 2^(k-1) and i + 2^(k-1).  Returns the
+ *      level of the root, which is node 2^level - 1.
+ *
+ *      This is the layout used by cgranges (Li, 2019).
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int64_t gqi_make_tree(gqi_feature_t *a, int64_t n)
+
+{
+    int64_t i, last_i = 0, last = 0, k, x, left, right, max;
+
+    if ( n <= 0 )
+	return -1;
+
+    for (i = 0; i < n; i += 2)
+    {
+	last_i = i;
+	last = a[i].max_end = a[i].end;
+    }
+    for (k = 1; ((int64_t)1 << k) <= n; ++k)
+    {
+	x = (int64_t)1 << (k - 1);
+	for (i = (x << 1) - 1; i < n; i += x << 2)
+	{
+	    left = a[i - x].max_end;
+	    right = i + x < n ? a[i + x].max_end : last;
+	    max = a[i].end;
+	    if ( left > max )
+		max = left;
+	    if ( right > max )
+		max = right;
+	    a[i].max_end = max;
+	}
+	// Track the max_end of the rightmost node at this level
+	last_i = (last_i >> k) & 1 ? last_i - x : last_i + x;
+	if ( (last_i < n) && (a[last_i].max_end > last) )
+	    last = a[last_i].max_end;
+    }
+    return k - 1;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      mmap() a GFF3 file and its index and validate the index.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gqi_open(gqi_t *gqi, const char *gff3_file)
+
+{
+    char        index_file[PATH_MAX + 1];
+    struct stat gff3_st, index_st;
+    gqi_header_t    *h;
+
+    snprintf(index_file, PATH_MAX, "%s%s", gff3_file, GQI_EXT);
+    if ( (gqi->gff3 = map_file(gff3_file, &gqi->gff3_size, &gff3_st)) == NULL )
+	return EX_NOINPUT;
+    if ( (gqi->header = map_file(index_file, &gqi->index_size, &index_st)) == NULL )
+    {
+	fprintf(stderr, "gff3-query: Run \"blt gff3-query --index %s\" first.\n",
+		gff3_file);
+	return EX_NOINPUT;
+    }
+
+    h = gqi->header;
+    if ( (gqi->index_size < sizeof(*h)) ||
+	 (memcmp(h->magic, GQI_MAGIC, sizeof(h->magic)) != 0) ||
+	 (gqi->index_size != sizeof(*h) + h->seq_count * sizeof(gqi_seq_t) +
+			     h->feature_count * sizeof(gqi_feature_t) +
+			     h->pool_size) )
+    {
+	fprintf(stderr, "gff3-query: %s is not a valid index.\n", index_file);
+	return EX_DATAERR;
+    }
+    if ( (h->gff3_size != (uint64_t)gff3_st.st_size) ||
+	 (h->gff3_mtime != (int64_t)gff3_st.st_mtime) )
+    {
+	fprintf(stderr, "gff3-query: %s is out of date.  Run \"blt gff3-query --index %s\".\n",
+		index_file, gff3_file);
+	return EX_DATAERR;
+    }
+
+    gqi->seqs = (gqi_seq_t *)(h + 1);
+    gqi->features = (gqi_feature_t *)(gqi->seqs + h->seq_count);
+    gqi->pool = (const char *)(gqi->features + h->feature_count);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Print GFF3 lines for all features on seqid overlapping the 0-based
+ *      half-open interval [start, end), in order of start position.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gqi_query(gqi_t *gqi, const char *seqid, int64_t start, int64_t end)
+
+{
+    struct
+    {
+	int64_t     level, node;
+	int         left_done;
+    }   stack[64], z;
+    gqi_seq_t       *seq;
+    gqi_feature_t   *a, *r;
+    int64_t         n, i, i0, i1, child;
+    size_t          low, high, mid;
+    int             top = 0, status;
+
+    // Binary search for seqid, pool is sorted
+    low = 0;
+    high = gqi->header->seq_count;
+    seq = NULL;
+    while ( low < high )
+    {
+	mid = (low + high) / 2;
+	status = strcmp(seqid, gqi->pool + gqi->seqs[mid].name_offset);
+	if ( status == 0 )
+	{
+	    seq = &gqi->seqs[mid];
+	    break;
+	}
+	else if ( status < 0 )
+	    high = mid;
+	else
+	    low = mid + 1;
+    }
+    if ( seq == NULL )
+	return EX_OK;
+
+    a = gqi->features + seq->first_feature;
+    n = seq->feature_count;
+    stack[top].level = seq->root_level;
+    stack[top].node = ((int64_t)1 << seq->root_level) - 1;
+    stack[top++].left_done = 0;
+    while ( top > 0 )
+    {
+	z = stack[--top];
+	if ( z.level <= 3 )
+	{
+	    // Small subtree: scan it linearly
+	    i0 = z.node >> z.level << z.level;
+	    i1 = i0 + ((int64_t)1 << (z.level + 1)) - 1;
+	    if ( i1 > n )
+		i1 = n;
+	    for (i = i0; (i < i1) && (a[i].start < end); ++i)
+	    {
+		r = &a[i];
+		if ( start < r->end )
+		    print_feature(gqi, r);
+	    }
+	}
+	else if ( !z.left_done )
+	{
+	    // Revisit this node after the left subtree
+	    child = z.node - ((int64_t)1 << (z.level - 1));
+	    stack[top].level = z.level;
+	    stack[top].node = z.node;
+	    stack[top++].left_done = 1;
+	    if ( (child >= n) || (a[child].max_end > start) )
+	    {
+		stack[top].level = z.level - 1;
+		stack[top].node = child;
+		stack[top++].left_done = 0;
+	    }
+	}
+	else if ( (z.node < n) && (a[z.node].start < end) )
+	{
+	    r = &a[z.node];
+	    if ( start < r->end )
+		print_feature(gqi, r);
+	    stack[top].level = z.level - 1;
+	    stack[top].node = z.node + ((int64_t)1 << (z.level - 1));
+	    stack[top++].left_done = 0;
+	}
+    }
+    return EX_OK;
+}
+
+
+void    print_feature(gqi_t *gqi, gqi_feature_t *feature)
+
+{
+    fwrite(gqi->gff3 + feature->line_offset, feature->line_len, 1, stdout);
+    putchar('\n');
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Run a query for each region in a BED file (0-based, half-open).
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gqi_query_bed(gqi_t *gqi, const char *bed_file)
+
+{
+    FILE    *bed_stream;
+    char    line[BED_LINE_MAX + 1], *seqid, *p, *end;
+    int64_t start, stop;
+    int     status;
+
+    if ( strcmp(bed_file, "-") == 0 )
+	bed_stream = stdin;
+    else if ( (bed_stream = fopen(bed_file, "r")) == NULL )
+    {
+	fprintf(stderr, "gff3-query: Cannot open %s: %s\n", bed_file,
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+
+    PROF_START(t);
+    while ( fgets(line, BED_LINE_MAX, bed_stream) != NULL )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_RESTART(t);
+	if ( (*line == '#') || (memcmp(line, "track", 5) == 0) ||
+	     (memcmp(line, "browser", 7) == 0) || (*line == '\n') )
+	    continue;
+	p = line;
+	seqid = strsep(&p, "\t");
+	if ( p == NULL )
+	{
+	    fprintf(stderr, "gff3-query: Invalid BED line: %s", line);
+	    return EX_DATAERR;
+	}
+	start = strtoll(p, &end, 10);
+	if ( *end != '\t' )
+	{
+	    fprintf(stderr, "gff3-query: Invalid BED start: %s\n", p);
+	    return EX_DATAERR;
+	}
+	stop = strtoll(end + 1, &end, 10);
+	if ( (*end != '\t') && (*end != '\n') && (*end != '\r') && (*end != '\0') )
+	{
+	    fprintf(stderr, "gff3-query: Invalid BED end: %s\n", p);
+	    return EX_DATAERR;
+	}
+	PROF_RESTART(t);
+	status = gqi_query(gqi, seqid, start, stop);
+	PROF_STOP(t, "query");
+	PROF_RECORDS(1);
+	if ( status != EX_OK )
+	    return status;
+	PROF_RESTART(t);
+    }
+    PROF_STREAM_BYTES(bed_stream);
+    if ( bed_stream != stdin )
+	fclose(bed_stream);
+    return EX_OK;
+}
+
+
+void    *map_file(const char *filename, size_t *size, struct stat *st)
+
+{
+    void    *p;
+    int     fd;
+
+    if ( (fd = open(filename, O_RDONLY)) == -1 )
+    {
+	fprintf(stderr, "gff3-query: Cannot open %s: %s\n", filename,
+		strerror(errno));
+	return NULL;
+    }
+    fstat(fd, st);
+    *size = st->st_size;
+    if ( *size == 0 )
+	p = "";     // mmap() fails on empty files
+    else if ( (p = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED )
+    {
+	fprintf(stderr, "gff3-query: Cannot mmap %s: %s\n", filename,
+		strerror(errno));
+	p = NULL;
+    }
+    close(fd);
+    return p;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s --index file.gff3 [file.gff3 ...]\n", argv[0]);
+    fprintf(stderr, "       %s file.gff3 seqid:start-end [seqid:start-end ...]\n", argv[0]);
+    fprintf(stderr, "       %s file.gff3 --bed regions.bed|-\n", argv[0]);
+    exit(EX_USAGE);
+}
@@ -0,0 +1,790 @@
+/***************************************************************************
+ *  Description:
+ *      Sort a GFF3 file by seqid and position within a fixed memory
+ *      budget, keeping related lines together.
+ *
+ *      Lines are sorted in groups rather than individually.  A group
+ *      begins with a feature that has no Parent= attribute and includes
+ *      all following features with a Parent= attribute, i.e. a gene
+ *      and its transcripts, exons, etc. in the usual GFF3 order.  A
+ *      "###" directive ends a group and stays with it.  Comments and
+ *      other directives within the features are kept with the following
+ *      group.  Directives preceding the first feature are written first
+ *      and a ##FASTA section, if present, is written last.
+ *
+ *      Groups are collected in memory until the budget is reached, then
+ *      sorted and written to a temporary file as a sorted run.  The runs
+ *      are then merged using a heap.  Groups with equal keys remain in
+ *      input order.
+ *
+ *      Seqids are compared in natural order (chr2 before chr10), or in
+ *      the order listed in a file such as the output of blt chrom-lens,
+ *      so that the output can be matched against a FASTA file.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#ifdef __linux__
+#define _GNU_SOURCE // memmem()
+#endif
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include "blt-profile.h"
+
+#define DEFAULT_MEM_MIB     512
+#define OUT_BUFF_SIZE       (1024 * 1024)
+#define UNRANKED            UINT32_MAX
+
+typedef struct
+{
+    int64_t     start,
+		end;
+    uint64_t    seq;            // Input order, for a stable sort
+    uint32_t    rank,           // Position of seqid in --order file
+		seqid_len;
+    uint64_t    text_offset,    // In arena: seqid, then text
+		text_len;
+}   group_t;
+
+typedef struct
+{
+    char        **names;
+    size_t      count;
+}   order_t;
+
+typedef struct
+{
+    size_t      arena_size,
+		arena_len,
+		pending;        // Comments at end of arena not yet in a group
+    group_t     *groups;
+    size_t      group_count,
+		group_array_size;
+    FILE        **runs;
+    size_t      run_count,
+		run_array_size;
+}   sort_t;
+
+typedef struct
+{
+    FILE        *stream;
+    group_t     group;
+    char        *text;          // seqid followed by group text
+    size_t      text_size;
+}   run_t;
+
+int     gff3_sort(FILE *instream, size_t mem_budget, order_t *order);
+int     read_order(const char *filename, order_t *order);
+uint32_t seqid_rank(order_t *order, const char *seqid, size_t len);
+int     natural_cmp(const char *s1, size_t len1, const char *s2, size_t len2);
+int     group_cmp(const group_t *g1, const char *seqid1,
+		  const group_t *g2, const char *seqid2);
+int     arena_group_cmp(const void *p1, const void *p2);
+int     spill(sort_t *sort, size_t count, size_t keep);
+FILE    *write_run(group_t *groups, size_t count);
+int     read_run(run_t *run);
+int     merge_runs(FILE **runs, size_t run_count);
+bool    has_parent(const char *line, size_t len);
+FILE    *temp_file(void);
+void    usage(char *argv[]);
+
+// Arena for arena_group_cmp(), which qsort() does not pass
+static char     *Arena;
+
+int     main(int argc,char *argv[])
+
+{
+    FILE    *instream = stdin;
+    order_t order = { NULL, 0 };
+    size_t  mem_mib = DEFAULT_MEM_MIB;
+    char    *end;
+    int     arg, status;
+
+    PROF_INIT("gff3-sort");
+
+    for (arg = 1; (arg < argc) && (argv[arg][0] == '-') &&
+		  (argv[arg][1] != '\0'); ++arg)
+    {
+	if ( (strcmp(argv[arg], "--mem") == 0) && (arg + 1 < argc) )
+	{
+	    mem_mib = strtoul(argv[++arg], &end, 10);
+	    if ( (*end != '\0') || (mem_mib == 0) )
+	    {
+		fprintf(stderr, "Invalid memory size: %s\n", argv[arg]);
+		usage(argv);
+	    }
+	}
+	else if ( (strcmp(argv[arg], "--order") == 0) && (arg + 1 < argc) )
+	{
+	    if ( (status = read_order(argv[++arg], &order)) != EX_OK )
+		return status;
+	}
+	else
+	    usage(argv);
+    }
+
+    switch(argc - arg)
+    {
+	case 0:
+	    break;
+
+	case 1:
+	    if ( (strcmp(argv[arg], "-") != 0) &&
+		 ((instream = fopen(argv[arg], "r")) == NULL) )
+	    {
+		fprintf(stderr, "%s: Cannot open %s: %s\n", argv[0],
+			argv[arg], strerror(errno));
+		return EX_NOINPUT;
+	    }
+	    break;
+
+	default:
+	    usage(argv);
+    }
+
+    return gff3_sort(instream, mem_mib * 1024 * 1024, &order);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read groups into an arena, spilling sorted runs to temporary
+ *      files whenever the arena or group array is full, then merge the
+ *      runs to stdout.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gff3_sort(FILE *instream, size_t mem_budget, order_t *order)
+
+{
+    static char out_buff[OUT_BUFF_SIZE];
+    sort_t      sort;
+    char        *line = NULL, *p, *num_end;
+    size_t      line_size = 0, seqid_len, needed;
+    ssize_t     len;
+    group_t     *g = NULL;
+    FILE        *fasta_stream = NULL;
+    uint64_t    seq = 0;
+    bool        in_header = true, group_open = false, new_group;
+    int         col, status;
+
+    setvbuf(stdout, out_buff, _IOFBF, OUT_BUFF_SIZE);
+
+    // Split the budget between text and group records
+    memset(&sort, 0, sizeof(sort));
+    sort.arena_size = mem_budget / 4 * 3;
+    sort.group_array_size = mem_budget / 4 / sizeof(*sort.groups);
+    sort.run_array_size = 16;
+    Arena = malloc(sort.arena_size);
+    sort.groups = malloc(sort.group_array_size * sizeof(*sort.groups));
+    sort.runs = malloc(sort.run_array_size * sizeof(*sort.runs));
+    if ( (Arena == NULL) || (sort.groups == NULL) || (sort.runs == NULL) )
+    {
+	fputs("gff3-sort: Could not allocate memory.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    PROF_START(t);
+    while ( (len = getline(&line, &line_size, instream)) > 0 )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
+	PROF_BYTES(len);
+	PROF_RESTART(t);
+	if ( line[len - 1] != '\n' )
+	{
+	    // Make sure every line in the arena is terminated
+	    if ( (size_t)len + 1 >= line_size )
+		line = realloc(line, line_size = len + 2);
+	    line[len++] = '\n';
+	    line[len] = '\0';
+	}
+
+	if ( *line == '#' )
+	{
+	    if ( in_header && (line[1] == '#') )
+	    {
+		// Header directives go straight to output
+		fwrite(line, len, 1, stdout);
+		continue;
+	    }
+	    if ( memcmp(line, "##FASTA", 7) == 0 )
+	    {
+		// Save the FASTA section to append after sorted features
+		if ( (fasta_stream = temp_file()) == NULL )
+		    return EX_CANTCREAT;
+		fwrite(line, len, 1, fasta_stream);
+		while ( (len = getline(&line, &line_size, instream)) > 0 )
+		    fwrite(line, len, 1, fasta_stream);
+		break;
+	    }
+	}
+	in_header = false;
+
+	// Start a new group at a top-level feature or after ###
+	new_group = (*line != '#') && (!group_open || !has_parent(line, len));
+	seqid_len = new_group ? strcspn(line, "\t\n") : 0;
+	needed = seqid_len + len;
+
+	if ( (sort.arena_len + needed > sort.arena_size) ||
+	     (new_group && (sort.group_count == sort.group_array_size)) )
+	{
+	    // Spill completed groups, keeping the open group or pending
+	    // comments in the arena
+	    if ( group_open && !new_group )
+		status = spill(&sort, sort.group_count - 1,
+			       sort.groups[sort.group_count - 1].text_offset);
+	    else
+		status = spill(&sort, sort.group_count,
+			       sort.arena_len - sort.pending);
+	    if ( status != EX_OK )
+		return status;
+	    if ( sort.group_count > 0 )
+		g = &sort.groups[sort.group_count - 1];
+
+	    // Grow the arena only for a single group larger than the budget
+	    if ( sort.arena_len + needed > sort.arena_size )
+	    {
+		sort.arena_size = (sort.arena_len + needed) * 2;
+		if ( (Arena = realloc(Arena, sort.arena_size)) == NULL )
+		{
+		    fputs("gff3-sort: Could not enlarge arena.\n", stderr);
+		    return EX_UNAVAILABLE;
+		}
+	    }
+	}
+
+	if ( new_group )
+	{
+	    g = &sort.groups[sort.group_count++];
+	    g->seq = seq++;
+	    g->seqid_len = seqid_len;
+	    g->rank = order->count > 0 ?
+		seqid_rank(order, line, seqid_len) : UNRANKED;
+	    for (col = 1, p = line; (col < 4) && (p != NULL); ++col)
+		if ( (p = strchr(p, '\t')) != NULL )
+		    ++p;
+	    if ( p == NULL )
+	    {
+		fprintf(stderr, "gff3-sort: Expected 9 columns: %s", line);
+		return EX_DATAERR;
+	    }
+	    g->start = strtoll(p, &num_end, 10);
+	    g->end = strtoll(num_end + 1, &num_end, 10);
+	    if ( *num_end != '\t' )
+	    {
+		fprintf(stderr, "gff3-sort: Invalid start or end: %s", line);
+		return EX_DATAERR;
+	    }
+
+	    // Seqid precedes the group text, which begins with any pending
+	    // comments
+	    g->text_offset = sort.arena_len - sort.pending;
+	    memmove(Arena + g->text_offset + seqid_len, Arena + g->text_offset,
+		    sort.pending);
+	    memcpy(Arena + g->text_offset, line, seqid_len);
+	    g->text_len = sort.pending;
+	    sort.arena_len += seqid_len;
+	    sort.pending = 0;
+	    group_open = true;
+	}
+
+	memcpy(Arena + sort.arena_len, line, len);
+	sort.arena_len += len;
+	if ( group_open )
+	{
+	    g->text_len += len;
+	    if ( memcmp(line, "###", 3) == 0 )
+		group_open = false;
+	}
+	else
+	    sort.pending += len;
+	PROF_STOP(t, "group");
+	PROF_RESTART(t);
+    }
+    free(line);
+
+    PROF_RESTART(t);
+    if ( sort.run_count == 0 )
+    {
+	// Everything fit in memory
+	qsort(sort.groups, sort.group_count, sizeof(*sort.groups),
+	      arena_group_cmp);
+	PROF_STOP(t, "sort");
+	PROF_RESTART(t);
+	for (g = sort.groups; g < sort.groups + sort.group_count; ++g)
+	    fwrite(Arena + g->text_offset + g->seqid_len, g->text_len, 1,
+		   stdout);
+	PROF_STOP_IO(t, "write");
+	status = EX_OK;
+    }
+    else
+    {
+	if ( (status = spill(&sort, sort.group_count,
+			     sort.arena_len - sort.pending)) != EX_OK )
+	    return status;
+	status = merge_runs(sort.runs, sort.run_count);
+	PROF_STOP(t, "merge");
+    }
+
+    // Trailing comments
+    if ( sort.pending > 0 )
+	fwrite(Arena + sort.arena_len - sort.pending, sort.pending, 1, stdout);
+    free(Arena);
+    free(sort.groups);
+    free(sort.runs);
+
+    if ( fasta_stream != NULL )
+    {
+	rewind(fasta_stream);
+	while ( (len = getline(&line, &line_size, fasta_stream)) > 0 )
+	    fwrite(line, len, 1, stdout);
+	fclose(fasta_stream);
+    }
+    fflush(stdout);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Sort the first count groups and write them to a new run, then
+ *      move the arena contents from keep onward (an open group or
+ *      pending comments) to the front.  Any groups after the first
+ *      count (at most one open group) are moved to the front of the
+ *      group array.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     spill(sort_t *sort, size_t count, size_t keep)
+
+{
+    FILE    **new_runs;
+    size_t  c;
+
+    if ( count > 0 )
+    {
+	if ( sort->run_count == sort->run_array_size )
+	{
+	    sort->run_array_size *= 2;
+	    new_runs = realloc(sort->runs,
+			       sort->run_array_size * sizeof(*sort->runs));
+	    if ( new_runs == NULL )
+	    {
+		fputs("gff3-sort: Could not allocate runs.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    sort->runs = new_runs;
+	}
+	qsort(sort->groups, count, sizeof(*sort->groups), arena_group_cmp);
+	if ( (sort->runs[sort->run_count++] = write_run(sort->groups, count))
+		== NULL )
+	    return EX_CANTCREAT;
+    }
+
+    memmove(Arena, Arena + keep, sort->arena_len - keep);
+    sort->arena_len -= keep;
+    for (c = count; c < sort->group_count; ++c)
+    {
+	sort->groups[c - count] = sort->groups[c];
+	sort->groups[c - count].text_offset -= keep;
+    }
+    sort->group_count -= count;
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Check whether a feature line has a Parent= attribute
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+bool    has_parent(const char *line, size_t len)
+
+{
+    const char  *attrs, *p, *end = line + len;
+    int         col;
+
+    for (col = 1, attrs = line; col < 9; ++col)
+	if ( (attrs = memchr(attrs, '\t', end - attrs)) == NULL )
+	    return false;
+	else
+	    ++attrs;
+    for (p = attrs; (p = memmem(p, end - p, "Parent=", 7)) != NULL; p += 7)
+	if ( (p == attrs) || (p[-1] == ';') )
+	    return true;
+    return false;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Compare two strings in natural order: runs of digits compare
+ *      numerically, so chr2 sorts before chr10.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     natural_cmp(const char *s1, size_t len1, const char *s2, size_t len2)
+
+{
+    const char  *e1 = s1 + len1, *e2 = s2 + len2, *d1, *d2;
+    size_t      n1, n2;
+    int         status;
+
+    while ( (s1 < e1) && (s2 < e2) )
+    {
+	if ( isdigit((unsigned char)*s1) && isdigit((unsigned char)*s2) )
+	{
+	    // Skip leading zeros, then longer number is larger
+	    while ( (s1 < e1) && (*s1 == '0') )
+		++s1;
+	    while ( (s2 < e2) && (*s2 == '0') )
+		++s2;
+	    for (d1 = s1; (d1 < e1) && isdigit((unsigned char)*d1); ++d1)
+		;
+	    for (d2 = s2; (d2 < e2) && isdigit((unsigned char)*d2); ++d2)
+		;
+	    n1 = d1 - s1;
+	    n2 = d2 - s2;
+	    if ( n1 != n2 )
+		return n1 < n2 ? -1 : 1;
+	    if ( (status = memcmp(s1, s2, n1)) != 0 )
+		return status;
+	    s1 = d1;
+	    s2 = d2;
+	}
+	else if ( *s1 != *s2 )
+	    return (unsigned char)*s1 - (unsigned char)*s2;
+	else
+	{
+	    ++s1;
+	    ++s2;
+	}
+    }
+    return (s1 < e1) - (s2 < e2);
+}
+
+
+int     group_cmp(const group_t *g1, const char *seqid1,
+		  const group_t *g2, const char *seqid2)
+
+{
+    int     status;
+
+    if ( g1->rank != g2->rank )
+	return g1->rank < g2->rank ? -1 : 1;
+    if ( (g1->rank == UNRANKED) &&
+	 ((status = natural_cmp(seqid1, g1->seqid_len,
+				seqid2, g2->seqid_len)) != 0) )
+	return status;
+    if ( g1->start != g2->start )
+	return g1->start < g2->start ? -1 : 1;
+    if ( g1->end != g2->end )
+	return g1->end < g2->end ? -1 : 1;
+    return g1->seq < g2->seq ? -1 : g1->seq > g2->seq;
+}
+
+
+int     arena_group_cmp(const void *p1, const void *p2)
+
+{
+    const group_t   *g1 = p1, *g2 = p2;
+
+    return group_cmp(g1, Arena + g1->text_offset, g2, Arena + g2->text_offset);
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write sorted groups to a temporary file.  Each group is stored
+ *      as its group_t followed by seqid and text.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *write_run(group_t *groups, size_t count)
+
+{
+    FILE    *stream;
+    size_t  c;
+
+    if ( (stream = temp_file()) == NULL )
+	return NULL;
+    for (c = 0; c < count; ++c)
+    {
+	fwrite(&groups[c], sizeof(*groups), 1, stream);
+	fwrite(Arena + groups[c].text_offset,
+	       groups[c].seqid_len + groups[c].text_len, 1, stream);
+    }
+    if ( fflush(stream) != 0 )
+    {
+	fprintf(stderr, "gff3-sort: Error writing temporary file: %s\n",
+		strerror(errno));
+	return NULL;
+    }
+    rewind(stream);
+    return stream;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read the next group from a run.  Returns 0 on success, EOF at
+ *      the end of the run.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     read_run(run_t *run)
+
+{
+    size_t  len;
+
+    if ( fread(&run->group, sizeof(run->group), 1, run->stream) != 1 )
+	return EOF;
+    len = run->group.seqid_len + run->group.text_len;
+    if ( len > run->text_size )
+    {
+	run->text_size = len * 2;
+	if ( (run->text = realloc(run->text, run->text_size)) == NULL )
+	{
+	    fputs("gff3-sort: Could not allocate merge buffer.\n", stderr);
+	    exit(EX_UNAVAILABLE);
+	}
+    }
+    if ( fread(run->text, len, 1, run->stream) != 1 )
+    {
+	fputs("gff3-sort: Truncated temporary file.\n", stderr);
+	exit(EX_IOERR);
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      k-way merge of sorted runs using a binary min-heap of run indices.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     merge_runs(FILE **streams, size_t run_count)
+
+{
+    run_t   *runs;
+    size_t  *heap, heap_len = 0, c, parent, child, tmp;
+    run_t   *r1, *r2;
+
+    runs = calloc(run_count, sizeof(*runs));
+    heap = malloc(run_count * sizeof(*heap));
+    if ( (runs == NULL) || (heap == NULL) )
+    {
+	fputs("gff3-sort: Could not allocate merge heap.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+#define RUN_LESS(a, b) \
+    (r1 = &runs[a], r2 = &runs[b], \
+     group_cmp(&r1->group, r1->text, &r2->group, r2->text) < 0)
+
+    for (c = 0; c < run_count; ++c)
+    {
+	runs[c].stream = streams[c];
+	if ( read_run(&runs[c]) == 0 )
+	{
+	    // Sift up
+	    heap[child = heap_len++] = c;
+	    while ( (child > 0) &&
+		    RUN_LESS(heap[child], heap[parent = (child - 1) / 2]) )
+	    {
+		tmp = heap[child];
+		heap[child] = heap[parent];
+		heap[parent] = tmp;
+		child = parent;
+	    }
+	}
+    }
+
+    while ( heap_len > 0 )
+    {
+	r1 = &runs[heap[0]];
+	fwrite(r1->text + r1->group.seqid_len, r1->group.text_len, 1, stdout);
+	if ( read_run(r1) != 0 )
+	{
+	    fclose(r1->stream);
+	    free(r1->text);
+	    heap[0] = heap[--heap_len];
+	}
+
+	// Sift down
+	for (parent = 0; (child = parent * 2 + 1) < heap_len; parent = child)
+	{
+	    if ( (child + 1 < heap_len) && RUN_LESS(heap[child + 1], heap[child]) )
+		++child;
+	    if ( !RUN_LESS(heap[child], heap[parent]) )
+		break;
+	    tmp = heap[child];
+	    heap[child] = heap[parent];
+	    heap[parent] = tmp;
+	}
+    }
+    free(runs);
+    free(heap);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read seqid order from the first column of a file, e.g. the
+ *      output of blt chrom-lens.  Seqids not listed sort after all
+ *      listed seqids, in natural order.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     read_order(const char *filename, order_t *order)
+
+{
+    FILE    *stream;
+    char    *line = NULL, **new_names;
+    size_t  line_size = 0, array_size = 0;
+
+    if ( (stream = fopen(filename, "r")) == NULL )
+    {
+	fprintf(stderr, "gff3-sort: Cannot open %s: %s\n", filename,
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    while ( getline(&line, &line_size, stream) > 0 )
+    {
+	if ( (*line == '#') || (*line == '\n') )
+	    continue;
+	if ( order->count == array_size )
+	{
+	    array_size = array_size == 0 ? 1024 : array_size * 2;
+	    new_names = realloc(order->names, array_size * sizeof(*new_names));
+	    if ( new_names == NULL )
+	    {
+		fputs("gff3-sort: Could not allocate order.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    order->names = new_names;
+	}
+	line[strcspn(line, " \t\r\n")] = '\0';
+	if ( (order->names[order->count++] = strdup(line)) == NULL )
+	{
+	    fputs("gff3-sort: Could not allocate order.\n", stderr);
+	    return EX_UNAVAILABLE;
+	}
+    }
+    free(line);
+    fclose(stream);
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Return the position of seqid in the order list, or UNRANKED.
+ *      Consecutive groups nearly always share a seqid, so the last
+ *      result is cached.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+uint32_t seqid_rank(order_t *order, const char *seqid, size_t len)
+
+{
+    static size_t   last = 0;
+    size_t          c;
+
+    if ( (last < order->count) && (strlen(order->names[last]) == len) &&
+	 (memcmp(order->names[last], seqid, len) == 0) )
+	return last;
+    for (c = 0; c < order->count; ++c)
+	if ( (strlen(order->names[c]) == len) &&
+	     (memcmp(order->names[c], seqid, len) == 0) )
+	    return last = c;
+    return UNRANKED;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Create an anonymous temporary file in $TMPDIR if set, otherwise
+ *      in the system default temporary directory.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+FILE    *temp_file(void)
+
+{
+    char    template[PATH_MAX + 1], *tmpdir;
+    FILE    *stream;
+    int     fd;
+
+    if ( (tmpdir = getenv("TMPDIR")) == NULL )
+	stream = tmpfile();
+    else
+    {
+	snprintf(template, PATH_MAX, "%s/gff3-sort.XXXXXX", tmpdir);
+	if ( (fd = mkstemp(template)) == -1 )
+	    stream = NULL;
+	else
+	{
+	    unlink(template);
+	    stream = fdopen(fd, "w+");
+	}
+    }
+    if ( stream == NULL )
+	fprintf(stderr, "gff3-sort: Cannot create temporary file: %s\n",
+		strerror(errno));
+    return stream;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--mem MiB] [--order seqid-list] [file.gff3] > sorted.gff3\n",
+	    argv[0]);
+    exit(EX_USAGE);
+}
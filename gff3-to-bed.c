@@ -5,40 +5,416 @@
  *      Some tools accept only BED files as inputs.  This program provides
  *      a workaround.
  *
- *  History: 
+ *      Only the columns needed for BED (seqid, start, end, strand,
+ *      and the Name= or ID= attribute) are located in each line, in
+ *      place in a large read buffer, and BED lines are formatted
+ *      directly into a large output buffer.  Nothing is allocated per
+ *      feature.  With --bgzf, the buffer is handed to a BGZF stream that
+ *      compresses on all cores.
+ *
+ *  History:
  *  Date        Name        Modification
  *  2022-04-14  Jason Bacon Begin
  ***************************************************************************/
 
+#ifdef __linux__
+#define _GNU_SOURCE // memmem()
+#endif
+
 #include <stdio.h>
 #include <sysexits.h>
 #include <stdlib.h>
-#include <biolibc/gff3.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+#define BUFF_SIZE       (1024 * 1024)
+#define GFF3_COLS       9
+#define MAX_BED_LINE    4096    // Excluding chrom and name
+
+typedef struct
+{
+    char    *buff;
+    size_t  len;
+    int     fd;
+    FILE    *stream;    // Used instead of fd if not NULL
+}   out_buff_t;
 
+int     gff3_to_bed(int infd, int outfd, FILE *outstream);
+int     gff3_line_to_bed(char *line, char *end, out_buff_t *out);
+char    *find_attribute(char *attrs, char *end, const char *key,
+			size_t key_len, size_t *val_len);
+char    *format_int64(char *p, int64_t val);
+int     out_flush(out_buff_t *out);
+int     out_append(out_buff_t *out, const char *str, size_t len);
 void    usage(char *argv[]);
 
 int     main(int argc,char *argv[])
 
 {
-    bl_gff3_t    gff3_feature;
-    bl_bed_t    bed_feature = BL_BED_INIT;
+    unsigned    threads = BLT_ZIO_THREADS_DEFAULT;
+    bool        bgzf = false;
+    int         arg, status;
+    FILE        *outstream = NULL;
+
+    PROF_INIT("gff3-to-bed");
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    bgzf = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+
+    if ( bgzf &&
+	 ((outstream = blt_bgzf_fdopen(STDOUT_FILENO, threads)) == NULL) )
+    {
+	fprintf(stderr, "gff3-to-bed: Cannot open BGZF output: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    status = gff3_to_bed(STDIN_FILENO, STDOUT_FILENO, outstream);
+    if ( (outstream != NULL) && (blt_zclose(outstream) != 0) &&
+	 (status == EX_OK) )
+    {
+	fputs("gff3-to-bed: Error writing output.\n", stderr);
+	status = EX_IOERR;
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Read GFF3 in large blocks and convert each complete line.  A
+ *      partial line at the end of a block is moved to the front of the
+ *      buffer before the next read, and the buffer is enlarged if a
+ *      single line does not fit.  Processing stops at a ##FASTA
+ *      directive.  Output goes to outstream if it is not NULL, and
+ *      otherwise directly to outfd.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gff3_to_bed(int infd, int outfd, FILE *outstream)
+
+{
+    char        *in_buff, *line, *eol, *end, *new_buff;
+    size_t      in_size = BUFF_SIZE, kept = 0;
+    ssize_t     bytes;
+    out_buff_t  out;
+    int         status;
+
+    in_buff = malloc(in_size);
+    out.buff = malloc(BUFF_SIZE);
+    if ( (in_buff == NULL) || (out.buff == NULL) )
+    {
+	fputs("gff3-to-bed: Could not allocate buffers.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+    out.len = 0;
+    out.fd = outfd;
+    out.stream = outstream;
+
+    PROF_START(t);
+    while ( (bytes = read(infd, in_buff + kept, in_size - kept)) > 0 )
+    {
+	PROF_STOP_IO(t, "read");
+	PROF_BYTES(bytes);
+	end = in_buff + kept + bytes;
+	for (line = in_buff; (eol = memchr(line, '\n', end - line)) != NULL;
+	     line = eol + 1)
+	{
+	    if ( *line == '#' )
+	    {
+		if ( (eol - line >= 7) && (memcmp(line, "##FASTA", 7) == 0) )
+		    return out_flush(&out) == 0 ? EX_OK : EX_IOERR;
+		continue;
+	    }
+	    if ( (status = gff3_line_to_bed(line, eol, &out)) != EX_OK )
+		return status;
+	    PROF_RECORDS(1);
+	}
+
+	// Keep partial line for the next read
+	kept = end - line;
+	if ( kept == in_size )
+	{
+	    in_size *= 2;
+	    if ( (new_buff = realloc(in_buff, in_size)) == NULL )
+	    {
+		fputs("gff3-to-bed: Could not enlarge input buffer.\n", stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    in_buff = new_buff;
+	}
+	else
+	    memmove(in_buff, line, kept);
+	PROF_RESTART(t);
+    }
+    if ( bytes < 0 )
+    {
+	fprintf(stderr, "gff3-to-bed: Error reading input: %s\n",
+		strerror(errno));
+	return EX_IOERR;
+    }
+
+    // Last line with no newline
+    if ( (kept > 0) && (*in_buff != '#') &&
+	 ((status = gff3_line_to_bed(in_buff, in_buff + kept, &out)) != EX_OK) )
+	return status;
+
+    free(in_buff);
+    status = out_flush(&out) == 0 ? EX_OK : EX_IOERR;
+    free(out.buff);
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert one GFF3 line (without newline) to a BED line:
+ *
+ *      seqid, start - 1, end, Name or ID (or .), score (0), strand
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     gff3_line_to_bed(char *line, char *end, out_buff_t *out)
+
+{
+    char        *cols[GFF3_COLS + 1], *p, *name, *num_end, *bed;
+    size_t      name_len;
+    int64_t     start, stop;
+    int         c;
+
+    if ( (end > line) && (end[-1] == '\r') )
+	--end;
+    if ( end == line )
+	return EX_OK;
+
+    // Locate column starts, no copying
+    cols[0] = line;
+    for (c = 1, p = line; c < GFF3_COLS; ++c)
+    {
+	if ( (p = memchr(p, '\t', end - p)) == NULL )
+	{
+	    fprintf(stderr, "gff3-to-bed: Expected %d columns: %.*s\n",
+		    GFF3_COLS, (int)(end - line), line);
+	    return EX_DATAERR;
+	}
+	cols[c] = ++p;
+    }
+    cols[GFF3_COLS] = end + 1;
+
+    start = strtoll(cols[3], &num_end, 10);
+    if ( num_end != cols[4] - 1 )
+    {
+	fprintf(stderr, "gff3-to-bed: Invalid start: %.*s\n",
+		(int)(cols[4] - cols[3] - 1), cols[3]);
+	return EX_DATAERR;
+    }
+    stop = strtoll(cols[4], &num_end, 10);
+    if ( num_end != cols[5] - 1 )
+    {
+	fprintf(stderr, "gff3-to-bed: Invalid end: %.*s\n",
+		(int)(cols[5] - cols[4] - 1), cols[4]);
+	return EX_DATAERR;
+    }
 
-    if ( argc != 1 )
-	usage(argv);
-    
-    bl_gff3_init(&gff3_feature);
-    while ( bl_gff3_read(&gff3_feature, stdin, BL_GFF3_FIELD_ALL) == BL_READ_OK )
+    if ( (name = find_attribute(cols[8], end, "Name=", 5, &name_len)) == NULL )
+	name = find_attribute(cols[8], end, "ID=", 3, &name_len);
+    if ( name == NULL )
     {
-	bl_gff3_to_bed(&gff3_feature, &bed_feature);
-	bl_bed_write(&bed_feature, stdout, BL_BED_FIELD_ALL);
+	name = ".";
+	name_len = 1;
     }
+
+    if ( out_append(out, cols[0], cols[1] - cols[0]) != 0 )
+	return EX_IOERR;
+
+    if ( out->len + MAX_BED_LINE > BUFF_SIZE )
+	if ( out_flush(out) != 0 )
+	    return EX_IOERR;
+    bed = out->buff + out->len;
+    bed = format_int64(bed, start - 1);
+    *bed++ = '\t';
+    bed = format_int64(bed, stop);
+    *bed++ = '\t';
+    out->len = bed - out->buff;
+
+    if ( out_append(out, name, name_len) != 0 )
+	return EX_IOERR;
+
+    if ( out->len + MAX_BED_LINE > BUFF_SIZE )
+	if ( out_flush(out) != 0 )
+	    return EX_IOERR;
+    bed = out->buff + out->len;
+    *bed++ = '\t';
+    *bed++ = '0';   // Score
+    *bed++ = '\t';
+    *bed++ = *cols[6] == '-' || *cols[6] == '+' ? *cols[6] : '.';
+    *bed++ = '\n';
+    out->len = bed - out->buff;
     return EX_OK;
 }
 
 
+/***************************************************************************
+ *  Description:
+ *      Find key (e.g. "Name=") at the start of an attribute in the
+ *      attributes column using memmem().  Return a pointer to the value
+ *      and its length in val_len, or NULL if not present.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *find_attribute(char *attrs, char *end, const char *key,
+			size_t key_len, size_t *val_len)
+
+{
+    char    *p = attrs, *val, *val_end;
+
+    while ( (p = memmem(p, end - p, key, key_len)) != NULL )
+    {
+	if ( (p == attrs) || (p[-1] == ';') )
+	{
+	    val = p + key_len;
+	    if ( (val_end = memchr(val, ';', end - val)) == NULL )
+		val_end = end;
+	    *val_len = val_end - val;
+	    return val;
+	}
+	p += key_len;
+    }
+    return NULL;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Write the decimal representation of val at p, without a null
+ *      terminator, and return a pointer to the next character.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+char    *format_int64(char *p, int64_t val)
+
+{
+    char        digits[24], *d = digits + sizeof(digits);
+    uint64_t    u;
+
+    if ( val < 0 )
+    {
+	*p++ = '-';
+	u = -(uint64_t)val;
+    }
+    else
+	u = val;
+    do
+    {
+	*--d = '0' + u % 10;
+	u /= 10;
+    }   while ( u != 0 );
+    memcpy(p, d, digits + sizeof(digits) - d);
+    return p + (digits + sizeof(digits) - d);
+}
+
+
+int     out_flush(out_buff_t *out)
+
+{
+    char        *p = out->buff;
+    ssize_t     bytes;
+
+    if ( out->stream != NULL )
+    {
+	PROF_START(t);
+	bytes = fwrite(out->buff, 1, out->len, out->stream);
+	PROF_STOP_IO(t, "write");
+	if ( bytes != (ssize_t)out->len )
+	{
+	    fputs("gff3-to-bed: Error writing output.\n", stderr);
+	    return -1;
+	}
+	out->len = 0;
+	return 0;
+    }
+    while ( out->len > 0 )
+    {
+	PROF_START(t);
+	bytes = write(out->fd, p, out->len);
+	PROF_STOP_IO(t, "write");
+	if ( bytes < 0 )
+	{
+	    if ( errno == EINTR )
+		continue;
+	    fprintf(stderr, "gff3-to-bed: Error writing output: %s\n",
+		    strerror(errno));
+	    return -1;
+	}
+	p += bytes;
+	out->len -= bytes;
+    }
+    return 0;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Append a string of arbitrary length to the output buffer,
+ *      flushing as needed.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     out_append(out_buff_t *out, const char *str, size_t len)
+
+{
+    size_t  chunk;
+
+    while ( len > 0 )
+    {
+	if ( out->len == BUFF_SIZE )
+	    if ( out_flush(out) != 0 )
+		return -1;
+	chunk = BUFF_SIZE - out->len;
+	if ( chunk > len )
+	    chunk = len;
+	memcpy(out->buff + out->len, str, chunk);
+	out->len += chunk;
+	str += chunk;
+	len -= chunk;
+    }
+    return 0;
+}
+
+
 void    usage(char *argv[])
 
 {
-    fprintf(stderr, "Usage: %s\n", argv[0]);
+    fprintf(stderr, "Usage: %s [--bgzf [--threads N]] < file.gff3 > file.bed\n",
+	    argv[0]);
     exit(EX_USAGE);
 }
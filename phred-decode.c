@@ -0,0 +1,248 @@
+/***************************************************************************
+ *  Description:
+ *      Convert FASTQ quality strings to numeric Phred scores for QC
+ *      and analysis in other tools.
+ *
+ *      Output is one line of space-separated scores per record, or with
+ *      --binary, a 4-byte little-endian length followed by one byte per
+ *      score for each record.
+ *
+ *      The input offset is detected from the first records unless
+ *      given.  Quality strings are converted to scores in place 8
+ *      characters at a time (see blt-phred.h) and text output is
+ *      formatted from a table, so decoding runs at the speed of the
+ *      FASTQ reader.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <biolibc/fastx.h>
+#include "blt-phred.h"
+#include "blt-zio.h"
+#include "blt-profile.h"
+
+typedef struct
+{
+    char    *buff;
+    size_t  size;
+}   line_buff_t;
+
+int     phred_decode(FILE *instream, int from, bool binary);
+int     decode_record(bl_fastx_t *rec, int from, bool binary,
+		      line_buff_t *line, size_t record);
+void    usage(char *argv[]);
+
+// Scores as text with a trailing space, e.g. "40 "
+static char     Score_text[PHRED_MAX_SCORE(33) + 1][4];
+static uint8_t  Score_text_len[PHRED_MAX_SCORE(33) + 1];
+
+int     main(int argc,char *argv[])
+
+{
+    unsigned    threads = BLT_ZIO_THREADS_DEFAULT;
+    bool        binary = false;
+    int         arg, status, from = PHRED_OFFSET_AUTO, score;
+    FILE        *instream;
+
+    PROF_INIT("phred-decode");
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( (strcmp(argv[arg], "--from") == 0) && (arg + 1 < argc) )
+	{
+	    if ( (from = phred_parse_offset(argv[++arg])) == -1 )
+		usage(argv);
+	}
+	else if ( strcmp(argv[arg], "--binary") == 0 )
+	    binary = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+
+    for (score = 0; score <= PHRED_MAX_SCORE(33); ++score)
+	Score_text_len[score] = snprintf(Score_text[score],
+					 sizeof(Score_text[score]), "%d ",
+					 score);
+
+    if ( (instream = blt_zopen("-", threads)) == NULL )
+    {
+	fprintf(stderr, "phred-decode: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    status = phred_decode(instream, from, binary);
+    blt_zclose(instream);
+    if ( (fflush(stdout) != 0) && (status == EX_OK) )
+    {
+	fprintf(stderr, "phred-decode: Error writing output: %s\n",
+		strerror(errno));
+	status = EX_IOERR;
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Decode every record, first sampling records to detect from if
+ *      it is PHRED_OFFSET_AUTO.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     phred_decode(FILE *instream, int from, bool binary)
+
+{
+    bl_fastx_t  *recs;
+    line_buff_t line = { NULL, 0 };
+    size_t      sampled = 0, records, c;
+    int         status = BL_READ_OK, detected, ex_status = EX_OK;
+
+    if ( (recs = calloc(PHRED_SAMPLE_RECORDS, sizeof(*recs))) == NULL )
+    {
+	fputs("phred-decode: Could not allocate sample records.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    PROF_START(t);
+    if ( from == PHRED_OFFSET_AUTO )
+    {
+	sampled = phred_sample(instream, recs, &detected, &status);
+	from = detected;
+	fprintf(stderr, "phred-decode: Detected Phred+%d input.\n", from);
+    }
+    PROF_STOP_IO(t, "sample");
+    for (c = 0; (c < sampled) && (ex_status == EX_OK); ++c)
+	ex_status = decode_record(&recs[c], from, binary, &line, c + 1);
+    for (c = 1; c < sampled; ++c)
+	bl_fastx_free(&recs[c]);
+    records = sampled;
+
+    // Reuse the first sample record for the rest of the stream
+    if ( sampled == 0 )
+	bl_fastx_init(&recs[0], instream);
+    if ( status == BL_READ_OK )
+    {
+	PROF_RESTART(t);
+	while ( (ex_status == EX_OK) &&
+		((status = bl_fastx_read(&recs[0], instream)) == BL_READ_OK) )
+	{
+	    PROF_STOP_IO(t, "read");
+	    ex_status = decode_record(&recs[0], from, binary, &line,
+				      ++records);
+	    PROF_RESTART(t);
+	}
+    }
+    if ( (ex_status == EX_OK) && (status != BL_READ_EOF) )
+    {
+	fprintf(stderr, "phred-decode: Error reading record %zu.\n",
+		records + 1);
+	ex_status = EX_DATAERR;
+    }
+    bl_fastx_free(&recs[0]);
+    free(recs);
+    free(line.buff);
+    return ex_status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert one record's quality string to scores and write them.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     decode_record(bl_fastx_t *rec, int from, bool binary,
+		      line_buff_t *line, size_t record)
+
+{
+    unsigned char   *qual, header[4];
+    char            *p, *new_buff;
+    size_t          len, bad, c;
+
+    if ( BL_FASTX_FORMAT(rec) != BL_FASTX_FORMAT_FASTQ )
+    {
+	fputs("phred-decode: Input is not FASTQ.\n", stderr);
+	return EX_DATAERR;
+    }
+    qual = (unsigned char *)bl_fastx_qual(rec);
+    len = bl_fastx_qual_len(rec);
+    PROF_START(t);
+    if ( (bad = phred_shift((char *)qual, len, from, 0)) != len )
+    {
+	fprintf(stderr, "phred-decode: Invalid Phred+%d quality '%c' "
+		"in record %zu: %s\n", from, qual[bad], record,
+		bl_fastx_desc(rec));
+	return EX_DATAERR;
+    }
+    PROF_STOP(t, "convert");
+    PROF_RECORDS(1);
+    // Excluding line breaks and the FASTQ '+' line
+    PROF_BYTES(bl_fastx_desc_len(rec) + bl_fastx_seq_len(rec) + len);
+
+    PROF_RESTART(t);
+    if ( binary )
+    {
+	header[0] = len & 0xff;
+	header[1] = (len >> 8) & 0xff;
+	header[2] = (len >> 16) & 0xff;
+	header[3] = (len >> 24) & 0xff;
+	fwrite(header, 1, sizeof(header), stdout);
+	fwrite(qual, 1, len, stdout);
+    }
+    else
+    {
+	// Up to 3 characters per score, plus newline
+	if ( line->size < len * 3 + 1 )
+	{
+	    if ( (new_buff = realloc(line->buff, len * 3 + 1)) == NULL )
+	    {
+		fputs("phred-decode: Could not allocate line buffer.\n",
+		      stderr);
+		return EX_UNAVAILABLE;
+	    }
+	    line->buff = new_buff;
+	    line->size = len * 3 + 1;
+	}
+	for (c = 0, p = line->buff; c < len; ++c)
+	{
+	    memcpy(p, Score_text[qual[c]], 4);
+	    p += Score_text_len[qual[c]];
+	}
+	// Replace the last space with a newline
+	if ( p > line->buff )
+	    --p;
+	*p++ = '\n';
+	fwrite(line->buff, 1, p - line->buff, stdout);
+    }
+    PROF_STOP_IO(t, "write");
+    return EX_OK;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--from 33|64] [--binary] [--threads N] "
+		    "< in.fastq > scores\n", argv[0]);
+    exit(EX_USAGE);
+}
@@ -0,0 +1,355 @@
+/***************************************************************************
+ *  Description:
+ *      Re-encode FASTQ quality strings with a different Phred offset,
+ *      e.g. to convert legacy Illumina Phred+64 archives to the
+ *      Phred+33 used by current tools.
+ *
+ *      The input offset is detected from the first records unless
+ *      given.  Quality strings are converted in place 8 characters at
+ *      a time (see blt-phred.h), so conversion runs at the speed of
+ *      the FASTQ reader.  gzip and BGZF input is decompressed on other
+ *      cores, and with --bgzf the output is compressed on all cores.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <biolibc/fastx.h>
+#include "blt-phred.h"
+#include "blt-zio.h"
+#include "blt-stage.h"
+#include "blt-profile.h"
+
+// State of the "blt pipe" stage
+typedef struct
+{
+    int         from,
+		to;
+    size_t      records,
+		sampled;
+    unsigned char   min_qual;
+}   encode_stage_t;
+
+void    encode_args(int argc, char *argv[], int *from, int *to,
+		    blt_stage_io_t *io);
+int     phred_encode(FILE *instream, FILE *outstream, int from, int to);
+int     encode_record(bl_fastx_t *rec, FILE *outstream, int from, int to,
+		      size_t record);
+int     convert_record(bl_fastx_t *rec, int from, int to, size_t record);
+void    *encode_stage_open(int argc, char *argv[], blt_stage_io_t *io);
+bool    encode_stage_sample(void *state, blt_batch_t *batch, bool last);
+int     encode_stage_batch(void *state, blt_batch_t *batch);
+int     encode_stage_close(void *state, int status);
+void    usage(char *argv[]);
+
+const blt_stage_t   blt_phred_encode_stage =
+{
+    "phred-encode", encode_stage_open, encode_stage_sample,
+    encode_stage_batch, encode_stage_close
+};
+
+int     main(int argc,char *argv[])
+
+{
+    blt_stage_io_t  io;
+    int         status, from, to;
+    FILE        *instream, *outstream = stdout;
+
+    PROF_INIT("phred-encode");
+
+    encode_args(argc, argv, &from, &to, &io);
+
+    if ( (instream = blt_zopen("-", io.threads)) == NULL )
+    {
+	fprintf(stderr, "phred-encode: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( io.bgzf &&
+	 ((outstream = blt_bgzf_fdopen(STDOUT_FILENO, io.threads)) == NULL) )
+    {
+	fprintf(stderr, "phred-encode: Cannot open BGZF output: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    status = phred_encode(instream, outstream, from, to);
+    blt_zclose(instream);
+    if ( (blt_zclose(outstream) != 0) && (status == EX_OK) )
+    {
+	fputs("phred-encode: Error writing output.\n", stderr);
+	status = EX_IOERR;
+    }
+    return status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Parse command line arguments for main() and the "blt pipe"
+ *      stage.  Exits through usage() on errors.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    encode_args(int argc, char *argv[], int *from, int *to,
+		    blt_stage_io_t *io)
+
+{
+    int     arg;
+
+    *from = PHRED_OFFSET_AUTO;
+    *to = 33;
+    io->threads = BLT_ZIO_THREADS_DEFAULT;
+    io->bgzf = false;
+    io->range_start = 0;
+    io->range_end = -1;
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+	if ( (strcmp(argv[arg], "--from") == 0) && (arg + 1 < argc) )
+	{
+	    if ( (*from = phred_parse_offset(argv[++arg])) == -1 )
+		usage(argv);
+	}
+	else if ( (strcmp(argv[arg], "--to") == 0) && (arg + 1 < argc) )
+	{
+	    if ( (*to = phred_parse_offset(argv[++arg])) == -1 )
+		usage(argv);
+	}
+	else if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    io->bgzf = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &io->threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert every record from offset from to offset to, first
+ *      sampling records to detect from if it is PHRED_OFFSET_AUTO.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     phred_encode(FILE *instream, FILE *outstream, int from, int to)
+
+{
+    bl_fastx_t  *recs;
+    size_t      sampled = 0, records, c;
+    int         status = BL_READ_OK, detected, ex_status = EX_OK;
+
+    if ( (recs = calloc(PHRED_SAMPLE_RECORDS, sizeof(*recs))) == NULL )
+    {
+	fputs("phred-encode: Could not allocate sample records.\n", stderr);
+	return EX_UNAVAILABLE;
+    }
+
+    PROF_START(t);
+    if ( from == PHRED_OFFSET_AUTO )
+    {
+	sampled = phred_sample(instream, recs, &detected, &status);
+	from = detected;
+	fprintf(stderr, "phred-encode: Detected Phred+%d input.\n", from);
+    }
+    PROF_STOP_IO(t, "sample");
+    for (c = 0; (c < sampled) && (ex_status == EX_OK); ++c)
+	ex_status = encode_record(&recs[c], outstream, from, to, c + 1);
+    for (c = 1; c < sampled; ++c)
+	bl_fastx_free(&recs[c]);
+    records = sampled;
+
+    // Reuse the first sample record for the rest of the stream
+    if ( sampled == 0 )
+	bl_fastx_init(&recs[0], instream);
+    if ( status == BL_READ_OK )
+    {
+	PROF_RESTART(t);
+	while ( (ex_status == EX_OK) &&
+		((status = bl_fastx_read(&recs[0], instream)) == BL_READ_OK) )
+	{
+	    PROF_STOP_IO(t, "read");
+	    ex_status = encode_record(&recs[0], outstream, from, to,
+				      ++records);
+	    PROF_RESTART(t);
+	}
+    }
+    if ( (ex_status == EX_OK) && (status != BL_READ_EOF) )
+    {
+	fprintf(stderr, "phred-encode: Error reading record %zu.\n",
+		records + 1);
+	ex_status = EX_DATAERR;
+    }
+    bl_fastx_free(&recs[0]);
+    free(recs);
+    return ex_status;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert and write one record.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     encode_record(bl_fastx_t *rec, FILE *outstream, int from, int to,
+		      size_t record)
+
+{
+    int     status;
+
+    PROF_START(t);
+    if ( (status = convert_record(rec, from, to, record)) != EX_OK )
+	return status;
+    PROF_STOP(t, "convert");
+    PROF_RECORDS(1);
+    // Excluding line breaks and the FASTQ '+' line
+    PROF_BYTES(bl_fastx_desc_len(rec) + bl_fastx_seq_len(rec) +
+	       bl_fastx_qual_len(rec));
+
+    PROF_RESTART(t);
+    bl_fastx_write(rec, outstream, BL_FASTX_LINE_UNLIMITED);
+    PROF_STOP_IO(t, "write");
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Convert the quality string of one record in place, reporting
+ *      non-FASTQ input and scores that are invalid or do not fit the
+ *      output offset.  Also used by the stage, on its own thread, so
+ *      profiling is left to encode_record(), which only main() calls.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+int     convert_record(bl_fastx_t *rec, int from, int to, size_t record)
+
+{
+    char    *qual;
+    size_t  len, bad;
+
+    if ( BL_FASTX_FORMAT(rec) != BL_FASTX_FORMAT_FASTQ )
+    {
+	fputs("phred-encode: Input is not FASTQ.\n", stderr);
+	return EX_DATAERR;
+    }
+    qual = bl_fastx_qual(rec);
+    len = bl_fastx_qual_len(rec);
+    if ( (bad = phred_shift(qual, len, from, to)) != len )
+    {
+	if ( (qual[bad] >= from) && (qual[bad] <= PHRED_MAX_CHAR) )
+	    fprintf(stderr, "phred-encode: Quality %d in record %zu "
+		    "exceeds the Phred+%d maximum of %d: %s\n",
+		    qual[bad] - from, record, to, PHRED_MAX_SCORE(to),
+		    bl_fastx_desc(rec));
+	else
+	    fprintf(stderr, "phred-encode: Invalid Phred+%d quality '%c' "
+		    "in record %zu: %s\n", from, qual[bad], record,
+		    bl_fastx_desc(rec));
+	return EX_DATAERR;
+    }
+    return EX_OK;
+}
+
+
+/***************************************************************************
+ *  Description:
+ *      Stage functions for "blt pipe", which passes batches of parsed
+ *      records between subcommands in one process.  Records are
+ *      converted in place and passed on.
+ *
+ *  History:
+ *  Date        Name        Modification
+ *  2026-10-19  Jason Bacon Begin
+ ***************************************************************************/
+
+void    *encode_stage_open(int argc, char *argv[], blt_stage_io_t *io)
+
+{
+    encode_stage_t  *stage;
+
+    if ( (stage = calloc(1, sizeof(*stage))) == NULL )
+	return NULL;
+    encode_args(argc, argv, &stage->from, &stage->to, io);
+    stage->min_qual = 255;
+    return stage;
+}
+
+
+bool    encode_stage_sample(void *state, blt_batch_t *batch, bool last)
+
+{
+    encode_stage_t  *stage = state;
+
+    // Non-FASTQ input is reported by encode_stage_batch()
+    if ( (stage->from != PHRED_OFFSET_AUTO) ||
+	 ((batch->count > 0) && (BL_FASTX_FORMAT(&batch->records[0]) !=
+				 BL_FASTX_FORMAT_FASTQ)) )
+	return true;
+    if ( !phred_sample_batch(batch->records, batch->count, &stage->sampled,
+			     &stage->min_qual, last, &stage->from) )
+	return false;
+    fprintf(stderr, "phred-encode: Detected Phred+%d input.\n", stage->from);
+    return true;
+}
+
+
+int     encode_stage_batch(void *state, blt_batch_t *batch)
+
+{
+    encode_stage_t  *stage = state;
+    unsigned    c;
+    int         status;
+
+    for (c = 0; c < batch->count; ++c)
+    {
+	if ( (status = convert_record(&batch->records[c], stage->from,
+				      stage->to, ++stage->records)) != EX_OK )
+	{
+	    batch->count = c;
+	    return status;
+	}
+    }
+    return EX_OK;
+}
+
+
+int     encode_stage_close(void *state, int status)
+
+{
+    free(state);
+    return status;
+}
+
+
+void    usage(char *argv[])
+
+{
+    fprintf(stderr, "Usage: %s [--from 33|64] [--to 33|64] "
+		    "[--bgzf [--threads N]] < in.fastq > out.fastq\n", argv[0]);
+    exit(EX_USAGE);
+}
@@ -0,0 +1,46 @@
+#!/bin/sh -e
+
+##########################################################################
+#   Compare startup cost of the standard layout (blt exec()s a separate,
+#   dynamically linked binary for each subcommand) and the multicall
+#   layout (one static blt containing all subcommands), by running
+#   short subcommands on tiny inputs many times.
+#
+#   Usage: ./startup-bench.sh [runs]
+#
+#   History:
+#   Date        Name        Modification
+#   2026-10-19  Jason Bacon Begin
+##########################################################################
+
+runs=${1:-1000}
+
+# Point LIBEXECDIR here so the standard blt finds uninstalled binaries
+make clean
+make LIBEXECDIR=$(pwd) all multicall
+mkdir -p multicall-links
+for cmd in chrom-lens vcf-search; do
+    ln -sf ../blt-multicall multicall-links/$cmd
+done
+
+bench()
+{
+    printf "\n%s x $runs\n" "$*"
+    time sh -c "i=0; while [ \$i -lt $runs ]; do $* > /dev/null; i=\$((i + 1)); done"
+}
+
+for layout in './blt' './blt-multicall'; do
+    printf "\n===\n$layout\n"
+    bench "$layout chrom-lens < Test/test.fasta"
+    bench "$layout vcf-search chr1 4580 < Test/test.vcf"
+done
+
+printf "\n===\nmulticall symlinks\n"
+bench "multicall-links/chrom-lens < Test/test.fasta"
+bench "multicall-links/vcf-search chr1 4580 < Test/test.vcf"
+
+printf "\n===\nDirect dynamic binaries (no blt)\n"
+bench "./chrom-lens < Test/test.fasta"
+bench "./vcf-search chr1 4580 < Test/test.vcf"
+
+rm -rf multicall-links
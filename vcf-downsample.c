@@ -15,8 +15,14 @@
 #include <stdio.h>
 #include <sysexits.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include <time.h>
 #include <biolibc/vcf.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
 
 void    usage(char *argv[]);
 
@@ -26,18 +32,35 @@ int     main(int argc,char *argv[])
     bl_vcf_t    site;
     int64_t     desired_sites, original_sites;
     char        *end;
-    FILE        *tmp_stream;
-    int         ch;
+    FILE        *instream, *tmp_stream, *outstream = stdout;
+    int         ch, arg;
+    unsigned    threads = BLT_ZIO_THREADS_DEFAULT;
+    bool        bgzf = false;
     off_t       start_pos;
     long        random_cutoff;
     
-    switch(argc)
+    PROF_INIT("vcf-downsample");
+
+    for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); ++arg)
+    {
+	if ( strcmp(argv[arg], "--bgzf") == 0 )
+	    bgzf = true;
+	else if ( (strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc) )
+	{
+	    if ( blt_parse_threads(argv[++arg], &threads) != 0 )
+		usage(argv);
+	}
+	else
+	    usage(argv);
+    }
+
+    switch(argc - arg)
     {
-	case 2:
-	    desired_sites = strtoul(argv[1], &end, 10);
+	case 1:
+	    desired_sites = strtoul(argv[arg], &end, 10);
 	    if ( *end != '\0' )
 	    {
-		fprintf(stderr, "Invalid site count: %s\n", argv[1]);
+		fprintf(stderr, "Invalid site count: %s\n", argv[arg]);
 		usage(argv);
 	    }
 	    break;
@@ -46,9 +69,25 @@ int     main(int argc,char *argv[])
 	    usage(argv);
     }
     
+    if ( bgzf &&
+	 ((outstream = blt_bgzf_fdopen(STDOUT_FILENO, threads)) == NULL) )
+    {
+	fprintf(stderr, "vcf-downsample: Cannot open BGZF output: %s\n",
+		strerror(errno));
+	return EX_CANTCREAT;
+    }
+    
+    // Read ahead or decompress on another thread while copying
+    if ( (instream = blt_zopen("-", threads)) == NULL )
+    {
+	fprintf(stderr, "vcf-downsample: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+
     bl_vcf_init(&site);
     
-    if ( (tmp_stream = bl_vcf_skip_header(stdin)) == NULL )
+    if ( (tmp_stream = bl_vcf_skip_header(instream)) == NULL )
     {
 	fprintf(stderr, "vcf-downsample: Error reading VCF header.\n");
 	return EX_NOINPUT;
@@ -56,34 +95,52 @@ int     main(int argc,char *argv[])
     
     // FIXME: Factor this out to a bl_vcf_t function.
     while ( (ch = getc(tmp_stream)) != EOF )
-	putc(ch, stdout);
+	putc(ch, outstream);
     
     // Copy header line
     // FIXME: This is actually copying the first call
-    while ( ((ch = getc(stdin)) != '\n') && (ch != EOF) )
-	putc(ch, stdout);
-    putc('\n', stdout);
+    while ( ((ch = getc(instream)) != '\n') && (ch != EOF) )
+	putc(ch, outstream);
+    putc('\n', outstream);
     
     // Count sites in VCF and copy input to a seekable file
     start_pos = ftello(tmp_stream);
     original_sites = 0;
-    while ( (ch = getc(stdin)) != EOF )
+    PROF_START(t);
+    while ( (ch = getc(instream)) != EOF )
     {
 	putc(ch, tmp_stream);
 	if ( ch == '\n' )
 	    ++original_sites;
     }
+    PROF_STOP_IO(t, "copy");
+    PROF_STREAM_BYTES(instream);
+    
+    blt_zclose(instream);
     
     random_cutoff = RAND_MAX * desired_sites / original_sites;
     srandom(time(NULL));
     
     fseeko(tmp_stream, start_pos, SEEK_SET);
+    PROF_RESTART(t);
     while ( bl_vcf_read_ss_call(&site, tmp_stream, BL_VCF_FIELD_ALL) == BL_READ_OK )
     {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
 	if ( random() < random_cutoff )
-	    bl_vcf_write_ss_call(&site, stdout, BL_VCF_FIELD_ALL);
+	{
+	    PROF_RESTART(t);
+	    bl_vcf_write_ss_call(&site, outstream, BL_VCF_FIELD_ALL);
+	    PROF_STOP_IO(t, "write");
+	}
+	PROF_RESTART(t);
     }
     fclose(tmp_stream);
+    if ( blt_zclose(outstream) != 0 )
+    {
+	fprintf(stderr, "vcf-downsample: Error writing output.\n");
+	return EX_IOERR;
+    }
     
     return EX_OK;
 }
@@ -92,6 +149,7 @@ int     main(int argc,char *argv[])
 void    usage(char *argv[])
 
 {
-    fprintf(stderr, "Usage: %s desired-count [< in.vcf] [> out.vcf]\n", argv[0]);
+    fprintf(stderr, "Usage: %s [--bgzf [--threads N]] desired-count "
+		    "[< in.vcf] [> out.vcf]\n", argv[0]);
     exit(EX_USAGE);
 }
@@ -15,8 +15,11 @@
 #include <sysexits.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <xtend/dsv.h>
 #include <biolibc/vcf.h>
+#include "blt-zio.h"
+#include "blt-profile.h"
 
 void    usage(char *argv[]);
 
@@ -27,6 +30,9 @@ int     main(int argc,char *argv[])
     unsigned long   pos;
     int             field_mask = BL_VCF_FIELD_ALL; // BL_VCF_FIELD_CHROM|BL_VCF_FIELD_POS;
     bl_vcf_t        vcf_call;
+    FILE            *instream;
+
+    PROF_INIT("vcf-search");
 
     switch(argc)
     {
@@ -44,18 +50,36 @@ int     main(int argc,char *argv[])
 	    return EX_USAGE;
     }
     
-    if ( bl_vcf_skip_header(stdin) == NULL )
+    // Read ahead or decompress on another thread while parsing
+    if ( (instream = blt_zopen("-", BLT_ZIO_THREADS_DEFAULT)) == NULL )
+    {
+	fprintf(stderr, "vcf-search: Cannot open input: %s\n",
+		strerror(errno));
+	return EX_NOINPUT;
+    }
+    if ( bl_vcf_skip_header(instream) == NULL )
 	return EX_DATAERR;
 
     bl_vcf_init(&vcf_call);
     
     // FIXME: Switch to multisample calls when implemented
-    while ( bl_vcf_read_ss_call(&vcf_call, stdin, field_mask) != BL_READ_EOF )
+    PROF_START(t);
+    while ( bl_vcf_read_ss_call(&vcf_call, instream, field_mask)
+	    != BL_READ_EOF )
     {
+	PROF_STOP_IO(t, "read");
+	PROF_RECORDS(1);
 	if ( (pos == BL_VCF_POS(&vcf_call)) &&
 	     (strcmp(chr, BL_VCF_CHROM(&vcf_call)) == 0) )
+	{
+	    PROF_RESTART(t);
 	    bl_vcf_write_ss_call(&vcf_call, stdout, BL_VCF_FIELD_ALL);
+	    PROF_STOP_IO(t, "write");
+	}
+	PROF_RESTART(t);
     }
+    PROF_STREAM_BYTES(instream);
+    blt_zclose(instream);
     return EX_OK;
 }
 